@@ -0,0 +1,31 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stdlib.h>
+
+// =============================================================================
+// HEAP ALLOCATION COUNTER
+// =============================================================================
+
+// The counter replaces malloc()/calloc()/realloc()/free() with thin wrappers
+// around glibc's own entry points, so it needs glibc and cannot coexist with
+// a sanitizer's allocator.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define ALLOC_COUNTER_AVAILABLE 1
+#else
+#define ALLOC_COUNTER_AVAILABLE 0
+#endif
+
+/**
+ * @brief Starts counting heap allocations made by any thread
+ */
+void alloc_counter_start(void);
+
+/**
+ * @brief Stops counting
+ * @return malloc()/calloc()/realloc() calls since alloc_counter_start(),
+ *         -1 if this build cannot count
+ */
+long alloc_counter_stop(void);
+
+#endif // ALLOC_COUNTER_H
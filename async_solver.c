@@ -0,0 +1,508 @@
+#include "async_solver.h"
+#include "dsl_parser.h"
+#include "memory_budget.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+// =============================================================================
+// ASYNCHRONOUS SOLVE API
+// =============================================================================
+// A fixed pool of threads takes submissions from a FIFO queue. Each handle
+// owns the spec text, the solver it runs on and a snapshot of the search
+// progress; the snapshot is refreshed by the solver's progress hook and read
+// by pollers under the handle's mutex. Handles are reference counted: one
+// reference for the caller, one for the pool until the handle has been
+// handed out by async_pool_next_completed() or the pool is destroyed.
+
+// Progress hook calls between counter refreshes when the partial layout did
+// not get deeper
+#define ASYNC_STATS_INTERVAL 64
+
+struct AsyncSolveHandle {
+    pthread_mutex_t lock;               // Guards status, timestamps and the snapshot
+    atomic_int refs;
+    atomic_int cancel;                  // Doubles as the solver's cancel_flag
+    AsyncSolveStatus status;
+
+    char* spec_text;
+    AsyncSolveOptions options;
+    int has_options;
+    AsyncSolveCallback callback;
+    void* user_data;
+    LayoutSolver* solver;               // Published when the status becomes final
+    MemoryBudget* budget;               // Charged for solver, tree and search copies
+
+    // Progress snapshot
+    PlacementRecord partial[MAX_COMPONENTS];
+    int component_count;
+    int partial_placed;
+    int nodes_created;
+    int backtracks;
+    size_t memory_peak;
+    atomic_int progress_calls;
+    atomic_int best_placed;             // Lock-free pre-check for the hook
+
+    struct timespec submitted, started, finished;
+    AsyncSolveHandle* next;             // Pending queue or completion list link
+};
+
+struct AsyncSolvePool {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    AsyncSolveHandle* queue_head;
+    AsyncSolveHandle* queue_tail;
+    AsyncSolveHandle* done_head;
+    AsyncSolveHandle* done_tail;
+    AsyncSolveHandle** running;         // Per thread, for cancelling on destroy
+    int shutdown;
+
+    pthread_t* threads;
+    int thread_count;
+    int notify_read_fd;                 // eventfd, or read end of the pipe
+    int notify_write_fd;                // eventfd, or write end of the pipe
+};
+
+typedef struct PoolThreadArg {
+    AsyncSolvePool* pool;
+    int index;
+} PoolThreadArg;
+
+static double elapsed_ms(const struct timespec* from, const struct timespec* to) {
+    return (to->tv_sec - from->tv_sec) * 1000.0 + (to->tv_nsec - from->tv_nsec) / 1e6;
+}
+
+static void free_handle(AsyncSolveHandle* handle) {
+    pthread_mutex_destroy(&handle->lock);
+    free(handle->spec_text);
+    memory_budget_free(handle->budget, handle->solver, sizeof(LayoutSolver));
+    memory_budget_destroy(handle->budget);
+    free(handle);
+}
+
+static void drop_reference(AsyncSolveHandle* handle) {
+    if (atomic_fetch_sub(&handle->refs, 1) == 1) {
+        free_handle(handle);
+    }
+}
+
+static int count_placed(const PlacementRecord* records, int count) {
+    int placed = 0;
+    for (int i = 0; i < count; i++) {
+        placed += records[i].is_placed != 0;
+    }
+    return placed;
+}
+
+/**
+ * @brief Solver progress hook: keeps the deepest partial layout and counters
+ *
+ * Runs on every successful placement, possibly on several parallel-search
+ * workers at once, so it only takes the handle lock when the layout got
+ * deeper or every ASYNC_STATS_INTERVAL calls.
+ */
+static void async_progress_hook(LayoutSolver* solver, void* context) {
+    AsyncSolveHandle* handle = context;
+    int placed = count_placed(solver->placements, solver->component_count);
+    int calls = atomic_fetch_add_explicit(&handle->progress_calls, 1, memory_order_relaxed) + 1;
+
+    if (placed <= atomic_load_explicit(&handle->best_placed, memory_order_relaxed) &&
+        calls % ASYNC_STATS_INTERVAL != 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&handle->lock);
+    if (placed > handle->partial_placed) {
+        memcpy(handle->partial, solver->placements, sizeof(handle->partial));
+        handle->partial_placed = placed;
+        atomic_store_explicit(&handle->best_placed, placed, memory_order_relaxed);
+    }
+    handle->nodes_created = solver->tree_solver.nodes_created;
+    handle->backtracks = solver->tree_solver.backtracks;
+    pthread_mutex_unlock(&handle->lock);
+}
+
+static void notify_completion(AsyncSolvePool* pool) {
+#ifdef __linux__
+    uint64_t one = 1;
+    ssize_t written = write(pool->notify_write_fd, &one, sizeof(one));
+#else
+    char one = 1;
+    ssize_t written = write(pool->notify_write_fd, &one, sizeof(one));
+#endif
+    (void)written;  // Counter saturation or a full pipe still leaves the fd readable
+}
+
+/**
+ * @brief Parses and solves one submission on the calling pool thread
+ */
+static void run_async_solve(AsyncSolveHandle* handle) {
+    pthread_mutex_lock(&handle->lock);
+    clock_gettime(CLOCK_MONOTONIC, &handle->started);
+    if (atomic_load(&handle->cancel)) {
+        handle->status = ASYNC_SOLVE_CANCELLED;
+        handle->finished = handle->started;
+        pthread_mutex_unlock(&handle->lock);
+        return;
+    }
+    handle->status = ASYNC_SOLVE_RUNNING;
+    pthread_mutex_unlock(&handle->lock);
+
+    // The solver itself is charged too: the limit covers the whole request
+    size_t memory_limit = handle->has_options ? handle->options.memory_limit : 0;
+    MemoryBudget* budget = memory_budget_create(memory_limit);
+    LayoutSolver* solver = budget ? memory_budget_alloc(budget, sizeof(LayoutSolver)) : NULL;
+    AsyncSolveStatus status = ASYNC_SOLVE_MEMORY_EXHAUSTED;
+    if (solver) {
+        status = ASYNC_SOLVE_PARSE_ERROR;
+        init_solver(solver, 60, 40);
+        solver->verbose = 0;
+        solver->tree_debug_enabled = 0;
+        solver->cancel_flag = &handle->cancel;
+        solver->progress_hook = async_progress_hook;
+        solver->progress_context = handle;
+        solver->memory_budget = budget;
+        if (handle->has_options) {
+            solver->search_threads = handle->options.search_threads;
+            solver->nogood_store = handle->options.nogood_store;
+            if (handle->options.search_config) {
+                solver->search_config = *handle->options.search_config;
+            }
+        }
+
+        if (parse_specification_string(handle->spec_text, solver)) {
+            pthread_mutex_lock(&handle->lock);
+            handle->component_count = solver->component_count;
+            pthread_mutex_unlock(&handle->lock);
+
+            if (solve_constraints(solver)) {
+                status = ASYNC_SOLVE_SOLVED;
+            } else if (solver->memory_exhausted) {
+                status = ASYNC_SOLVE_MEMORY_EXHAUSTED;
+            } else {
+                status = solver->search_cancelled ? ASYNC_SOLVE_CANCELLED : ASYNC_SOLVE_FAILED;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&handle->lock);
+    if (solver) {
+        handle->component_count = solver->component_count;
+        handle->nodes_created = solver->tree_solver.nodes_created;
+        handle->backtracks = solver->tree_solver.backtracks;
+        if (status == ASYNC_SOLVE_SOLVED) {
+            memcpy(handle->partial, solver->placements, sizeof(handle->partial));
+            handle->partial_placed = count_placed(solver->placements, solver->component_count);
+        }
+    }
+    handle->solver = solver;
+    handle->budget = budget;
+    handle->memory_peak = budget ? atomic_load(&budget->peak) : 0;
+    handle->status = status;
+    clock_gettime(CLOCK_MONOTONIC, &handle->finished);
+    pthread_mutex_unlock(&handle->lock);
+}
+
+static void* async_pool_thread(void* arg) {
+    PoolThreadArg* thread_arg = arg;
+    AsyncSolvePool* pool = thread_arg->pool;
+    int index = thread_arg->index;
+    free(thread_arg);
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->queue_head && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        AsyncSolveHandle* handle = pool->queue_head;
+        if (!handle) {
+            pthread_mutex_unlock(&pool->lock);
+            break;  // Shut down with an empty queue
+        }
+        pool->queue_head = handle->next;
+        if (!pool->queue_head) {
+            pool->queue_tail = NULL;
+        }
+        handle->next = NULL;
+        pool->running[index] = handle;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_async_solve(handle);
+
+        // The callback runs before the handle becomes visible to the event
+        // loop, which may release it as soon as it is popped
+        if (handle->callback) {
+            handle->callback(handle, handle->user_data);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        pool->running[index] = NULL;
+        if (pool->done_tail) {
+            pool->done_tail->next = handle;
+        } else {
+            pool->done_head = handle;
+        }
+        pool->done_tail = handle;
+        pthread_mutex_unlock(&pool->lock);
+
+        notify_completion(pool);
+    }
+    return NULL;
+}
+
+AsyncSolvePool* async_pool_create(int thread_count) {
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+
+    AsyncSolvePool* pool = calloc(1, sizeof(AsyncSolvePool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->threads = calloc(thread_count, sizeof(pthread_t));
+    pool->running = calloc(thread_count, sizeof(AsyncSolveHandle*));
+    if (!pool->threads || !pool->running) {
+        free(pool->threads);
+        free(pool->running);
+        free(pool);
+        return NULL;
+    }
+
+#ifdef __linux__
+    pool->notify_read_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    pool->notify_write_fd = pool->notify_read_fd;
+    if (pool->notify_read_fd < 0) {
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+        pool->notify_read_fd = fds[0];
+        pool->notify_write_fd = fds[1];
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    } else {
+#endif
+        free(pool->threads);
+        free(pool->running);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+
+    for (int i = 0; i < thread_count; i++) {
+        PoolThreadArg* arg = malloc(sizeof(PoolThreadArg));
+        if (!arg) {
+            break;
+        }
+        arg->pool = pool;
+        arg->index = i;
+        if (pthread_create(&pool->threads[i], NULL, async_pool_thread, arg) != 0) {
+            free(arg);
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    if (pool->thread_count == 0) {
+        async_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void async_pool_destroy(AsyncSolvePool* pool) {
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    for (AsyncSolveHandle* handle = pool->queue_head; handle; handle = handle->next) {
+        atomic_store(&handle->cancel, 1);
+    }
+    for (int i = 0; i < pool->thread_count; i++) {
+        if (pool->running[i]) {
+            atomic_store(&pool->running[i]->cancel, 1);
+        }
+    }
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    while (pool->done_head) {
+        AsyncSolveHandle* handle = pool->done_head;
+        pool->done_head = handle->next;
+        drop_reference(handle);
+    }
+
+    close(pool->notify_read_fd);
+    if (pool->notify_write_fd != pool->notify_read_fd) {
+        close(pool->notify_write_fd);
+    }
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool->running);
+    free(pool);
+}
+
+int async_pool_event_fd(AsyncSolvePool* pool) {
+    return pool->notify_read_fd;
+}
+
+void async_pool_ack_events(AsyncSolvePool* pool) {
+#ifdef __linux__
+    uint64_t count;
+    while (read(pool->notify_read_fd, &count, sizeof(count)) > 0) {
+    }
+#else
+    char buffer[64];
+    while (read(pool->notify_read_fd, buffer, sizeof(buffer)) > 0) {
+    }
+#endif
+}
+
+AsyncSolveHandle* async_pool_next_completed(AsyncSolvePool* pool) {
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        AsyncSolveHandle* handle = pool->done_head;
+        if (handle) {
+            pool->done_head = handle->next;
+            if (!pool->done_head) {
+                pool->done_tail = NULL;
+            }
+            handle->next = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        if (!handle) {
+            return NULL;
+        }
+
+        // The pool's reference ends here; skip handles the caller already released
+        if (atomic_fetch_sub(&handle->refs, 1) == 1) {
+            free_handle(handle);
+            continue;
+        }
+        return handle;
+    }
+}
+
+AsyncSolveHandle* async_solve_submit(AsyncSolvePool* pool, const char* spec_text,
+                                     const AsyncSolveOptions* options,
+                                     AsyncSolveCallback callback, void* user_data) {
+    AsyncSolveHandle* handle = calloc(1, sizeof(AsyncSolveHandle));
+    if (!handle) {
+        return NULL;
+    }
+    handle->spec_text = strdup(spec_text);
+    if (!handle->spec_text) {
+        free(handle);
+        return NULL;
+    }
+
+    pthread_mutex_init(&handle->lock, NULL);
+    atomic_init(&handle->refs, 2);  // Caller and pool
+    atomic_init(&handle->cancel, 0);
+    atomic_init(&handle->progress_calls, 0);
+    atomic_init(&handle->best_placed, 0);
+    handle->status = ASYNC_SOLVE_QUEUED;
+    handle->callback = callback;
+    handle->user_data = user_data;
+    if (options) {
+        handle->options = *options;
+        handle->has_options = 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &handle->submitted);
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->shutdown) {
+        pthread_mutex_unlock(&pool->lock);
+        free_handle(handle);
+        return NULL;
+    }
+    if (pool->queue_tail) {
+        pool->queue_tail->next = handle;
+    } else {
+        pool->queue_head = handle;
+    }
+    pool->queue_tail = handle;
+    pthread_cond_signal(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    return handle;
+}
+
+AsyncSolveStatus async_solve_status(AsyncSolveHandle* handle) {
+    pthread_mutex_lock(&handle->lock);
+    AsyncSolveStatus status = handle->status;
+    pthread_mutex_unlock(&handle->lock);
+    return status;
+}
+
+void async_solve_stats(AsyncSolveHandle* handle, AsyncSolveStats* stats) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&handle->lock);
+    stats->status = handle->status;
+    stats->component_count = handle->component_count;
+    stats->placed_count = handle->partial_placed;
+    stats->nodes_created = handle->nodes_created;
+    stats->backtracks = handle->backtracks;
+    stats->memory_peak = handle->memory_peak;
+    if (handle->status == ASYNC_SOLVE_QUEUED) {
+        stats->queue_ms = elapsed_ms(&handle->submitted, &now);
+        stats->solve_ms = 0.0;
+    } else {
+        stats->queue_ms = elapsed_ms(&handle->submitted, &handle->started);
+        stats->solve_ms = handle->status == ASYNC_SOLVE_RUNNING
+                              ? elapsed_ms(&handle->started, &now)
+                              : elapsed_ms(&handle->started, &handle->finished);
+    }
+    pthread_mutex_unlock(&handle->lock);
+}
+
+int async_solve_partial(AsyncSolveHandle* handle, PlacementRecord* out, int max_records) {
+    pthread_mutex_lock(&handle->lock);
+    int count = handle->component_count < max_records ? handle->component_count : max_records;
+    memcpy(out, handle->partial, count * sizeof(PlacementRecord));
+    pthread_mutex_unlock(&handle->lock);
+    return count;
+}
+
+void async_solve_cancel(AsyncSolveHandle* handle) {
+    atomic_store(&handle->cancel, 1);
+}
+
+LayoutSolver* async_solve_result(AsyncSolveHandle* handle) {
+    pthread_mutex_lock(&handle->lock);
+    int final = handle->status != ASYNC_SOLVE_QUEUED && handle->status != ASYNC_SOLVE_RUNNING;
+    LayoutSolver* solver = final ? handle->solver : NULL;
+    pthread_mutex_unlock(&handle->lock);
+    return solver;
+}
+
+void* async_solve_user_data(AsyncSolveHandle* handle) {
+    return handle->user_data;
+}
+
+void async_solve_release(AsyncSolveHandle* handle) {
+    if (!handle) {
+        return;
+    }
+    atomic_store(&handle->cancel, 1);  // No effect once the solve finished
+    drop_reference(handle);
+}
@@ -0,0 +1,158 @@
+#ifndef ASYNC_SOLVER_H
+#define ASYNC_SOLVER_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// ASYNCHRONOUS SOLVE API
+// =============================================================================
+//
+// For event-loop servers that cannot block on solve_tree_constraint(): specs
+// are submitted to an internal thread pool and each submission returns a
+// handle. Completion is signalled three ways:
+//   - the handle's callback, invoked on the pool thread that ran the solve
+//   - the pool's notification fd (eventfd on Linux, a pipe elsewhere), which
+//     becomes readable and can be registered with epoll/poll
+//   - async_pool_next_completed(), which hands out finished handles in
+//     completion order once the fd fired
+//
+// Typical loop:
+//   fd = async_pool_event_fd(pool);            // add to epoll, EPOLLIN
+//   on readable: async_pool_ack_events(pool);
+//                while ((h = async_pool_next_completed(pool))) { ...; async_solve_release(h); }
+
+typedef struct AsyncSolvePool AsyncSolvePool;
+typedef struct AsyncSolveHandle AsyncSolveHandle;
+
+typedef enum {
+    ASYNC_SOLVE_QUEUED,         // Waiting for a pool thread
+    ASYNC_SOLVE_RUNNING,        // Parsing or searching
+    ASYNC_SOLVE_SOLVED,         // Layout found
+    ASYNC_SOLVE_FAILED,         // Search exhausted without a layout
+    ASYNC_SOLVE_PARSE_ERROR,    // Spec could not be parsed
+    ASYNC_SOLVE_CANCELLED,      // Cancelled before or during the search
+    ASYNC_SOLVE_MEMORY_EXHAUSTED // Stopped at the submission's memory_limit
+} AsyncSolveStatus;
+
+// Callback on completion; runs on a pool thread, must not release the handle
+typedef void (*AsyncSolveCallback)(AsyncSolveHandle* handle, void* user_data);
+
+// Per-submission settings; NULL options mean the classic serial search
+typedef struct AsyncSolveOptions {
+    int search_threads;                 // See LayoutSolver.search_threads
+    const SearchConfig* search_config;  // NULL = DEFAULT_SEARCH_CONFIG
+    struct NogoodStore* nogood_store;   // Optional shared store for this spec
+    size_t memory_limit;                // Bytes for the solver, its tree and search
+                                        // copies (0 = unlimited); see memory_budget.h
+} AsyncSolveOptions;
+
+typedef struct AsyncSolveStats {
+    AsyncSolveStatus status;
+    int component_count;
+    int placed_count;                   // Components in the latest snapshot
+    int nodes_created;
+    int backtracks;
+    double queue_ms;                    // Submission to start of the solve
+    double solve_ms;                    // Start of the solve to now / completion
+    size_t memory_peak;                 // Peak accounted bytes, once the status is final
+} AsyncSolveStats;
+
+/**
+ * @brief Starts a pool of solver threads
+ * @param thread_count Number of concurrent solves (at least 1)
+ * @return             New pool, or NULL on failure
+ */
+AsyncSolvePool* async_pool_create(int thread_count);
+
+/**
+ * @brief Cancels outstanding work, joins the threads and frees the pool
+ *
+ * Handles the caller still holds stay valid until released.
+ *
+ * @param pool Pool to destroy
+ */
+void async_pool_destroy(AsyncSolvePool* pool);
+
+/**
+ * @brief Notification fd that becomes readable when solves complete
+ * @param pool The pool
+ * @return     File descriptor to register with epoll/poll for reading
+ */
+int async_pool_event_fd(AsyncSolvePool* pool);
+
+/**
+ * @brief Drains the notification fd after it became readable
+ * @param pool The pool
+ */
+void async_pool_ack_events(AsyncSolvePool* pool);
+
+/**
+ * @brief Pops the next finished handle in completion order
+ * @param pool The pool
+ * @return     Finished handle (still owned by the caller), or NULL if none
+ */
+AsyncSolveHandle* async_pool_next_completed(AsyncSolvePool* pool);
+
+/**
+ * @brief Queues a spec for solving
+ * @param pool      The pool
+ * @param spec_text DSL specification; copied, the caller keeps ownership
+ * @param options   Search settings, may be NULL
+ * @param callback  Completion callback, may be NULL
+ * @param user_data Passed to the callback and returned by async_solve_user_data()
+ * @return          Handle owned by the caller (release with async_solve_release), or NULL
+ */
+AsyncSolveHandle* async_solve_submit(AsyncSolvePool* pool, const char* spec_text,
+                                     const AsyncSolveOptions* options,
+                                     AsyncSolveCallback callback, void* user_data);
+
+/**
+ * @brief Current status of a submission
+ */
+AsyncSolveStatus async_solve_status(AsyncSolveHandle* handle);
+
+/**
+ * @brief Snapshot of status, timing and search counters
+ * @param handle The submission
+ * @param stats  Receives the snapshot
+ */
+void async_solve_stats(AsyncSolveHandle* handle, AsyncSolveStats* stats);
+
+/**
+ * @brief Copies the deepest partial layout seen so far (or the final layout)
+ *
+ * Records are indexed like the spec's components; unplaced ones have
+ * is_placed == 0.
+ *
+ * @param handle The submission
+ * @param out    Receives up to max_records records
+ * @param max_records Capacity of out
+ * @return       Number of records written (the spec's component count)
+ */
+int async_solve_partial(AsyncSolveHandle* handle, PlacementRecord* out, int max_records);
+
+/**
+ * @brief Requests cancellation; queued solves never start
+ * @param handle The submission
+ */
+void async_solve_cancel(AsyncSolveHandle* handle);
+
+/**
+ * @brief Solver holding the final layout, for display_grid() and friends
+ * @param handle The submission
+ * @return       The solver once the status is final, NULL while queued or running
+ */
+LayoutSolver* async_solve_result(AsyncSolveHandle* handle);
+
+/**
+ * @brief User data given at submission
+ */
+void* async_solve_user_data(AsyncSolveHandle* handle);
+
+/**
+ * @brief Drops the caller's reference; a running solve is cancelled first
+ * @param handle The submission, may be NULL
+ */
+void async_solve_release(AsyncSolveHandle* handle);
+
+#endif // ASYNC_SOLVER_H
@@ -1,5 +1,35 @@
 #!/bin/bash
 
+# Usage:
+#   ./build.sh            Development build (no optimization)
+#   ./build.sh --release  Optimized build: -O3 with link-time optimization
+#   ./build.sh --pgo      Release build plus profile-guided optimization:
+#                         instrumented build -> training run -> rebuild
+#   ./build.sh --usdt     Compile in the USDT tracepoints from solver_trace.h
+#                         (combines with any mode above; needs <sys/sdt.h>)
+
+BUILD_MODE="dev"
+TRACE_CFLAGS=""
+for arg in "$@"; do
+    case "$arg" in
+        --release) BUILD_MODE="release" ;;
+        --pgo)     BUILD_MODE="pgo" ;;
+        --usdt)    TRACE_CFLAGS="-DENABLE_USDT" ;;
+        *)
+            echo "Unknown option: $arg"
+            echo "Usage: ./build.sh [--release | --pgo] [--usdt]"
+            exit 1
+            ;;
+    esac
+done
+
+RELEASE_CFLAGS="-O3 -flto -DNDEBUG"
+PGO_DIR="pgo_profile"
+PGO_TRAINING_DIR="pgo_training"
+PGO_TRAINING_REPEAT=5
+
+SOLVER_SOURCES="constraint_solver.c constraints.c tree_debug.c dsl_parser.c portfolio.c parallel_search.c nogood_store.c async_solver.c memory_budget.c floors.c search_profile.c solver_arena.c option_cache.c root_probe.c unsat_core.c spec_repair.c layout_archive.c"
+
 echo "Building ASCII Structure System..."
 
 # Check for required dependencies
@@ -17,31 +47,129 @@ if ! pkg-config --exists libcjson; then
     exit 1
 fi
 
+# Check for USDT headers when tracepoints are requested
+if [ -n "$TRACE_CFLAGS" ] && ! echo '#include <sys/sdt.h>' | gcc -E - > /dev/null 2>&1; then
+    echo "Error: sys/sdt.h not found. Install with: sudo apt-get install systemtap-sdt-dev"
+    exit 1
+fi
+
+# Compile both executables with the given extra flags
+build_components() {
+    local extra_cflags="$1 $TRACE_CFLAGS"
+
+    # 1. Build main ASCII structure system
+    echo "1. Compiling main ASCII structure system..."
+    gcc $extra_cflags -o ascii_structure_system main.c $SOLVER_SOURCES \
+        llm_integration.c alloc_counter.c parser_bench.c load_generator.c \
+        $(pkg-config --cflags --libs libcurl libcjson) \
+        -lm -pthread -Wall -Wextra
+
+    if [ $? -ne 0 ]; then
+        echo "❌ Main system build failed!"
+        exit 1
+    fi
+
+    # 2. Build constraint testing system
+    echo "2. Compiling constraint testing system..."
+    gcc $extra_cflags -o constraint_test constraint_test.c $SOLVER_SOURCES \
+        $(pkg-config --cflags --libs libcjson) \
+        -lm -pthread -Wall -Wextra
+
+    if [ $? -ne 0 ]; then
+        echo "❌ Constraint test system build failed!"
+        exit 1
+    fi
+}
+
+# Write a deterministic set of synthetic specs for PGO training: trees of
+# rectangular and irregular rooms joined by directional ADJACENT constraints
+generate_training_specs() {
+    local out_dir="$1"
+    local count="$2"
+    local directions=(n s e w)
+
+    rm -rf "$out_dir"
+    mkdir -p "$out_dir"
+    RANDOM=1337
+
+    for ((spec = 1; spec <= count; spec++)); do
+        local file="$out_dir/synthetic_$spec.txt"
+        local rooms=$((3 + RANDOM % 6))
+
+        {
+            echo "## Components"
+            echo ""
+            for ((r = 1; r <= rooms; r++)); do
+                echo "**Room$r** - Synthetic training room $r"
+                echo ""
+            done
+
+            echo "## Constraints"
+            echo ""
+            for ((r = 2; r <= rooms; r++)); do
+                local anchor=$((1 + RANDOM % (r - 1)))
+                echo "ADJACENT(Room$r, Room$anchor, ${directions[$((RANDOM % 4))]})"
+            done
+            echo ""
+
+            echo "## Component Tiles"
+            echo ""
+            for ((r = 1; r <= rooms; r++)); do
+                local w=$((4 + RANDOM % 10))
+                local h=$((3 + RANDOM % 7))
+                local irregular=$((RANDOM % 3 == 0))
+                echo "**Room$r:**"
+                echo '```'
+                for ((y = 0; y < h; y++)); do
+                    local row=""
+                    for ((x = 0; x < w; x++)); do
+                        if [ $irregular -eq 1 ] && [ $y -lt $((h / 2)) ] && [ $x -ge $((w / 2)) ]; then
+                            row+=" "
+                        elif [ $y -eq 0 ] || [ $y -eq $((h - 1)) ] || [ $x -eq 0 ] || [ $x -eq $((w - 1)) ]; then
+                            row+="X"
+                        else
+                            row+="."
+                        fi
+                    done
+                    echo "$row"
+                done
+                echo '```'
+                echo ""
+            done
+        } > "$file"
+    done
+}
+
 echo ""
-echo "Building all system components..."
+echo "Building all system components ($BUILD_MODE${TRACE_CFLAGS:+, USDT probes})..."
 echo "================================="
 
-# 1. Build main ASCII structure system
-echo "1. Compiling main ASCII structure system..."
-gcc -o ascii_structure_system main.c constraint_solver.c \
-    constraints.c tree_debug.c llm_integration.c \
-    $(pkg-config --cflags --libs libcurl libcjson) \
-    -lm -Wall -Wextra
+case "$BUILD_MODE" in
+    dev)
+        build_components ""
+        ;;
+    release)
+        build_components "$RELEASE_CFLAGS"
+        ;;
+    pgo)
+        echo "PGO step 1/3: instrumented build"
+        rm -rf "$PGO_DIR"
+        build_components "$RELEASE_CFLAGS -fprofile-generate -fprofile-dir=$PGO_DIR -fprofile-update=prefer-atomic"
 
-if [ $? -ne 0 ]; then
-    echo "❌ Main system build failed!"
-    exit 1
-fi
-
-# 2. Build constraint testing system
-echo "2. Compiling constraint testing system..."
-gcc -o constraint_test constraint_test.c constraint_solver.c constraints.c tree_debug.c \
-    -lm -Wall -Wextra
+        echo "PGO step 2/3: training on tests/ and synthetic specs"
+        generate_training_specs "$PGO_TRAINING_DIR" 40
+        ./ascii_structure_system --solve --quiet --repeat $PGO_TRAINING_REPEAT \
+            tests/*.txt "$PGO_TRAINING_DIR"/*.txt > /dev/null
+        if [ ! -d "$PGO_DIR" ]; then
+            echo "❌ Training run produced no profile data!"
+            exit 1
+        fi
 
-if [ $? -ne 0 ]; then
-    echo "❌ Constraint test system build failed!"
-    exit 1
-fi
+        echo "PGO step 3/3: optimized rebuild with collected profiles"
+        build_components "$RELEASE_CFLAGS -fprofile-use -fprofile-dir=$PGO_DIR -fprofile-correction -Wno-missing-profile"
+        rm -rf "$PGO_TRAINING_DIR"
+        ;;
+esac
 
 
 echo ""
@@ -53,7 +181,28 @@ echo "  • constraint_test         - Constraint testing and visualization"
 echo ""
 echo "Usage:"
 echo "  ./ascii_structure_system  - Run main system (requires OpenAI API key)"
+echo "  ./ascii_structure_system --solve [--quiet] [--repeat N] [--threads N]"
+echo "                            [--portfolio K] [--portfolio-log FILE]"
+echo "                            [--nogoods SLOTS] [--async N]"
+echo "                            [--memory-budget MB] [--flame-graph FILE]"
+echo "                            [--flame-metric time|nodes] [--depth-stats FILE]"
+echo "                            [--join-constraints] [--forward-check]"
+echo "                            [--no-option-cache] [--probe-root NODES] [--unsat-core]"
+echo "                            [--check-allocations] [--archive FILE] [--archive-grid]"
+echo "                            [--print-layout] FILE..."
+echo "                            - Solve spec files headlessly"
+echo "  ./ascii_structure_system --generate TYPE [--variants N] [--async N]"
+echo "                            [--print-layout]"
+echo "                            - Generate and solve several specs in one API call"
+echo "  ./ascii_structure_system --bench-parser [--specs N] [--rounds N] [--seed S]"
+echo "                            [FILE...]"
+echo "                            - Parser throughput and format equivalence check"
+echo "  ./ascii_structure_system --load-test [--rate R] [--duration S] [--pool N]"
+echo "                            [--timeout MS] [--hgrm PREFIX] FILE..."
+echo "                            - Fixed-rate load test with latency percentiles"
+echo "  ./ascii_structure_system --show-archive FILE [--quiet] [ID...]"
+echo "                            - Summarize and render a layout archive"
 echo "  ./constraint_test         - Test individual constraints interactively"
 echo ""
 echo "For main system, set your OpenAI API key:"
-echo "export OPENAI_API_KEY='your-api-key-here'"
\ No newline at end of file
+echo "export OPENAI_API_KEY='your-api-key-here'"
@@ -1,9 +1,19 @@
 #include "constraint_solver.h"
 #include "constraints.h"
 #include "tree_debug.h"
+#include "solver_trace.h"
+#include "parallel_search.h"
+#include "nogood_store.h"
+#include "memory_budget.h"
+#include "floors.h"
+#include "search_profile.h"
+#include "solver_arena.h"
+#include "option_cache.h"
+#include "root_probe.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 // =============================================================================
 // DYNAMIC GRID CONSTRAINT SOLVER IMPLEMENTATION
@@ -39,6 +49,29 @@ void add_component(LayoutSolver *solver, const char *name,
   comp->placed_x = -1;
   comp->placed_y = -1;
   comp->group_id = 0;
+  comp->floor = 0;
+  comp->is_pinned = 0;
+  comp->has_footprint = 0;
+
+  set_component_tile(solver, solver->component_count, ascii_data);
+  solver->component_count++;
+}
+
+/**
+ * @brief Replaces a component's ASCII tile and everything compiled from it
+ *
+ * Used by add_component() for new components and by spec repair to swap
+ * one tile of an already parsed spec: the row bitmasks of the component
+ * and the overlap kernels of every pair it forms are recomputed, the rest
+ * of the spec is left as compiled.
+ *
+ * @param solver     The layout solver instance
+ * @param index      Component index (at most component_count)
+ * @param ascii_data Raw ASCII art string (newline-separated rows)
+ */
+void set_component_tile(LayoutSolver *solver, int index,
+                        const char *ascii_data) {
+  Component *comp = &solver->components[index];
 
   // Parse ASCII tile data - avoid strtok to prevent interference with parsing
   comp->width = 0;
@@ -81,14 +114,33 @@ void add_component(LayoutSolver *solver, const char *name,
   }
 
   comp->height = row;
-  solver->component_count++;
+  sync_placement_record(solver, comp);
+
+  // Precompute row bitmasks and resolve the overlap kernel for every pair
+  // this component forms with the other loaded components
+  for (int r = 0; r < MAX_TILE_SIZE; r++) {
+    uint64_t mask = 0;
+    for (int c = 0; c < comp->width && c < MAX_KERNEL_TILE_WIDTH; c++) {
+      if (comp->ascii_tile[r][c] != ' ')
+        mask |= (uint64_t)1 << c;
+    }
+    solver->tile_row_masks[index][r] = mask;
+  }
+  int loaded = index < solver->component_count ? solver->component_count : index + 1;
+  for (int j = 0; j < loaded; j++) {
+    OverlapKernel kernel =
+        select_overlap_kernel(comp->width, solver->components[j].width);
+    solver->overlap_kernels[index][j] = kernel;
+    solver->overlap_kernels[j][index] = kernel;
+  }
 }
 
 /**
  * @brief Adds a DSL constraint to the solver
  *
  * Parses constraint string in DSL format and adds it to the solver's constraint
- * list. Currently supports ADJACENT constraints with directional parameters.
+ * list. Supports ADJACENT constraints with directional parameters and the
+ * vertical ABOVE(a, b) / STAIRS(a, b) constraints of multi-floor specs.
  *
  * @param solver         The layout solver instance
  * @param constraint_line DSL constraint string (e.g., "ADJACENT(Gatehouse,
@@ -101,8 +153,6 @@ void add_constraint(LayoutSolver *solver, const char *constraint_line) {
   if (solver->constraint_count >= MAX_CONSTRAINTS)
     return;
 
-  DSLConstraint *constraint = &solver->constraints[solver->constraint_count];
-
   // Parse constraint format: ADJACENT(a, b, direction)
   char type_str[32], params[256];
   if (sscanf(constraint_line, "%31[^(](%255[^)])", type_str, params) != 2) {
@@ -111,16 +161,72 @@ void add_constraint(LayoutSolver *solver, const char *constraint_line) {
 
   // Only handle ADJACENT constraints
   if (strcmp(type_str, "ADJACENT") == 0) {
-    constraint->type = DSL_ADJACENT;
-    char dir_char;
-    sscanf(params, "%63[^,], %63[^,], %c", constraint->component_a,
-           constraint->component_b, &dir_char);
-    constraint->direction = dir_char;
-    solver->constraint_count++;
+    char component_a[64] = "", component_b[64] = "";
+    char dir_char = 0;
+    sscanf(params, "%63[^,], %63[^,], %c", component_a, component_b, &dir_char);
+    add_adjacent_constraint(solver, component_a, component_b, dir_char);
+  } else if (strcmp(type_str, "ABOVE") == 0 || strcmp(type_str, "STAIRS") == 0) {
+    char component_a[64] = "", component_b[64] = "";
+    sscanf(params, "%63[^,], %63[^, ]", component_a, component_b);
+    add_vertical_constraint(solver, type_str[0] == 'A' ? DSL_ABOVE : DSL_STAIRS,
+                            component_a, component_b);
   }
   // Ignore all other constraint types
 }
 
+/**
+ * @brief Adds an ADJACENT constraint from already separated fields
+ *
+ * Used by add_constraint() and by the JSON spec parser, which gets the
+ * fields typed and does not go through the DSL text form.
+ *
+ * @param solver      The layout solver instance
+ * @param component_a Component placed relative to component_b
+ * @param component_b Reference component
+ * @param direction   'n', 'e', 's', 'w' or 'a'
+ * @return            1 if added, 0 if the constraint table is full
+ */
+int add_adjacent_constraint(LayoutSolver *solver, const char *component_a,
+                            const char *component_b, Direction direction) {
+  if (solver->constraint_count >= MAX_CONSTRAINTS)
+    return 0;
+
+  DSLConstraint *constraint = &solver->constraints[solver->constraint_count];
+  constraint->type = DSL_ADJACENT;
+  snprintf(constraint->component_a, sizeof(constraint->component_a), "%s", component_a);
+  snprintf(constraint->component_b, sizeof(constraint->component_b), "%s", component_b);
+  constraint->direction = direction;
+  solver->constraint_count++;
+  return 1;
+}
+
+/**
+ * @brief Adds an ABOVE or STAIRS constraint between two floors
+ *
+ * Vertical constraints are kept apart from the ADJACENT table: the tree
+ * search never sees them, they only decide floors and how the per-floor
+ * layouts are stacked (see floors.c).
+ *
+ * @param solver      The layout solver instance
+ * @param type        DSL_ABOVE or DSL_STAIRS
+ * @param component_a Component on the upper floor
+ * @param component_b Component on the floor below
+ * @return            1 if added, 0 if the constraint table is full
+ */
+int add_vertical_constraint(LayoutSolver *solver, DSLConstraintType type,
+                            const char *component_a, const char *component_b) {
+  if (solver->vertical_count >= MAX_CONSTRAINTS)
+    return 0;
+
+  DSLConstraint *constraint = &solver->vertical_constraints[solver->vertical_count];
+  constraint->type = type;
+  snprintf(constraint->component_a, sizeof(constraint->component_a), "%s", component_a);
+  snprintf(constraint->component_b, sizeof(constraint->component_b), "%s", component_b);
+  constraint->direction = 'a';
+  solver->vertical_count++;
+  return 1;
+}
+
 /**
  * @brief Finds a component by name in the solver's component list
  *
@@ -140,6 +246,26 @@ Component *find_component(LayoutSolver *solver, const char *name) {
   return NULL;
 }
 
+/**
+ * @brief Copies a component's placement state into its hot PlacementRecord
+ *
+ * Every function that changes placed_x, placed_y, is_placed or the tile
+ * dimensions calls this so scans over solver->placements stay in step with
+ * the Component array.
+ *
+ * @param solver The layout solver instance
+ * @param comp   Component whose record should be refreshed
+ */
+void sync_placement_record(LayoutSolver *solver, Component *comp) {
+  PlacementRecord *rec = &solver->placements[comp - solver->components];
+  rec->x = comp->placed_x;
+  rec->y = comp->placed_y;
+  rec->width = (int16_t)comp->width;
+  rec->height = (int16_t)comp->height;
+  rec->is_placed = (int16_t)comp->is_placed;
+  rec->reserved = 0;
+}
+
 /**
  * @brief Check if a component placement is valid at given coordinates
  *
@@ -162,13 +288,12 @@ int is_placement_valid(LayoutSolver *solver, Component *comp, int x, int y) {
   expand_grid_for_component(solver, comp, x, y);
 
   // Check for overlap with other placed components
+  int comp_index = comp - solver->components;
   for (int i = 0; i < solver->component_count; i++) {
-    Component *other = &solver->components[i];
-    if (other == comp || !other->is_placed)
+    if (i == comp_index || !solver->placements[i].is_placed)
       continue;
 
-    if (has_character_overlap(solver, comp, x, y, other, other->placed_x,
-                              other->placed_y)) {
+    if (placement_overlaps(solver, comp, x, y, i)) {
       return 0; // Overlap detected
     }
   }
@@ -200,6 +325,12 @@ void place_component(LayoutSolver *solver, Component *comp, int x, int y) {
   comp->is_placed = 1;
   comp->placed_x = x;
   comp->placed_y = y;
+  sync_placement_record(solver, comp);
+  TRACE_PLACE((int)(comp - solver->components), x, y);
+  if (solver->option_cache) {
+    option_cache_track_placement(solver->option_cache, (int)(comp - solver->components), 1, x,
+                                 y, comp->width, comp->height);
+  }
 
   // Place component tiles on grid
   for (int dy = 0; dy < comp->height; dy++) {
@@ -217,7 +348,7 @@ void place_component(LayoutSolver *solver, Component *comp, int x, int y) {
     }
   }
 
-  printf("  ✅ Placed %s at (%d,%d)\n", comp->name, x, y);
+  SOLVER_LOG(solver, "  ✅ Placed %s at (%d,%d)\n", comp->name, x, y);
 }
 
 /**
@@ -235,6 +366,13 @@ void remove_component(LayoutSolver *solver, Component *comp) {
   if (!comp || !comp->is_placed)
     return;
 
+  TRACE_REMOVE((int)(comp - solver->components), comp->placed_x,
+               comp->placed_y);
+  if (solver->option_cache) {
+    option_cache_track_placement(solver->option_cache, (int)(comp - solver->components), 0,
+                                 comp->placed_x, comp->placed_y, comp->width, comp->height);
+  }
+
   // Remove component tiles from grid (restore to spaces)
   for (int dy = 0; dy < comp->height; dy++) {
     for (int dx = 0; dx < comp->width; dx++) {
@@ -255,8 +393,9 @@ void remove_component(LayoutSolver *solver, Component *comp) {
   comp->is_placed = 0;
   comp->placed_x = -1;
   comp->placed_y = -1;
+  sync_placement_record(solver, comp);
 
-  printf("  🗑️  Removed %s from grid\n", comp->name);
+  SOLVER_LOG(solver, "  🗑️  Removed %s from grid\n", comp->name);
 }
 
 
@@ -546,18 +685,50 @@ void debug_log_placement_grid(LayoutSolver *solver, const char *title,
  * @param width  Initial grid width (will expand dynamically)
  * @param height Initial grid height (will expand dynamically)
  */
+const SearchConfig DEFAULT_SEARCH_CONFIG = {
+    "static/preference/most-constrained", CONSTRAINT_ORDER_STATIC,
+    TIE_BREAK_PREFERENCE, ROOT_MOST_CONSTRAINED, 0};
+
 void init_solver(LayoutSolver *solver, int width, int height) {
 
   solver->component_count = 0;
   solver->constraint_count = 0;
+  solver->vertical_count = 0;
+  solver->floor_count = 1;
   solver->grid_width = width;
   solver->grid_height = height;
   solver->grid_min_x = 0;
   solver->grid_min_y = 0;
   solver->next_group_id = 1;
   solver->debug_file = NULL;
+  solver->tree_debug_file = NULL;
+  solver->verbose = 1;
+  solver->tree_debug_enabled = 1;
   // Only tree-based constraint solver is used
-
+  solver->join_constraints = 0;
+  solver->forward_checking = 0;
+  solver->root_probe_nodes = DEFAULT_ROOT_PROBE_NODES;
+  solver->forced_root = -1;
+  solver->root_x = 50; // Center of grid
+  solver->root_y = 50;
+  solver->node_limit = 0;
+  memset(&solver->root_probe_stats, 0, sizeof(solver->root_probe_stats));
+  solver->search_config = DEFAULT_SEARCH_CONFIG;
+  solver->rng_state = DEFAULT_SEARCH_CONFIG.seed;
+  solver->cancel_flag = NULL;
+  solver->search_cancelled = 0;
+  solver->search_threads = 0;
+  solver->nogood_store = NULL;
+  memset(&solver->nogood_stats, 0, sizeof(solver->nogood_stats));
+  solver->progress_hook = NULL;
+  solver->progress_context = NULL;
+  solver->accept_hook = NULL;
+  solver->accept_context = NULL;
+  solver->memory_budget = NULL;
+  solver->memory_exhausted = 0;
+  solver->search_profile = NULL;
+  solver->arena = NULL;
+  solver->option_cache = NULL;
 
 
   // Initialize grid with empty spaces
@@ -581,6 +752,55 @@ void init_solver(LayoutSolver *solver, int width, int height) {
   }
 }
 
+/**
+ * @brief Prepares a solver for the next spec without dropping its setup
+ *
+ * Same as init_solver(), except that the output settings, search settings
+ * and attached objects (nogood store, memory budget, profile, arena, option
+ * cache, cancel flag, progress hook) stay as they are. Lets a caller solve
+ * many specs with one solver and one arena.
+ *
+ * @param solver Solver to reset
+ * @param width  Initial grid width
+ * @param height Initial grid height
+ */
+void reset_solver(LayoutSolver *solver, int width, int height) {
+  int verbose = solver->verbose;
+  int tree_debug_enabled = solver->tree_debug_enabled;
+  int join_constraints = solver->join_constraints;
+  int forward_checking = solver->forward_checking;
+  int root_probe_nodes = solver->root_probe_nodes;
+  SearchConfig search_config = solver->search_config;
+  const atomic_int *cancel_flag = solver->cancel_flag;
+  int search_threads = solver->search_threads;
+  struct NogoodStore *nogood_store = solver->nogood_store;
+  void (*progress_hook)(struct LayoutSolver *, void *) = solver->progress_hook;
+  void *progress_context = solver->progress_context;
+  MemoryBudget *memory_budget = solver->memory_budget;
+  SearchProfile *search_profile = solver->search_profile;
+  SolverArena *arena = solver->arena;
+  OptionCache *option_cache = solver->option_cache;
+
+  init_solver(solver, width, height);
+
+  solver->verbose = verbose;
+  solver->tree_debug_enabled = tree_debug_enabled;
+  solver->join_constraints = join_constraints;
+  solver->forward_checking = forward_checking;
+  solver->root_probe_nodes = root_probe_nodes;
+  solver->search_config = search_config;
+  solver->rng_state = search_config.seed;
+  solver->cancel_flag = cancel_flag;
+  solver->search_threads = search_threads;
+  solver->nogood_store = nogood_store;
+  solver->progress_hook = progress_hook;
+  solver->progress_context = progress_context;
+  solver->memory_budget = memory_budget;
+  solver->search_profile = search_profile;
+  solver->arena = arena;
+  solver->option_cache = option_cache;
+}
+
 
 /**
  * @brief Checks if two rectangles have horizontal overlap
@@ -616,6 +836,100 @@ int has_vertical_overlap(int y1, int h1, int y2, int h2) {
   return !(y1 + h1 <= y2 || y2 + h2 <= y1);
 }
 
+// =============================================================================
+// WIDTH-SPECIALIZED OVERLAP KERNELS
+// =============================================================================
+// Each tile row is a bitmask (bit c = non-space at column c). For a pair whose
+// wider tile fits in BITS columns, the whole row comparison is one shift and
+// one AND in a BITS-wide integer: comp1's row is shifted into comp2's column
+// frame, and any bits pushed past BITS can only land where comp2 has no
+// columns. One kernel per width class is generated from the same template.
+
+#define DEFINE_OVERLAP_KERNEL(BITS, TYPE)                                      \
+  static int overlap_kernel_##BITS(struct LayoutSolver *solver, int index1,    \
+                                   int x1, int y1, int index2, int x2,         \
+                                   int y2) {                                   \
+    int dx = x1 - x2;                                                          \
+    if (dx >= BITS || dx <= -BITS)                                             \
+      return 0;                                                                \
+    const uint64_t *rows1 = solver->tile_row_masks[index1];                    \
+    const uint64_t *rows2 = solver->tile_row_masks[index2];                    \
+    int h1 = solver->placements[index1].height;                                \
+    int h2 = solver->placements[index2].height;                                \
+    int top = (y1 > y2) ? y1 : y2;                                             \
+    int bottom = (y1 + h1 < y2 + h2) ? y1 + h1 : y2 + h2;                      \
+    for (int y = top; y < bottom; y++) {                                       \
+      TYPE row1 = (TYPE)rows1[y - y1];                                         \
+      TYPE row2 = (TYPE)rows2[y - y2];                                         \
+      TYPE shifted = (dx >= 0) ? (TYPE)(row1 << dx) : (TYPE)(row1 >> -dx);    \
+      if (shifted & row2)                                                      \
+        return 1;                                                              \
+    }                                                                          \
+    return 0;                                                                  \
+  }
+
+DEFINE_OVERLAP_KERNEL(8, uint8_t)
+DEFINE_OVERLAP_KERNEL(16, uint16_t)
+DEFINE_OVERLAP_KERNEL(32, uint32_t)
+DEFINE_OVERLAP_KERNEL(64, uint64_t)
+
+// Oversized tiles: generic per-character comparison
+static int overlap_kernel_generic(struct LayoutSolver *solver, int index1,
+                                  int x1, int y1, int index2, int x2, int y2) {
+  return has_character_overlap(solver, &solver->components[index1], x1, y1,
+                               &solver->components[index2], x2, y2);
+}
+
+/**
+ * @brief Picks the overlap kernel for a pair of tile widths
+ *
+ * @param width1 Width of the first tile
+ * @param width2 Width of the second tile
+ * @return       Narrowest kernel whose row type holds both tiles
+ */
+OverlapKernel select_overlap_kernel(int width1, int width2) {
+  int width = (width1 > width2) ? width1 : width2;
+  if (width <= 8)
+    return overlap_kernel_8;
+  if (width <= 16)
+    return overlap_kernel_16;
+  if (width <= 32)
+    return overlap_kernel_32;
+  if (width <= MAX_KERNEL_TILE_WIDTH)
+    return overlap_kernel_64;
+  return overlap_kernel_generic;
+}
+
+/**
+ * @brief Checks if a component at (x, y) collides with another placed component
+ *
+ * The rectangle test reads only the packed PlacementRecords; tile data is
+ * touched only when the rectangles intersect. Rectangles that do not
+ * intersect can never share a character; intersecting pairs fall through to
+ * their width-class overlap kernel so irregular tiles may interlock.
+ *
+ * @param solver      The layout solver instance
+ * @param comp        Component being tested
+ * @param x           Proposed x coordinate for comp
+ * @param y           Proposed y coordinate for comp
+ * @param other_index Index of the placed component to test against
+ * @return            1 if the tiles collide, 0 otherwise
+ */
+int placement_overlaps(LayoutSolver *solver, Component *comp, int x, int y,
+                       int other_index) {
+  const PlacementRecord *rec = &solver->placements[comp - solver->components];
+  const PlacementRecord *other = &solver->placements[other_index];
+
+  if (!has_horizontal_overlap(x, rec->width, other->x, other->width) ||
+      !has_vertical_overlap(y, rec->height, other->y, other->height)) {
+    return 0;
+  }
+
+  int comp_index = comp - solver->components;
+  return solver->overlap_kernels[comp_index][other_index](
+      solver, comp_index, x, y, other_index, other->x, other->y);
+}
+
 /**
  * @brief Checks if placing a component would cause character overlap
  *
@@ -757,6 +1071,11 @@ void expand_grid_for_component(LayoutSolver *solver, Component *comp, int x,
  * @param dy       Vertical offset for movement
  */
 void move_component_group(LayoutSolver *solver, int group_id, int dx, int dy) {
+  // Cached option lists assume nothing moved since they were generated
+  if (solver->option_cache) {
+    option_cache_clear(solver->option_cache);
+  }
+
   // First, remove all components in the group from grid
   for (int i = 0; i < solver->component_count; i++) {
     Component *comp = &solver->components[i];
@@ -783,6 +1102,7 @@ void move_component_group(LayoutSolver *solver, int group_id, int dx, int dy) {
     if (comp->is_placed && comp->group_id == group_id) {
       comp->placed_x += dx;
       comp->placed_y += dy;
+      sync_placement_record(solver, comp);
 
       // Expand grid if necessary
       expand_grid_for_component(solver, comp, comp->placed_x, comp->placed_y);
@@ -890,9 +1210,14 @@ Component *find_most_constrained_unplaced(LayoutSolver *solver) {
  * @return            1 if placement successful, 0 if failed
  */
 int solve_constraints(LayoutSolver *solver) {
+  // Specs with ABOVE/STAIRS are split into one 2D solve per floor
+  if (solver->vertical_count > 0) {
+    return solve_floors(solver);
+  }
+
   // Directly use tree-based constraint solver
-  printf("🌲 Using tree-based constraint resolution with conflict-depth "
-         "backtracking\n");
+  SOLVER_LOG(solver, "🌲 Using tree-based constraint resolution with conflict-depth "
+             "backtracking\n");
   return solve_tree_constraint(solver);
 }
 
@@ -969,6 +1294,9 @@ void normalize_grid_coordinates(LayoutSolver *solver) {
   if (solver->grid_min_x >= 0 && solver->grid_min_y >= 0) {
     return; // Already normalized
   }
+  if (solver->option_cache) {
+    option_cache_clear(solver->option_cache);
+  }
 
   int dx = -solver->grid_min_x;
   int dy = -solver->grid_min_y;
@@ -978,6 +1306,7 @@ void normalize_grid_coordinates(LayoutSolver *solver) {
     if (solver->components[i].is_placed) {
       solver->components[i].placed_x += dx;
       solver->components[i].placed_y += dy;
+      sync_placement_record(solver, &solver->components[i]);
     }
   }
 
@@ -1013,6 +1342,39 @@ void normalize_grid_coordinates(LayoutSolver *solver) {
   solver->grid_min_y = 0;
 }
 
+/**
+ * @brief Prints the rows of one floor within the given layout bounds
+ *
+ * Every floor is drawn over the bounds of the whole layout, so stairwells and
+ * stacked rooms appear at the same offset on consecutive floors.
+ */
+static void display_floor_rows(LayoutSolver *solver, int floor, int min_x,
+                               int max_x, int min_y, int max_y) {
+  for (int y = min_y; y <= max_y && (y - min_y) < MAX_OUTPUT_LINES; y++) {
+    for (int x = min_x; x <= max_x && (x - min_x) < MAX_OUTPUT_WIDTH; x++) {
+      char ch = ' ';
+
+      // Check each component for this position; tile data is only read
+      // once the packed record says the cell is inside the component
+      for (int i = 0; i < solver->component_count; i++) {
+        const PlacementRecord *rec = &solver->placements[i];
+        if (rec->is_placed && solver->components[i].floor == floor &&
+            x >= rec->x && x < rec->x + rec->width &&
+            y >= rec->y && y < rec->y + rec->height) {
+          char tile_char = solver->components[i].ascii_tile[y - rec->y][x - rec->x];
+          if (tile_char != ' ') {
+            ch = tile_char;
+            break;
+          }
+        }
+      }
+
+      printf("%c", ch);
+    }
+    printf("\n");
+  }
+}
+
 void display_grid(LayoutSolver *solver) {
   printf("\n🏗️  Generated Structure Layout:\n");
   printf("=================================\n");
@@ -1022,50 +1384,33 @@ void display_grid(LayoutSolver *solver) {
   int first = 1;
 
   for (int i = 0; i < solver->component_count; i++) {
-    Component *comp = &solver->components[i];
-    if (comp->is_placed) {
+    const PlacementRecord *rec = &solver->placements[i];
+    if (rec->is_placed) {
       if (first) {
-        min_x = comp->placed_x;
-        max_x = comp->placed_x + comp->width - 1;
-        min_y = comp->placed_y;
-        max_y = comp->placed_y + comp->height - 1;
+        min_x = rec->x;
+        max_x = rec->x + rec->width - 1;
+        min_y = rec->y;
+        max_y = rec->y + rec->height - 1;
         first = 0;
       } else {
-        if (comp->placed_x < min_x)
-          min_x = comp->placed_x;
-        if (comp->placed_x + comp->width - 1 > max_x)
-          max_x = comp->placed_x + comp->width - 1;
-        if (comp->placed_y < min_y)
-          min_y = comp->placed_y;
-        if (comp->placed_y + comp->height - 1 > max_y)
-          max_y = comp->placed_y + comp->height - 1;
+        if (rec->x < min_x)
+          min_x = rec->x;
+        if (rec->x + rec->width - 1 > max_x)
+          max_x = rec->x + rec->width - 1;
+        if (rec->y < min_y)
+          min_y = rec->y;
+        if (rec->y + rec->height - 1 > max_y)
+          max_y = rec->y + rec->height - 1;
       }
     }
   }
 
-  // Display grid within bounds
-  for (int y = min_y; y <= max_y && (y - min_y) < MAX_OUTPUT_LINES; y++) {
-    for (int x = min_x; x <= max_x && (x - min_x) < MAX_OUTPUT_WIDTH; x++) {
-      char ch = ' ';
-
-      // Check each component for this position
-      for (int i = 0; i < solver->component_count; i++) {
-        Component *comp = &solver->components[i];
-        if (comp->is_placed && x >= comp->placed_x &&
-            x < comp->placed_x + comp->width && y >= comp->placed_y &&
-            y < comp->placed_y + comp->height) {
-          int local_x = x - comp->placed_x;
-          int local_y = y - comp->placed_y;
-          if (comp->ascii_tile[local_y][local_x] != ' ') {
-            ch = comp->ascii_tile[local_y][local_x];
-            break;
-          }
-        }
-      }
-
-      printf("%c", ch);
+  // Display grid within bounds, one plan per floor from the ground up
+  for (int floor = 0; floor < solver->floor_count; floor++) {
+    if (solver->floor_count > 1) {
+      printf("--- Floor %d ---\n", floor);
     }
-    printf("\n");
+    display_floor_rows(solver, floor, min_x, max_x, min_y, max_y);
   }
   printf("=================================\n");
 }
@@ -1220,35 +1565,25 @@ int detect_placement_conflicts(LayoutSolver *solver, Component *target_comp,
   solver->conflict_state.conflict_resolved = 0;
 
   // Check each placed component for overlap
+  int target_index = target_comp - solver->components;
   for (int i = 0; i < solver->component_count; i++) {
-    Component *existing_comp = &solver->components[i];
-
-    if (!existing_comp->is_placed || existing_comp == target_comp) {
+    if (!solver->placements[i].is_placed || i == target_index) {
       continue;
     }
 
-    // Check for rectangular overlap
-    int overlap_x = has_horizontal_overlap(
-        x, target_comp->width, existing_comp->placed_x, existing_comp->width);
-    int overlap_y = has_vertical_overlap(
-        y, target_comp->height, existing_comp->placed_y, existing_comp->height);
-
-    if (overlap_x && overlap_y) {
-      // Check for actual character overlap
-      if (has_character_overlap(solver, target_comp, x, y, existing_comp,
-                                existing_comp->placed_x,
-                                existing_comp->placed_y)) {
-        solver->conflict_state
-            .overlapping_components[solver->conflict_state.overlap_count] = i;
-        solver->conflict_state.overlap_count++;
-
-        if (solver->debug_file) {
-          fprintf(solver->debug_file,
-                  "⚠️  CONFLICT DETECTED: %s at (%d,%d) overlaps with %s at "
-                  "(%d,%d)\n",
-                  target_comp->name, x, y, existing_comp->name,
-                  existing_comp->placed_x, existing_comp->placed_y);
-        }
+    // Rectangle test first, character overlap only if the rectangles meet
+    if (placement_overlaps(solver, target_comp, x, y, i)) {
+      Component *existing_comp = &solver->components[i];
+      solver->conflict_state
+          .overlapping_components[solver->conflict_state.overlap_count] = i;
+      solver->conflict_state.overlap_count++;
+
+      if (solver->debug_file) {
+        fprintf(solver->debug_file,
+                "⚠️  CONFLICT DETECTED: %s at (%d,%d) overlaps with %s at "
+                "(%d,%d)\n",
+                target_comp->name, x, y, existing_comp->name,
+                existing_comp->placed_x, existing_comp->placed_y);
       }
     }
   }
@@ -1268,39 +1603,136 @@ int detect_placement_conflicts(LayoutSolver *solver, Component *target_comp,
 /**
  * @brief Main entry point for tree-based constraint resolution
  *
+ * @param solver The layout solver instance
+ * @return       1 if all constraints were satisfied, 0 otherwise
+ */
+int solve_tree_constraint(LayoutSolver *solver) {
+  solver->search_cancelled = 0;
+  solver->memory_exhausted = 0;
+  int result = run_tree_search(solver);
+  nogood_store_flush_stats(solver->nogood_store, &solver->nogood_stats);
+  return result;
+}
+
+/**
+ * @brief Do the remaining constraints between two placed components hold?
+ *
+ * The selectors only resolve constraints with exactly one placed component,
+ * so a constraint whose ends are both placed is never resolved. Those with a
+ * pinned end must still hold, and so must cycle-closing ones under the join;
+ * without the join a cycle-closing constraint is not enforced.
+ *
+ * @return 1 if they hold, 0 (after logging the first violation) otherwise
+ */
+static int closed_constraints_hold(LayoutSolver *solver) {
+  TreeSolver *ts = &solver->tree_solver;
+  for (int i = 0; i < ts->remaining_count; i++) {
+    DSLConstraint *constraint = ts->remaining_constraints[i];
+    Component *a = find_component(solver, constraint->component_a);
+    Component *b = find_component(solver, constraint->component_b);
+    if (!a || !b || a == b || !a->is_placed || !b->is_placed ||
+        !(solver->join_constraints || a->is_pinned || b->is_pinned)) {
+      continue;
+    }
+    if (!validate_constraint(solver, constraint)) {
+      SOLVER_LOG(solver, "❌ Constraint already violated by existing placements: %s %s %c\n",
+                 constraint->component_a, constraint->component_b, constraint->direction);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief Places every pinned component besides the root at its fixed position
+ *
+ * Pinned components are part of the starting layout, like the root: no tree
+ * node places them, so backtracking never moves them. Constraints between
+ * two of them are checked here, and constraints to one of them are joined
+ * into the options of their other component (collect_joined_constraints()).
+ *
+ * @param solver The layout solver instance, with the root already placed
+ * @return       1 if the pinned components fit together, 0 if two overlap
+ */
+static int place_pinned_components(LayoutSolver *solver) {
+  for (int i = 0; i < solver->component_count; i++) {
+    Component *comp = &solver->components[i];
+    if (!comp->is_pinned || comp->is_placed)
+      continue;
+
+    for (int j = 0; j < solver->component_count; j++) {
+      if (solver->components[j].is_placed &&
+          placement_overlaps(solver, comp, comp->pinned_x, comp->pinned_y, j)) {
+        SOLVER_LOG(solver, "❌ Pinned %s overlaps %s\n", comp->name,
+                   solver->components[j].name);
+        return 0;
+      }
+    }
+    place_component(solver, comp, comp->pinned_x, comp->pinned_y);
+    SOLVER_LOG(solver, "📌 Pinned component: %s at (%d,%d)\n", comp->name,
+               comp->pinned_x, comp->pinned_y);
+  }
+  return closed_constraints_hold(solver);
+}
+
+/**
+ * @brief Runs one tree search pass
+ *
  * Implements the tree-based approach where we:
  * 1. Place the most constrained component at root
  * 2. Generate all placement options for each constraint in order
  * 3. Order options by conflict status then preference score
  * 4. Use conflict-depth-based intelligent backtracking
  */
-int solve_tree_constraint(LayoutSolver *solver) {
-  printf("🌲 Starting tree-based constraint resolution\n");
+int run_tree_search(LayoutSolver *solver) {
+  SOLVER_LOG(solver, "🌲 Starting tree-based constraint resolution\n");
 
   // Initialize debug logging
   init_tree_debug_file(solver);
 
   // Initialize the tree solver
   init_tree_solver(solver);
+  solver->rng_state = solver->search_config.seed;
+  TRACE_SOLVE_START(solver->component_count, solver->constraint_count);
 
-  // Step 1: Place the most constrained component (root)
-  Component *root_comp = find_most_constrained_unplaced(solver);
+  // Step 1: Place the root component (most constrained by default)
+  Component *root_comp = select_root_component(solver);
   if (!root_comp) {
-    printf("❌ No components to place\n");
+    SOLVER_LOG(solver, "❌ No components to place\n");
+    TRACE_SOLVE_END(0, 0, 0);
     cleanup_tree_solver(solver);
     return 0;
   }
 
-  printf("📍 Root component: %s\n", root_comp->name);
+  SOLVER_LOG(solver, "📍 Root component: %s\n", root_comp->name);
 
   // Place root component at origin (expand grid as needed)
-  int root_x = 50, root_y = 50; // Center of grid
+  int root_x = solver->root_x, root_y = solver->root_y;
+  if (root_comp->is_pinned) {
+    root_x = root_comp->pinned_x;
+    root_y = root_comp->pinned_y;
+  }
   place_component(solver, root_comp, root_x, root_y);
+  if (!place_pinned_components(solver)) {
+    TRACE_SOLVE_END(0, 0, 0);
+    cleanup_tree_solver(solver);
+    close_tree_debug_file(solver);
+    return 0;
+  }
 
   // Create root node
   int root_comp_index = root_comp - solver->components;
-  solver->tree_solver.root =
-      create_tree_node(root_comp, NULL, root_x, root_y, 0, root_comp_index);
+  solver->tree_solver.root = create_tree_node(solver, root_comp, NULL,
+                                              root_x, root_y, 0, root_comp_index);
+  if (!solver->tree_solver.root) {
+    SOLVER_LOG(solver, "❌ Memory budget exhausted before the search started\n");
+    solver->memory_exhausted = 1;
+    solver->search_cancelled = 1;
+    TRACE_SOLVE_END(0, 0, 0);
+    cleanup_tree_solver(solver);
+    close_tree_debug_file(solver);
+    return 0;
+  }
   solver->tree_solver.root->placement_succeeded = 1;  // Root always succeeds
   solver->tree_solver.current_node = solver->tree_solver.root;
 
@@ -1308,7 +1740,8 @@ int solve_tree_constraint(LayoutSolver *solver) {
   debug_log_enhanced_grid_state(solver, "ROOT PLACEMENT");
 
   // Step 2: Process constraints in order
-  int result = advance_to_next_constraint(solver);
+  int result = solver->search_threads > 0 ? run_deterministic_parallel_search(solver)
+                                          : advance_to_next_constraint(solver);
 
   // Log final results
   if (result) {
@@ -1316,17 +1749,153 @@ int solve_tree_constraint(LayoutSolver *solver) {
     debug_log_enhanced_grid_state(solver, "FINAL SOLUTION");
   }
 
+  TRACE_SOLVE_END(result, solver->tree_solver.nodes_created,
+                  solver->tree_solver.backtracks);
   cleanup_tree_solver(solver);
   close_tree_debug_file(solver);
   return result;
 }
 
+/**
+ * @brief Unplaces every component and clears the grid
+ *
+ * Resets placement state between search passes without touching the parsed
+ * components and constraints.
+ *
+ * @param solver The layout solver instance
+ */
+void clear_all_placements(LayoutSolver *solver) {
+  if (solver->option_cache) {
+    option_cache_clear(solver->option_cache);
+  }
+  for (int i = 0; i < solver->component_count; i++) {
+    Component *comp = &solver->components[i];
+    comp->is_placed = 0;
+    comp->placed_x = -1;
+    comp->placed_y = -1;
+    sync_placement_record(solver, comp);
+  }
+
+  for (int i = 0; i < MAX_GRID_SIZE; i++) {
+    for (int j = 0; j < MAX_GRID_SIZE; j++) {
+      solver->grid[i][j] = ' ';
+    }
+  }
+}
+
+/**
+ * @brief Takes over the search result of another copy of the same spec
+ *
+ * Used by the portfolio and parallel searches, whose workers solve private
+ * copies of the parsed solver. Output settings, debug files and search
+ * settings stay with the receiving solver; the tree solver's constraint
+ * pointers are rebased onto its own constraint array. Tree node pointers
+ * are copied unchanged.
+ *
+ * @param solver The solver receiving the layout
+ * @param source The copy holding the result
+ */
+void adopt_solver_layout(LayoutSolver *solver, const LayoutSolver *source) {
+  int verbose = solver->verbose;
+  int tree_debug_enabled = solver->tree_debug_enabled;
+  FILE *debug_file = solver->debug_file;
+  FILE *tree_debug_file = solver->tree_debug_file;
+  SearchConfig search_config = solver->search_config;
+  const atomic_int *cancel_flag = solver->cancel_flag;
+  int search_threads = solver->search_threads;
+  struct SolverArena *arena = solver->arena;
+  struct OptionCache *option_cache = solver->option_cache;
+
+  memcpy(solver, source, sizeof(LayoutSolver));
+
+  solver->verbose = verbose;
+  solver->tree_debug_enabled = tree_debug_enabled;
+  solver->debug_file = debug_file;
+  solver->tree_debug_file = tree_debug_file;
+  solver->search_config = search_config;
+  solver->cancel_flag = cancel_flag;
+  solver->search_threads = search_threads;
+  solver->arena = arena;
+  solver->option_cache = option_cache;
+  // Every placement just changed without passing through place/remove
+  if (option_cache) {
+    option_cache_clear(option_cache);
+  }
+
+  TreeSolver *ts = &solver->tree_solver;
+  for (int i = 0; i < ts->remaining_count; i++) {
+    ts->remaining_constraints[i] =
+        solver->constraints + (ts->remaining_constraints[i] - source->constraints);
+  }
+  if (ts->current_constraint) {
+    ts->current_constraint =
+        solver->constraints + (ts->current_constraint - source->constraints);
+  }
+}
+
+/**
+ * @brief Repoints tree nodes created by a solver copy at another copy
+ *
+ * Nodes keep component and constraint pointers into the solver that created
+ * them; before a worker copy is freed its nodes are moved to the solver that
+ * keeps the tree.
+ *
+ * @param node Subtree root
+ * @param from Solver copy that created some of the nodes
+ * @param to   Solver that owns the tree from now on
+ */
+void rebase_tree_pointers(TreeNode *node, const LayoutSolver *from,
+                          LayoutSolver *to) {
+  if (!node)
+    return;
+
+  if (node->component >= from->components &&
+      node->component < from->components + MAX_COMPONENTS) {
+    node->component = to->components + (node->component - from->components);
+  }
+  if (node->constraint >= from->constraints &&
+      node->constraint < from->constraints + MAX_CONSTRAINTS) {
+    node->constraint = to->constraints + (node->constraint - from->constraints);
+  }
+
+  for (int i = 0; i < node->child_count; i++) {
+    rebase_tree_pointers(node->children[i], from, to);
+  }
+}
+
+/**
+ * @brief Resolves the components of every ADJACENT constraint once per search
+ *
+ * Forward checking looks at the constraints around each new placement; with
+ * the index it follows component indexes instead of matching names.
+ */
+static void build_constraint_index(LayoutSolver *solver) {
+  TreeSolver *ts = &solver->tree_solver;
+  for (int i = 0; i < solver->constraint_count; i++) {
+    DSLConstraint *constraint = &solver->constraints[i];
+    Component *a = find_component(solver, constraint->component_a);
+    Component *b = find_component(solver, constraint->component_b);
+    if (constraint->type != DSL_ADJACENT || !a || !b || a == b) {
+      ts->constraint_ends[i][0] = ts->constraint_ends[i][1] = -1;
+      continue;
+    }
+    int a_index = a - solver->components, b_index = b - solver->components;
+    ts->constraint_ends[i][0] = a_index;
+    ts->constraint_ends[i][1] = b_index;
+    ts->incident[a_index][ts->incident_count[a_index]++] = i;
+    ts->incident[b_index][ts->incident_count[b_index]++] = i;
+  }
+}
+
 /**
  * @brief Initialize the tree solver state
  */
 void init_tree_solver(LayoutSolver *solver) {
   TreeSolver *ts = &solver->tree_solver;
   memset(ts, 0, sizeof(TreeSolver));
+  if (solver->option_cache) {
+    option_cache_clear(solver->option_cache);
+  }
 
   // Copy all constraints to remaining list
   for (int i = 0; i < solver->constraint_count; i++) {
@@ -1334,8 +1903,13 @@ void init_tree_solver(LayoutSolver *solver) {
   }
   ts->remaining_count = solver->constraint_count;
   ts->current_constraint = NULL;
+  if (solver->forward_checking) {
+    build_constraint_index(solver);
+  }
 }
 
+static void print_depth_stats(const LayoutSolver *solver);
+
 /**
  * @brief Clean up tree solver resources
  */
@@ -1343,22 +1917,105 @@ void cleanup_tree_solver(LayoutSolver *solver) {
   TreeSolver *ts = &solver->tree_solver;
 
   if (ts->root) {
-    free_tree_node(ts->root);
+    free_tree_node(solver, ts->root);
     ts->root = NULL;
   }
 
-  printf("📊 Tree solver stats: %d nodes, %d backtracks\n",
-         ts->nodes_created, ts->backtracks);
+  SOLVER_LOG(solver, "📊 Tree solver stats: %d nodes, %d backtracks\n",
+             ts->nodes_created, ts->backtracks);
+  if (solver->verbose) {
+    print_depth_stats(solver);
+  }
+}
+
+/**
+ * @brief Prints the per-depth counters of the last search as a table
+ */
+static void print_depth_stats(const LayoutSolver *solver) {
+  const TreeSolver *ts = &solver->tree_solver;
+  printf("📊 Per-depth search stats:\n");
+  printf("  depth  expanded   options  conflicting    joined  explored    failed        ms\n");
+  for (int d = 0; d < MAX_DEPTH_STATS; d++) {
+    const DepthStats *stats = &ts->depth_stats[d];
+    if (stats->expansions == 0 && stats->children_explored == 0)
+      continue;
+    printf("  %5d  %8ld  %8ld  %11ld  %8ld  %8ld  %8ld  %8.3f\n", d, stats->expansions,
+           stats->options_generated, stats->options_conflicting, stats->options_joined,
+           stats->children_explored, stats->failures, stats->nanoseconds / 1e6);
+  }
+}
+
+/**
+ * @brief Adds one copy's per-depth counters to a total
+ *
+ * Used to merge the stats of parallel workers and floor solvers.
+ *
+ * @param total Counters to add to
+ * @param add   Counters of the copy
+ * @param base  Counters the copy started from (subtracted), may be NULL
+ */
+void add_depth_stats(DepthStats *total, const DepthStats *add, const DepthStats *base) {
+  for (int d = 0; d < MAX_DEPTH_STATS; d++) {
+    total[d].expansions += add[d].expansions - (base ? base[d].expansions : 0);
+    total[d].options_generated +=
+        add[d].options_generated - (base ? base[d].options_generated : 0);
+    total[d].options_conflicting +=
+        add[d].options_conflicting - (base ? base[d].options_conflicting : 0);
+    total[d].options_joined += add[d].options_joined - (base ? base[d].options_joined : 0);
+    total[d].children_explored +=
+        add[d].children_explored - (base ? base[d].children_explored : 0);
+    total[d].failures += add[d].failures - (base ? base[d].failures : 0);
+    total[d].nanoseconds += add[d].nanoseconds - (base ? base[d].nanoseconds : 0);
+  }
+}
+
+/**
+ * @brief Appends the per-depth counters of the last search as CSV rows
+ *
+ * Columns: label, depth, expanded, options, conflicting, joined, explored,
+ * failed, ms. Depths the search never reached are skipped.
+ *
+ * @param solver Solver after a search
+ * @param out    Output stream
+ * @param label  First column, e.g. the spec file name
+ */
+void write_depth_stats_csv(const LayoutSolver *solver, FILE *out, const char *label) {
+  const TreeSolver *ts = &solver->tree_solver;
+  for (int d = 0; d < MAX_DEPTH_STATS; d++) {
+    const DepthStats *stats = &ts->depth_stats[d];
+    if (stats->expansions == 0 && stats->children_explored == 0)
+      continue;
+    fprintf(out, "%s,%d,%ld,%ld,%ld,%ld,%ld,%ld,%.3f\n", label, d, stats->expansions,
+            stats->options_generated, stats->options_conflicting, stats->options_joined,
+            stats->children_explored, stats->failures, stats->nanoseconds / 1e6);
+  }
 }
 
 /**
  * @brief Create a new tree node
+ *
+ * Nodes are taken from the solver's arena when it has one and malloc()'d
+ * otherwise; either way they are charged to its memory budget if it has one.
+ *
+ * @return The node, or NULL if the budget or the system is out of memory
  */
-TreeNode *create_tree_node(Component *comp, DSLConstraint *constraint, int x,
-                           int y, int depth, int comp_index) {
-  TreeNode *node = malloc(sizeof(TreeNode));
-  if (!node)
-    return NULL;
+TreeNode *create_tree_node(LayoutSolver *solver, Component *comp,
+                           DSLConstraint *constraint, int x, int y, int depth,
+                           int comp_index) {
+  TreeNode *node;
+  if (solver->arena) {
+    if (!memory_budget_reserve(solver->memory_budget, sizeof(TreeNode)))
+      return NULL;
+    node = solver_arena_alloc_node(solver->arena);
+    if (!node) {
+      memory_budget_release(solver->memory_budget, sizeof(TreeNode));
+      return NULL;
+    }
+  } else {
+    node = memory_budget_alloc_node(solver->memory_budget);
+    if (!node)
+      return NULL;
+  }
 
   memset(node, 0, sizeof(TreeNode));
   node->component = comp;
@@ -1374,33 +2031,222 @@ TreeNode *create_tree_node(Component *comp, DSLConstraint *constraint, int x,
 /**
  * @brief Free a tree node and all its children
  */
-void free_tree_node(TreeNode *node) {
+void free_tree_node(LayoutSolver *solver, TreeNode *node) {
   if (!node)
     return;
 
   for (int i = 0; i < node->child_count; i++) {
-    free_tree_node(node->children[i]);
+    free_tree_node(solver, node->children[i]);
+  }
+  // Nodes made by search copies end up here too; any TreeNode block fits the pool
+  if (solver->arena) {
+    solver_arena_free_node(solver->arena, node);
+    memory_budget_release(solver->memory_budget, sizeof(TreeNode));
+  } else {
+    memory_budget_free_node(solver->memory_budget, node);
+  }
+}
+
+/**
+ * @brief Creates the child of parent that places comp at option
+ *
+ * @return The child, or NULL with solver->memory_exhausted set
+ */
+static TreeNode *create_child_node(LayoutSolver *solver, TreeNode *parent,
+                                   const TreePlacementOption *option,
+                                   DSLConstraint *constraint, Component *comp) {
+  TreeNode *child = create_tree_node(solver, comp, constraint, option->x,
+                                     option->y, parent->depth + 1,
+                                     comp - solver->components);
+  if (!child) {
+    SOLVER_LOG(solver, "❌ Memory budget exhausted, stopping the search\n");
+    solver->memory_exhausted = 1;
+    solver->search_cancelled = 1;
+    return NULL;
+  }
+
+  child->parent = parent;
+  solver->tree_solver.nodes_created++;
+  return child;
+}
+
+/**
+ * @brief Drops a failed child when memory is tight
+ *
+ * Failed subtrees are kept for the debug tree until the search ends; under
+ * memory pressure (or below a lazily expanded node) they are freed at once
+ * and the slot is left NULL.
+ */
+static void release_failed_child(LayoutSolver *solver, TreeNode *parent, int child_index) {
+  if (parent->lazy_children ||
+      memory_budget_pressure(solver->memory_budget) >= MEMORY_PRESSURE_PRUNE_TREE) {
+    free_tree_node(solver, parent->children[child_index]);
+    parent->children[child_index] = NULL;
   }
-  free(node);
 }
 
 /**
  * @brief Advance to the next constraint and generate placement options
  */
 int advance_to_next_constraint(LayoutSolver *solver) {
+  if (search_cancel_requested(solver)) {
+    return 0;
+  }
+
+  DSLConstraint *next_constraint = NULL;
+  Component *unplaced_comp = NULL;
+  int child_count = expand_tree_node(solver, &next_constraint, &unplaced_comp);
+  if (child_count < 0) {
+    // Success - all constraints satisfied, unless the caller rejects the layout
+    return !solver->accept_hook || solver->accept_hook(solver, solver->accept_context);
+  }
+  if (child_count == 0) {
+    return 0; // No options available
+  }
+
+  // Now try each child in order (best to worst)
+  for (int i = 0; i < child_count; i++) {
+    if (explore_tree_child(solver, i, next_constraint, unplaced_comp)) {
+      return 1; // Success!
+    }
+  }
+
+  // All options failed
+  SOLVER_LOG(solver, "❌ All %d placement options exhausted for %s\n", child_count, unplaced_comp->name);
+  return 0;
+}
+
+static int expand_next_constraint(LayoutSolver *solver, DSLConstraint **constraint_out,
+                                  Component **comp_out);
+
+static DepthStats *depth_stats_at(LayoutSolver *solver, int depth) {
+  return depth >= 0 && depth < MAX_DEPTH_STATS ? &solver->tree_solver.depth_stats[depth]
+                                               : NULL;
+}
+
+/**
+ * @brief Expands the current node for the next constraint
+ *
+ * Selects the next constraint, generates and orders its placement options
+ * and pre-generates one child of ts->current_node per valid option. With a
+ * search profile attached the expansion is timed and charged to the path
+ * from the root to the component being placed.
+ *
+ * @param solver         The layout solver instance
+ * @param constraint_out Receives the constraint being resolved
+ * @param comp_out       Receives the component the children place
+ * @return               Number of children created, 0 if the constraint has
+ *                       no valid option, -1 if all constraints are resolved
+ */
+int expand_tree_node(LayoutSolver *solver, DSLConstraint **constraint_out,
+                     Component **comp_out) {
+  TreeNode *node = solver->tree_solver.current_node;
+  struct timespec start, end;
+  *comp_out = NULL;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int child_count = expand_next_constraint(solver, constraint_out, comp_out);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  if (*comp_out) {
+    long nanoseconds = (end.tv_sec - start.tv_sec) * 1000000000L +
+                       (end.tv_nsec - start.tv_nsec);
+    DepthStats *stats = depth_stats_at(solver, node->depth);
+    if (stats) {
+      stats->expansions++;
+      stats->nanoseconds += nanoseconds;
+    }
+    if (solver->search_profile) {
+      search_profile_record(solver->search_profile, solver, node, *comp_out, nanoseconds);
+    }
+  }
+  return child_count;
+}
+
+/**
+ * @brief Collects the other remaining constraints between comp and a placed component
+ *
+ * The search only resolves constraints with exactly one placed component,
+ * so once comp is placed these are never looked at again. Joining them with
+ * the constraint being resolved makes them hold, and rules out the options
+ * that break them before any subtree is built on one. Constraints to a
+ * pinned partner are always collected: no constraint placed that partner,
+ * so nothing else would make them hold.
+ *
+ * @return Number of constraints written to joined / partners
+ */
+static int collect_joined_constraints(LayoutSolver *solver, const DSLConstraint *resolved,
+                                      const Component *comp, DSLConstraint **joined,
+                                      Component **partners) {
+  TreeSolver *ts = &solver->tree_solver;
+  int count = 0;
+  for (int i = 0; i < ts->remaining_count; i++) {
+    DSLConstraint *constraint = ts->remaining_constraints[i];
+    if (constraint == resolved || constraint->type != DSL_ADJACENT) {
+      continue;
+    }
+    Component *a = find_component(solver, constraint->component_a);
+    Component *b = find_component(solver, constraint->component_b);
+    Component *partner = a == comp ? b : b == comp ? a : NULL;
+    if (partner && partner != comp && partner->is_placed &&
+        (solver->join_constraints || partner->is_pinned)) {
+      joined[count] = constraint;
+      partners[count] = partner;
+      count++;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Does comp at (x, y) overlap its footprint, if it has one?
+ */
+static int option_overlaps_footprint(const Component *comp, int x, int y) {
+  return !comp->has_footprint ||
+         (has_horizontal_overlap(x, comp->width, comp->footprint_x, comp->footprint_width) &&
+          has_vertical_overlap(y, comp->height, comp->footprint_y, comp->footprint_height));
+}
+
+/**
+ * @brief Checks comp at (x, y) against every joined constraint
+ *
+ * Same reading of a constraint as adjacent_validate_constraint(): the two
+ * components touch along the constraint's axis, either one on its side.
+ */
+static int option_satisfies_joined(const Component *comp, int x, int y,
+                                   DSLConstraint *const *joined,
+                                   Component *const *partners, int joined_count) {
+  for (int i = 0; i < joined_count; i++) {
+    const Component *p = partners[i];
+    if (!check_adjacent_either_side(x, y, comp->width, comp->height, p->placed_x, p->placed_y,
+                                    p->width, p->height, joined[i]->direction)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief expand_tree_node() body; sets comp_out as soon as the component to
+ * place is known, so failed expansions can be charged as well
+ */
+static int expand_next_constraint(LayoutSolver *solver, DSLConstraint **constraint_out,
+                                  Component **comp_out) {
   TreeSolver *ts = &solver->tree_solver;
 
   // Find next constraint involving already placed components
-  DSLConstraint *next_constraint = get_next_constraint_involving_placed(solver);
+  DSLConstraint *next_constraint = select_next_constraint(solver);
   if (!next_constraint) {
-    printf("✅ All constraints resolved successfully\n");
-    return 1; // Success - all constraints satisfied
+    if (!closed_constraints_hold(solver)) {
+      return 0;
+    }
+    SOLVER_LOG(solver, "✅ All constraints resolved successfully\n");
+    return -1; // Success - all constraints satisfied
   }
 
   ts->current_constraint = next_constraint;
-  printf("🎯 Processing constraint: %s %s %s %c\n",
-         next_constraint->component_a, "ADJACENT", next_constraint->component_b,
-         next_constraint->direction);
+  SOLVER_LOG(solver, "🎯 Processing constraint: %s %s %s %c\n",
+             next_constraint->component_a, "ADJACENT", next_constraint->component_b,
+             next_constraint->direction);
 
   // Determine which component needs to be placed
   Component *comp_a = find_component(solver, next_constraint->component_a);
@@ -1428,15 +2274,21 @@ int advance_to_next_constraint(LayoutSolver *solver) {
           break;
         }
       }
-      return advance_to_next_constraint(solver);
+      return expand_next_constraint(solver, constraint_out, comp_out);
     } else {
-      printf("❌ Constraint already violated by existing placements\n");
+      SOLVER_LOG(solver, "❌ Constraint already violated by existing placements\n");
       return 0;
     }
   }
 
+  *constraint_out = next_constraint;
+  *comp_out = unplaced_comp;
+
   // Log constraint start
   debug_log_tree_constraint_start(solver, next_constraint, unplaced_comp);
+  TRACE_NODE_EXPAND(ts->current_node->depth,
+                    (int)(unplaced_comp - solver->components),
+                    ts->remaining_count);
 
   // Generate all placement options for this constraint
   TreePlacementOption options[200];
@@ -1444,116 +2296,354 @@ int advance_to_next_constraint(LayoutSolver *solver) {
       solver, next_constraint, unplaced_comp, options);
 
   if (option_count == 0) {
-    printf("❌ No valid placement options for constraint\n");
+    SOLVER_LOG(solver, "❌ No valid placement options for constraint\n");
+    TRACE_OPTIONS_GENERATED(ts->current_node->depth, 0, 0);
     return 0;
   }
 
-  printf("📋 Generated %d placement options\n", option_count);
+  SOLVER_LOG(solver, "📋 Generated %d placement options\n", option_count);
 
   // Order options by conflict status then preference
   order_placement_options(options, option_count);
+  if (solver->search_config.tie_break == TIE_BREAK_RANDOM) {
+    shuffle_tied_options(solver, options, option_count);
+  }
 
   // Log placement options
   debug_log_tree_placement_options(solver, options, option_count);
 
+  // Join: constraints from unplaced_comp to other placed components (or to
+  // pinned ones) must hold at the same position, so options violating them
+  // are never explored
+  DSLConstraint *joined[MAX_CONSTRAINTS];
+  Component *partners[MAX_CONSTRAINTS];
+  int joined_count =
+      collect_joined_constraints(solver, next_constraint, unplaced_comp, joined, partners);
+
   // Filter out conflicting options - only keep valid placement options
   TreePlacementOption valid_options[200];
   int valid_count = 0;
+  int joined_out = 0;
   for (int i = 0; i < option_count; i++) {
-    if (!options[i].has_conflict) {
-      valid_options[valid_count++] = options[i];
+    if (options[i].has_conflict ||
+        !option_overlaps_footprint(unplaced_comp, options[i].x, options[i].y)) {
+      continue;
+    }
+    if (!option_satisfies_joined(unplaced_comp, options[i].x, options[i].y, joined, partners,
+                                 joined_count)) {
+      joined_out++;
+      continue;
     }
+    valid_options[valid_count++] = options[i];
   }
 
-  printf("📋 Filtered to %d valid (non-conflicting) placement options\n", valid_count);
+  SOLVER_LOG(solver, "📋 Filtered to %d valid (non-conflicting) placement options\n", valid_count);
+  if (joined_count > 0) {
+    SOLVER_LOG(solver, "🔗 Joined %d more constraint(s) on %s: %d option(s) ruled out\n",
+               joined_count, unplaced_comp->name, joined_out);
+  }
+  TRACE_OPTIONS_GENERATED(ts->current_node->depth, option_count, valid_count);
+  DepthStats *stats = depth_stats_at(solver, ts->current_node->depth);
+  if (stats) {
+    stats->options_generated += option_count;
+    stats->options_conflicting += option_count - valid_count - joined_out;
+    stats->options_joined += joined_out;
+  }
 
   if (valid_count == 0) {
-    printf("⚠️  No valid placement options - backtracking required\n");
+    SOLVER_LOG(solver, "⚠️  No valid placement options - backtracking required\n");
     return 0; // No options available
   }
 
-  // PRE-GENERATE all child nodes for valid placement options (ordered best to worst)
-  printf("🌳 Pre-generating %d child nodes for all valid options...\n", valid_count);
-  int comp_index = unplaced_comp - solver->components;
-
-  for (int i = 0; i < valid_count; i++) {
-    TreePlacementOption *option = &valid_options[i];
+  TreeNode *node = ts->current_node;
+  if (memory_budget_pressure(solver->memory_budget) >= MEMORY_PRESSURE_LAZY_EXPANSION) {
+    // Near the budget: keep only the options, explore_tree_child() creates
+    // each child when its turn comes
+    SOLVER_LOG(solver, "💾 Memory pressure: expanding %d children lazily\n", valid_count);
+    memcpy(node->placement_options, valid_options, valid_count * sizeof(TreePlacementOption));
+    node->option_count = valid_count;
+    node->child_count = valid_count;
+    node->lazy_children = 1;
+  } else {
+    // PRE-GENERATE all child nodes for valid placement options (ordered best to worst)
+    SOLVER_LOG(solver, "🌳 Pre-generating %d child nodes for all valid options...\n", valid_count);
+    for (int i = 0; i < valid_count; i++) {
+      TreeNode *child = create_child_node(solver, node, &valid_options[i], next_constraint,
+                                          unplaced_comp);
+      if (!child) {
+        return 0;
+      }
+      node->children[node->child_count++] = child;
+    }
+    SOLVER_LOG(solver, "✅ Created %d child nodes, now trying them in order...\n", valid_count);
+  }
 
-    TreeNode *child = create_tree_node(unplaced_comp, next_constraint, option->x, option->y,
-                                       ts->current_node->depth + 1, comp_index);
-    child->placement_succeeded = 0;  // Not yet tried
-    child->being_explored = 0;
-    child->marked_failed = 0;
+  return valid_count;
+}
 
-    ts->current_node->children[ts->current_node->child_count++] = child;
-    child->parent = ts->current_node;
-    ts->nodes_created++;
+/**
+ * @brief Is there a conflict-free position for comp on the side of placed the
+ * constraint asks for, that also satisfies the joined constraints?
+ *
+ * Walks the same positions adjacent_generate_placements() produces and stops
+ * at the first one that fits.
+ */
+static int has_free_adjacent_position(LayoutSolver *solver, Component *comp,
+                                      const Component *placed, char direction,
+                                      DSLConstraint *const *joined,
+                                      Component *const *partners, int joined_count) {
+  static const char sides[] = "nsew";
+  int comp_index = comp - solver->components;
+  for (int s = 0; s < 4; s++) {
+    if (direction != 'a' && direction != sides[s])
+      continue;
+    int horizontal = sides[s] == 'n' || sides[s] == 's';
+    int first = horizontal ? placed->placed_x - comp->width + 1
+                           : placed->placed_y - comp->height + 1;
+    int last = horizontal ? placed->placed_x + placed->width - 1
+                          : placed->placed_y + placed->height - 1;
+    for (int along = first; along <= last; along++) {
+      int x = along, y = along;
+      switch (sides[s]) {
+      case 'n': y = placed->placed_y - comp->height; break;
+      case 's': y = placed->placed_y + placed->height; break;
+      case 'e': x = placed->placed_x + placed->width; break;
+      default:  x = placed->placed_x - comp->width; break;
+      }
+      if (!option_satisfies_joined(comp, x, y, joined, partners, joined_count))
+        continue;
+      int blocked = 0;
+      for (int i = 0; i < solver->component_count && !blocked; i++) {
+        blocked = i != comp_index && solver->placements[i].is_placed &&
+                  placement_overlaps(solver, comp, x, y, i);
+      }
+      if (!blocked)
+        return 1;
+    }
   }
+  return 0;
+}
 
-  printf("✅ Created %d child nodes, now trying them in order...\n", valid_count);
+/**
+ * @brief Can comp still be placed, given the components placed so far?
+ *
+ * Placements only add obstacles, so a component with no position left now
+ * has none anywhere below. Without the constraint join a constraint whose
+ * other component is placed can be skipped once comp is placed through
+ * another constraint, so comp only counts as stuck when all its constraints
+ * lead to placed components and none of them has a free position. With the
+ * join every such constraint must hold at once: the positions of one of
+ * them must satisfy the others.
+ */
+static int component_still_placeable(LayoutSolver *solver, Component *comp) {
+  const TreeSolver *ts = &solver->tree_solver;
+  int comp_index = comp - solver->components;
+  DSLConstraint *frontier[MAX_CONSTRAINTS];
+  Component *partners[MAX_CONSTRAINTS];
+  int frontier_count = 0;
+  for (int k = 0; k < ts->incident_count[comp_index]; k++) {
+    int c = ts->incident[comp_index][k];
+    const int *ends = ts->constraint_ends[c];
+    Component *partner = &solver->components[ends[0] == comp_index ? ends[1] : ends[0]];
+    if (!partner->is_placed) {
+      if (!solver->join_constraints)
+        return 1; // A later neighbour may still place it
+      continue;
+    }
+    frontier[frontier_count] = &solver->constraints[c];
+    partners[frontier_count] = partner;
+    frontier_count++;
+  }
+  if (frontier_count == 0)
+    return 1;
 
-  // Now try each child in order (best to worst)
-  for (int i = 0; i < ts->current_node->child_count; i++) {
-    TreeNode *child = ts->current_node->children[i];
+  if (solver->join_constraints) {
+    return has_free_adjacent_position(solver, comp, partners[0], frontier[0]->direction,
+                                      frontier + 1, partners + 1, frontier_count - 1);
+  }
+  for (int i = 0; i < frontier_count; i++) {
+    if (has_free_adjacent_position(solver, comp, partners[i], frontier[i]->direction,
+                                   NULL, NULL, 0))
+      return 1;
+  }
+  return 0;
+}
 
-    if (child->marked_failed) {
-      printf("⏭️  Skipping child %d - already marked as failed\n", i + 1);
+/**
+ * @brief Forward check after placing comp: fails if an unplaced component
+ * near the new placement has no position left
+ *
+ * Only components with a placed neighbour whose surroundings intersect the
+ * new placement (or whose neighbour is comp itself) can have lost options.
+ *
+ * @return Unplaced component that can no longer be placed, or NULL
+ */
+static Component *forward_check_placement(LayoutSolver *solver, const Component *comp) {
+  const TreeSolver *ts = &solver->tree_solver;
+  for (int i = 0; i < solver->constraint_count; i++) {
+    const int *ends = ts->constraint_ends[i];
+    if (ends[0] < 0)
+      continue;
+    Component *a = &solver->components[ends[0]];
+    Component *b = &solver->components[ends[1]];
+    if (a->is_placed == b->is_placed)
       continue;
+    Component *unplaced = a->is_placed ? b : a;
+    const Component *placed = a->is_placed ? a : b;
+
+    int affected = placed == comp ||
+                   (has_horizontal_overlap(comp->placed_x, comp->width,
+                                           placed->placed_x - unplaced->width,
+                                           placed->width + 2 * unplaced->width) &&
+                    has_vertical_overlap(comp->placed_y, comp->height,
+                                         placed->placed_y - unplaced->height,
+                                         placed->height + 2 * unplaced->height));
+    if (affected && !component_still_placeable(solver, unplaced))
+      return unplaced;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Places one pre-generated child and searches below it
+ *
+ * On failure the child is marked, its component removed and the constraint
+ * returned to the remaining list. The classic serial search appends it; the
+ * deterministic parallel search puts it back at the slot it was taken from,
+ * so the constraint order below a node depends only on the path to it and
+ * not on which earlier siblings failed.
+ *
+ * @param solver        The layout solver instance
+ * @param child_index   Index of the child of ts->current_node to explore
+ * @param constraint    Constraint the children resolve
+ * @param unplaced_comp Component the children place
+ * @return              1 if a complete layout was found below the child
+ */
+int explore_tree_child(LayoutSolver *solver, int child_index,
+                       DSLConstraint *constraint, Component *unplaced_comp) {
+  TreeSolver *ts = &solver->tree_solver;
+  TreeNode *parent = ts->current_node;
+  TreeNode *child = parent->children[child_index];
+
+  if (!child) {
+    if (!parent->lazy_children) {
+      return 0;  // Failed earlier and released under memory pressure
     }
+    child = create_child_node(solver, parent, &parent->placement_options[child_index],
+                              constraint, unplaced_comp);
+    if (!child) {
+      return 0;
+    }
+    parent->children[child_index] = child;
+  }
 
-    printf("🎯 Exploring option %d/%d: %s at (%d,%d)\n", i + 1, valid_count,
-           child->component->name, child->x, child->y);
+  if (child->marked_failed) {
+    SOLVER_LOG(solver, "⏭️  Skipping child %d - already marked as failed\n", child_index + 1);
+    return 0;
+  }
 
-    child->being_explored = 1;
+  SOLVER_LOG(solver, "🎯 Exploring option %d/%d: %s at (%d,%d)\n", child_index + 1,
+             parent->child_count, unplaced_comp->name, child->x, child->y);
 
-    // Try placing component at this position
-    int placement_success = tree_place_component(solver, child);
+  DepthStats *stats = depth_stats_at(solver, parent->depth);
+  if (stats) {
+    stats->children_explored++;
+  }
 
-    if (!placement_success) {
-      printf("  ❌ Placement failed (overlap or invalid)\n");
-      child->marked_failed = 1;
-      child->being_explored = 0;
-      continue;
+  child->being_explored = 1;
+
+  // Try placing component at this position
+  int placement_success = tree_place_component(solver, child);
+
+  if (!placement_success) {
+    SOLVER_LOG(solver, "  ❌ Placement failed (overlap or invalid)\n");
+    if (stats) {
+      stats->failures++;
     }
+    child->marked_failed = 1;
+    child->being_explored = 0;
+    release_failed_child(solver, parent, child_index);
+    return 0;
+  }
 
-    // Placement succeeded at this node
-    child->placement_succeeded = 1;
-    ts->current_node = child;
+  // Placement succeeded at this node
+  child->placement_succeeded = 1;
+  ts->current_node = child;
 
-    debug_log_tree_node_creation(solver, child);
+  debug_log_tree_node_creation(solver, child);
+  if (solver->progress_hook) {
+    solver->progress_hook(solver, solver->progress_context);
+  }
 
-    // Remove this constraint from remaining
-    for (int j = 0; j < ts->remaining_count; j++) {
-      if (ts->remaining_constraints[j] == next_constraint) {
-        for (int k = j; k < ts->remaining_count - 1; k++) {
-          ts->remaining_constraints[k] = ts->remaining_constraints[k + 1];
-        }
-        ts->remaining_count--;
-        break;
+  // Remove this constraint from remaining
+  int slot = -1;
+  for (int j = 0; j < ts->remaining_count; j++) {
+    if (ts->remaining_constraints[j] == constraint) {
+      for (int k = j; k < ts->remaining_count - 1; k++) {
+        ts->remaining_constraints[k] = ts->remaining_constraints[k + 1];
       }
+      ts->remaining_count--;
+      slot = j;
+      break;
     }
+  }
 
-    // Recursively process next constraint
-    int result = advance_to_next_constraint(solver);
-    if (result) {
-      return 1; // Success!
+  // A state another search already exhausted fails here too
+  uint64_t signature = 0;
+  int known_failure = 0;
+  if (nogood_store_usable(solver)) {
+    signature = compute_failure_signature(solver);
+    known_failure =
+        nogood_store_contains(solver->nogood_store, &solver->nogood_stats, signature);
+    if (known_failure) {
+      SOLVER_LOG(solver, "  🚫 Known nogood, skipping subtree\n");
     }
+  }
 
-    // Failed deeper in the tree - mark this branch as failed
-    printf("  ❌ Branch failed, marking with X and trying next option\n");
-    child->marked_failed = 1;
-    child->being_explored = 0;
+  // Forward check: a neighbour left without a free position fails here
+  // instead of somewhere below
+  Component *stuck = known_failure || !solver->forward_checking
+                         ? NULL
+                         : forward_check_placement(solver, unplaced_comp);
+  if (stuck) {
+    SOLVER_LOG(solver, "  ⏩ Forward check: no position left for %s\n", stuck->name);
+  }
 
-    // Backtrack: remove component and restore constraint
-    remove_component(solver, unplaced_comp);
-    ts->current_node = child->parent;
+  // Recursively process next constraint
+  if (!known_failure && !stuck && advance_to_next_constraint(solver)) {
+    return 1; // Success!
+  }
 
-    // Re-add constraint to remaining
-    ts->remaining_constraints[ts->remaining_count++] = next_constraint;
+  // Only exhaustive failures are nogoods; a cancelled subtree proves nothing
+  if (signature && !known_failure && !solver->search_cancelled) {
+    nogood_store_insert(solver->nogood_store, &solver->nogood_stats, signature);
   }
 
-  // All options failed
-  printf("❌ All %d placement options exhausted for %s\n", valid_count, unplaced_comp->name);
+  // Failed deeper in the tree - mark this branch as failed
+  SOLVER_LOG(solver, "  ❌ Branch failed, marking with X and trying next option\n");
+  if (stats) {
+    stats->failures++;
+  }
+  child->marked_failed = 1;
+  child->being_explored = 0;
+
+  // Backtrack: remove component and restore constraint
+  remove_component(solver, unplaced_comp);
+  ts->current_node = parent;
+  ts->backtracks++;
+  TRACE_BACKTRACK(child->depth, parent->depth);
+
+  // Re-add constraint to remaining
+  if (solver->search_threads > 0 && slot >= 0) {
+    for (int k = ts->remaining_count; k > slot; k--) {
+      ts->remaining_constraints[k] = ts->remaining_constraints[k - 1];
+    }
+    ts->remaining_constraints[slot] = constraint;
+    ts->remaining_count++;
+  } else {
+    ts->remaining_constraints[ts->remaining_count++] = constraint;
+  }
+  release_failed_child(solver, parent, child_index);
   return 0;
 }
 
@@ -1576,16 +2666,28 @@ int generate_placement_options_for_constraint(LayoutSolver *solver,
   }
 
   if (!placed_comp) {
-    printf("❌ No placed component found for constraint\n");
+    SOLVER_LOG(solver, "❌ No placed component found for constraint\n");
     return 0;
   }
 
-  printf("📍 Placed component: %s at (%d,%d)\n", placed_comp->name,
-         placed_comp->placed_x, placed_comp->placed_y);
+  SOLVER_LOG(solver, "📍 Placed component: %s at (%d,%d)\n", placed_comp->name,
+             placed_comp->placed_x, placed_comp->placed_y);
+
+  int option_count = solver->option_cache
+                         ? option_cache_lookup(solver->option_cache, solver, constraint,
+                                               unplaced_comp, placed_comp, options)
+                         : -1;
+  if (option_count >= 0) {
+    return option_count;
+  }
 
   // Use the direct constraint system to generate placements
-  int option_count = generate_constraint_placements(solver, constraint, unplaced_comp,
-                                                    placed_comp, options, 200);
+  option_count = generate_constraint_placements(solver, constraint, unplaced_comp,
+                                                placed_comp, options, 200);
+  if (solver->option_cache) {
+    option_cache_store(solver->option_cache, solver, constraint, unplaced_comp, placed_comp,
+                       options, option_count);
+  }
 
   return option_count;
 }
@@ -1628,13 +2730,12 @@ void detect_placement_conflicts_detailed(LayoutSolver *solver, Component *comp,
                                          ConflictInfo *conflicts) {
   conflicts->conflict_count = 0;
 
+  int comp_index = comp - solver->components;
   for (int i = 0; i < solver->component_count; i++) {
-    Component *other = &solver->components[i];
-    if (other == comp || !other->is_placed)
+    if (i == comp_index || !solver->placements[i].is_placed)
       continue;
 
-    if (has_character_overlap(solver, comp, x, y, other, other->placed_x,
-                              other->placed_y)) {
+    if (placement_overlaps(solver, comp, x, y, i)) {
       if (conflicts->conflict_count < MAX_COMPONENTS) {
         conflicts->conflicting_components[conflicts->conflict_count] = i;
 
@@ -1685,11 +2786,13 @@ TreeNode *find_conflict_backtrack_target(LayoutSolver *solver,
  * @brief Place a component at a tree node's position
  */
 int tree_place_component(LayoutSolver *solver, TreeNode *node) {
-  if (!is_placement_valid(solver, node->component, node->x, node->y)) {
+  // Resolve by index: parallel workers share nodes created by the main solver
+  Component *comp = &solver->components[node->component_index];
+  if (!is_placement_valid(solver, comp, node->x, node->y)) {
     return 0;
   }
 
-  place_component(solver, node->component, node->x, node->y);
+  place_component(solver, comp, node->x, node->y);
   return 1;
 }
 
@@ -1717,6 +2820,166 @@ DSLConstraint *get_next_constraint_involving_placed(LayoutSolver *solver) {
   return NULL; // No more constraints with one placed component
 }
 
+/**
+ * @brief Picks the next constraint according to the configured order
+ *
+ * @param solver The layout solver instance
+ * @return       Next constraint to resolve, or NULL when none is ready
+ */
+DSLConstraint *select_next_constraint(LayoutSolver *solver) {
+  if (solver->search_config.constraint_order == CONSTRAINT_ORDER_FAIL_FIRST) {
+    return get_fail_first_constraint(solver);
+  }
+  return get_next_constraint_involving_placed(solver);
+}
+
+/**
+ * @brief Fail-first ordering: the ready constraint with the fewest valid options
+ *
+ * Generates the placement options of every constraint that has exactly one
+ * placed component and picks the one with the fewest conflict-free options,
+ * so dead ends are found as close to the root as possible. Ties keep
+ * declaration order.
+ *
+ * @param solver The layout solver instance
+ * @return       Most restricted ready constraint, or NULL when none is ready
+ */
+DSLConstraint *get_fail_first_constraint(LayoutSolver *solver) {
+  TreeSolver *ts = &solver->tree_solver;
+  DSLConstraint *best = NULL;
+  int best_valid = -1;
+
+  // Option counting is bookkeeping, keep it out of the progress output
+  int saved_verbose = solver->verbose;
+  solver->verbose = 0;
+
+  for (int i = 0; i < ts->remaining_count && best_valid != 0; i++) {
+    DSLConstraint *constraint = ts->remaining_constraints[i];
+    Component *comp_a = find_component(solver, constraint->component_a);
+    Component *comp_b = find_component(solver, constraint->component_b);
+    int a_placed = (comp_a && comp_a->is_placed);
+    int b_placed = (comp_b && comp_b->is_placed);
+    if (a_placed == b_placed) {
+      continue;
+    }
+
+    TreePlacementOption options[200];
+    int option_count = generate_placement_options_for_constraint(
+        solver, constraint, a_placed ? comp_b : comp_a, options);
+    int valid = 0;
+    for (int j = 0; j < option_count; j++) {
+      if (!options[j].has_conflict) {
+        valid++;
+      }
+    }
+
+    if (!best || valid < best_valid) {
+      best = constraint;
+      best_valid = valid;
+    }
+  }
+
+  solver->verbose = saved_verbose;
+  return best;
+}
+
+/**
+ * @brief Chooses the root component according to the configured root choice
+ *
+ * @param solver The layout solver instance
+ * @return       Unplaced component to place first, or NULL if none
+ */
+Component *select_root_component(LayoutSolver *solver) {
+  if (solver->forced_root >= 0) {
+    return &solver->components[solver->forced_root];
+  }
+  RootChoice choice = solver->search_config.root_choice;
+  if (choice == ROOT_MOST_CONSTRAINED) {
+    return find_most_constrained_unplaced(solver);
+  }
+  if (choice == ROOT_PROBED) {
+    return probe_root_component(solver);
+  }
+
+  Component *root = NULL;
+  int min_degree = 0;
+  for (int i = 0; i < solver->component_count; i++) {
+    Component *comp = &solver->components[i];
+    if (comp->is_placed)
+      continue;
+    if (choice == ROOT_FIRST_DECLARED)
+      return comp;
+
+    int degree = count_constraint_degree(solver, comp);
+    if (!root || degree < min_degree) {
+      root = comp;
+      min_degree = degree;
+    }
+  }
+  return root;
+}
+
+/**
+ * @brief Shuffles runs of options that the ordering considers equal
+ *
+ * Expects options already sorted by order_placement_options(); only options
+ * with the same conflict status and preference score swap places, so the
+ * better-scored options still come first.
+ *
+ * @param solver       The layout solver instance (owns the rand_r state)
+ * @param options      Ordered placement options
+ * @param option_count Number of options
+ */
+void shuffle_tied_options(LayoutSolver *solver, TreePlacementOption *options,
+                          int option_count) {
+  int run_start = 0;
+  while (run_start < option_count) {
+    int run_end = run_start + 1;
+    while (run_end < option_count &&
+           options[run_end].has_conflict == options[run_start].has_conflict &&
+           options[run_end].preference_score ==
+               options[run_start].preference_score) {
+      run_end++;
+    }
+
+    for (int i = run_end - 1; i > run_start; i--) {
+      int j = run_start + rand_r(&solver->rng_state) % (i - run_start + 1);
+      TreePlacementOption temp = options[i];
+      options[i] = options[j];
+      options[j] = temp;
+    }
+    run_start = run_end;
+  }
+}
+
+/**
+ * @brief Checks the shared cancellation flag
+ *
+ * Records the cancellation in solver->search_cancelled so callers can tell a
+ * cancelled search from an unsatisfiable one. A search whose memory budget
+ * ran out (solver->memory_exhausted) or that reached solver->node_limit also
+ * stops here.
+ *
+ * @param solver The layout solver instance
+ * @return       1 if the search should stop, 0 otherwise
+ */
+int search_cancel_requested(LayoutSolver *solver) {
+  if (solver->memory_exhausted) {
+    return 1;
+  }
+  if (solver->node_limit > 0 &&
+      solver->tree_solver.nodes_created >= solver->node_limit) {
+    solver->search_cancelled = 1;
+    return 1;
+  }
+  if (solver->cancel_flag &&
+      atomic_load_explicit(solver->cancel_flag, memory_order_relaxed)) {
+    solver->search_cancelled = 1;
+    return 1;
+  }
+  return 0;
+}
+
 // =============================================================================
 // SYSTEMATIC BACKTRACKING IMPLEMENTATION (BFS-STYLE)
 // =============================================================================
@@ -1780,39 +3043,40 @@ void remove_node_and_descendants_from_grid(LayoutSolver* solver, TreeNode* node)
  */
 int rebuild_subtree_from_node(LayoutSolver* solver, TreeNode* node) {
   if (node->child_count > 0) {
-    printf("🔧 Rebuilding subtree from %s (depth %d) - %d children to rebuild\n",
-           node->component->name, node->depth, node->child_count);
+    SOLVER_LOG(solver, "🔧 Rebuilding subtree from %s (depth %d) - %d children to rebuild\n",
+               node->component->name, node->depth, node->child_count);
   }
 
   // For each child, try to place it using its constraint
   for (int i = 0; i < node->child_count; i++) {
     TreeNode* child = node->children[i];
+    if (!child) continue;  // Released under memory pressure
 
-    printf("  🔄 Attempting to rebuild: %s\n", child->component->name);
+    SOLVER_LOG(solver, "  🔄 Attempting to rebuild: %s\n", child->component->name);
 
     // Check if child's current position is still valid
     if (is_placement_valid(solver, child->component, child->x, child->y)) {
       // Place at same position
-      printf("    ✅ Original position (%d,%d) still valid\n", child->x, child->y);
+      SOLVER_LOG(solver, "    ✅ Original position (%d,%d) still valid\n", child->x, child->y);
       place_component(solver, child->component, child->x, child->y);
 
       // Recursively rebuild this child's subtree
       if (!rebuild_subtree_from_node(solver, child)) {
-        printf("    ❌ Failed to rebuild descendants of %s\n", child->component->name);
+        SOLVER_LOG(solver, "    ❌ Failed to rebuild descendants of %s\n", child->component->name);
         return 0; // Failed to rebuild
       }
     } else {
       // Current position not valid, try alternatives
-      printf("    ⚠️  Original position (%d,%d) no longer valid, trying %d alternatives\n",
-             child->x, child->y, child->my_alternatives_count);
+      SOLVER_LOG(solver, "    ⚠️  Original position (%d,%d) no longer valid, trying %d alternatives\n",
+                 child->x, child->y, child->my_alternatives_count);
 
       int found_valid = 0;
       for (int alt_idx = 0; alt_idx < child->my_alternatives_count; alt_idx++) {
         TreePlacementOption* alt = &child->my_placement_alternatives[alt_idx];
 
         if (is_placement_valid(solver, child->component, alt->x, alt->y)) {
-          printf("    ✅ Alternative %d/%d at (%d,%d) is valid\n",
-                 alt_idx + 1, child->my_alternatives_count, alt->x, alt->y);
+          SOLVER_LOG(solver, "    ✅ Alternative %d/%d at (%d,%d) is valid\n",
+                     alt_idx + 1, child->my_alternatives_count, alt->x, alt->y);
 
           // Update child position
           child->x = alt->x;
@@ -1828,21 +3092,21 @@ int rebuild_subtree_from_node(LayoutSolver* solver, TreeNode* node) {
           }
 
           // Failed, remove and try next alternative
-          printf("    ⚠️  Descendants failed, trying next alternative\n");
+          SOLVER_LOG(solver, "    ⚠️  Descendants failed, trying next alternative\n");
           remove_component(solver, child->component);
         }
       }
 
       if (!found_valid) {
-        printf("    ❌ No valid alternatives found for %s\n", child->component->name);
+        SOLVER_LOG(solver, "    ❌ No valid alternatives found for %s\n", child->component->name);
         return 0; // Couldn't find valid placement for child
       }
     }
   }
 
   if (node->child_count > 0) {
-    printf("  ✅ Successfully rebuilt all %d children of %s\n",
-           node->child_count, node->component->name);
+    SOLVER_LOG(solver, "  ✅ Successfully rebuilt all %d children of %s\n",
+               node->child_count, node->component->name);
   }
 
   return 1; // Successfully rebuilt subtree
@@ -1862,13 +3126,13 @@ int try_node_alternative_and_rebuild(LayoutSolver* solver, TreeNode* node) {
 
     TreePlacementOption* alt = &node->my_placement_alternatives[alt_idx];
 
-    printf("  🔄 Trying alternative %d/%d for %s: (%d,%d) score=%d conflict=%d\n",
-           alt_idx + 1, node->my_alternatives_count, node->component->name,
-           alt->x, alt->y, alt->preference_score, alt->has_conflict);
+    SOLVER_LOG(solver, "  🔄 Trying alternative %d/%d for %s: (%d,%d) score=%d conflict=%d\n",
+               alt_idx + 1, node->my_alternatives_count, node->component->name,
+               alt->x, alt->y, alt->preference_score, alt->has_conflict);
 
     // Check if this alternative is valid
     if (!is_placement_valid(solver, node->component, alt->x, alt->y)) {
-      printf("    ❌ Alternative position not valid\n");
+      SOLVER_LOG(solver, "    ❌ Alternative position not valid\n");
       continue;
     }
 
@@ -1882,12 +3146,12 @@ int try_node_alternative_and_rebuild(LayoutSolver* solver, TreeNode* node) {
 
     // Try to rebuild descendants
     if (rebuild_subtree_from_node(solver, node)) {
-      printf("    ✅ Successfully placed at alternative position and rebuilt subtree\n");
+      SOLVER_LOG(solver, "    ✅ Successfully placed at alternative position and rebuilt subtree\n");
       return 1;
     }
 
     // Failed to rebuild, remove and try next alternative
-    printf("    ❌ Failed to rebuild subtree\n");
+    SOLVER_LOG(solver, "    ❌ Failed to rebuild subtree\n");
     remove_component(solver, node->component);
   }
 
@@ -1901,22 +3165,22 @@ int try_node_alternative_and_rebuild(LayoutSolver* solver, TreeNode* node) {
 int systematic_backtrack_and_retry(LayoutSolver* solver) {
   TreeSolver* ts = &solver->tree_solver;
 
-  printf("\n🌳 SYSTEMATIC BACKTRACKING\n");
-  printf("   Strategy: Try alternative placements for earlier nodes (leaves → root)\n");
+  SOLVER_LOG(solver, "\n🌳 SYSTEMATIC BACKTRACKING\n");
+  SOLVER_LOG(solver, "   Strategy: Try alternative placements for earlier nodes (leaves → root)\n");
 
   // Collect all nodes in the tree
   TreeNode* all_nodes[MAX_COMPONENTS];
   int node_count = 0;
   collect_all_tree_nodes(ts->root, all_nodes, &node_count);
 
-  printf("   Collected %d nodes in tree\n", node_count);
+  SOLVER_LOG(solver, "   Collected %d nodes in tree\n", node_count);
 
   // Sort by depth descending (deepest/most recent first)
   sort_nodes_by_depth_descending(all_nodes, node_count);
 
-  printf("   Trying alternatives starting from depth %d down to depth %d\n",
-         node_count > 0 ? all_nodes[0]->depth : 0,
-         node_count > 0 ? all_nodes[node_count-1]->depth : 0);
+  SOLVER_LOG(solver, "   Trying alternatives starting from depth %d down to depth %d\n",
+             node_count > 0 ? all_nodes[0]->depth : 0,
+             node_count > 0 ? all_nodes[node_count-1]->depth : 0);
 
   // Try each node (skip root since we don't reposition it)
   for (int i = 0; i < node_count; i++) {
@@ -1924,7 +3188,7 @@ int systematic_backtrack_and_retry(LayoutSolver* solver) {
 
     // Skip root node
     if (node->depth == 0) {
-      printf("\n  ⏭️  Skipping root node\n");
+      SOLVER_LOG(solver, "\n  ⏭️  Skipping root node\n");
       continue;
     }
 
@@ -1932,17 +3196,17 @@ int systematic_backtrack_and_retry(LayoutSolver* solver) {
     int has_untried = (node->my_current_alternative_index + 1 < node->my_alternatives_count);
 
     if (!has_untried) {
-      printf("\n  ⏭️  Node %s (depth %d) has no untried alternatives\n",
-             node->component->name, node->depth);
+      SOLVER_LOG(solver, "\n  ⏭️  Node %s (depth %d) has no untried alternatives\n",
+                 node->component->name, node->depth);
       continue;
     }
 
-    printf("\n  🎯 Trying alternatives for %s (depth %d, currently at option %d/%d)\n",
-           node->component->name, node->depth,
-           node->my_current_alternative_index + 1, node->my_alternatives_count);
+    SOLVER_LOG(solver, "\n  🎯 Trying alternatives for %s (depth %d, currently at option %d/%d)\n",
+               node->component->name, node->depth,
+               node->my_current_alternative_index + 1, node->my_alternatives_count);
 
     // Save current state: we need to remove this node and all descendants
-    printf("    Removing node and descendants from grid...\n");
+    SOLVER_LOG(solver, "    Removing node and descendants from grid...\n");
     remove_node_and_descendants_from_grid(solver, node);
 
     // Save old position for logging
@@ -1961,16 +3225,16 @@ int systematic_backtrack_and_retry(LayoutSolver* solver) {
       debug_log_backtrack_event(solver, node, old_node_x, old_node_y, node->x, node->y);
 
       // Now try to continue with the original constraint that failed
-      printf("    ✅ Node repositioned successfully, attempting to continue solving...\n");
+      SOLVER_LOG(solver, "    ✅ Node repositioned successfully, attempting to continue solving...\n");
 
       int result = advance_to_next_constraint(solver);
       if (result) {
-        printf("  ✅ SUCCESS: Systematic backtracking resolved the issue!\n");
+        SOLVER_LOG(solver, "  ✅ SUCCESS: Systematic backtracking resolved the issue!\n");
         return 1;
       }
 
       // Still failed, restore state and try next node
-      printf("    ❌ Still couldn't place remaining components\n");
+      SOLVER_LOG(solver, "    ❌ Still couldn't place remaining components\n");
     }
 
     // Failed with this node, restore its original placement for next iteration
@@ -1978,6 +3242,6 @@ int systematic_backtrack_and_retry(LayoutSolver* solver) {
     // The next iteration will try a different node
   }
 
-  printf("\n  ❌ Systematic backtracking exhausted all node alternatives\n");
+  SOLVER_LOG(solver, "\n  ❌ Systematic backtracking exhausted all node alternatives\n");
   return 0;
 }
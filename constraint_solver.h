@@ -5,6 +5,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
+#include <stdatomic.h>
 
 // =============================================================================
 // CONSTRAINT SOLVER DATA STRUCTURES AND CONSTANTS
@@ -21,8 +23,23 @@
 #define MAX_COMPONENT_GROUP_SIZE 20  // Maximum components in a group
 #define MAX_BACKTRACK_DEPTH 50       // Maximum backtracking depth
 
+// Stack of every thread that runs a tree search (portfolio members, parallel
+// workers, root probes, floor solves): the search recurses once per placed
+// component, so these threads get a typical main thread's stack instead of
+// the platform's thread default
+#define SEARCH_THREAD_STACK_SIZE (8 * 1024 * 1024)
+
+// Progress output for interactive runs; headless and batch solves clear
+// solver->verbose so the search itself stays silent
+#define SOLVER_LOG(solver, ...)                                                \
+    do {                                                                       \
+        if ((solver)->verbose) printf(__VA_ARGS__);                            \
+    } while (0)
+
 typedef enum {
-    DSL_ADJACENT
+    DSL_ADJACENT,
+    DSL_ABOVE,      // A on the floor directly above B, footprint resting on B's
+    DSL_STAIRS      // A on the floor directly above B, stairwell cells stacked on B's
 } DSLConstraintType;
 
 // Direction characters for constraints:
@@ -33,6 +50,34 @@ typedef enum {
 // 'a' = any direction
 typedef char Direction;
 
+// Search heuristics; the defaults reproduce the original serial solver and
+// the portfolio solver (portfolio.c) races differently configured copies
+typedef enum {
+    CONSTRAINT_ORDER_STATIC,    // Next constraint in declaration order
+    CONSTRAINT_ORDER_FAIL_FIRST // Constraint with the fewest valid placement options
+} ConstraintOrder;
+
+typedef enum {
+    TIE_BREAK_PREFERENCE,       // Equal-score options keep generation order
+    TIE_BREAK_RANDOM            // Equal-score options are shuffled (seeded)
+} TieBreak;
+
+typedef enum {
+    ROOT_MOST_CONSTRAINED,      // Highest constraint degree (original heuristic)
+    ROOT_LEAST_CONSTRAINED,     // Lowest constraint degree
+    ROOT_FIRST_DECLARED,        // First component in the spec
+    ROOT_PROBED                 // Cheapest top-degree candidate by budgeted probe searches
+                                // (root_probe.c)
+} RootChoice;
+
+typedef struct SearchConfig {
+    const char* name;           // Label used in portfolio statistics
+    ConstraintOrder constraint_order;
+    TieBreak tie_break;
+    RootChoice root_choice;
+    unsigned int seed;          // Seed for TIE_BREAK_RANDOM
+} SearchConfig;
+
 // Only tree-based constraint solver is used now
 
 typedef struct Component {
@@ -42,6 +87,11 @@ typedef struct Component {
     int placed_x, placed_y;
     int is_placed;
     int group_id;  // Components with same group_id move together
+    int floor;     // Storey assigned from ABOVE/STAIRS constraints (0 = ground)
+    int is_pinned; // Placed at pinned_x/pinned_y before the search starts
+    int pinned_x, pinned_y;
+    int has_footprint;         // Must overlap the footprint rectangle (an ABOVE anchor)
+    int footprint_x, footprint_y, footprint_width, footprint_height;
 
     // Intelligent backtracking fields
     int mobility_score;        // Lower = more constrained, harder to move
@@ -49,6 +99,33 @@ typedef struct Component {
     int dependency_level;      // Placement priority (0 = place first, higher = place later)
 } Component;
 
+// Hot placement state for one component, packed into 16 bytes and stored
+// apart from the name and tile data so overlap scans stay in a few cache lines.
+// Mirrors the Component fields; sync_placement_record() keeps them in step.
+typedef struct PlacementRecord {
+    int32_t x, y;                  // Placed position (world coordinates)
+    int16_t width, height;         // Tile bounding box
+    int16_t is_placed;             // Whether the component is on the grid
+    int16_t reserved;              // Padding to 16 bytes
+} PlacementRecord;
+
+struct LayoutSolver;
+struct NogoodStore;
+struct MemoryBudget;
+struct SearchProfile;
+struct SolverArena;
+struct OptionCache;
+
+// Pairwise overlap kernel: does component index1 at (x1, y1) share a
+// non-space cell with component index2 at (x2, y2)? Selected per component
+// pair by tile width class when the spec is loaded (see add_component).
+typedef int (*OverlapKernel)(struct LayoutSolver* solver, int index1, int x1, int y1,
+                             int index2, int x2, int y2);
+
+// Widest tile row that fits the bitmask kernels; wider tiles use the
+// generic character loop
+#define MAX_KERNEL_TILE_WIDTH 64
+
 // Backtracking state snapshot
 typedef struct BacktrackState {
     Component components[MAX_COMPONENTS];    // Component states at this point
@@ -104,7 +181,7 @@ typedef struct TreeNode {
 
     // Tree structure
     struct TreeNode* parent;                    // Parent node
-    struct TreeNode* children[50];              // Child nodes
+    struct TreeNode* children[200];             // Child nodes (one per valid placement option)
     int child_count;                            // Number of children
 
     // Backtracking info
@@ -117,8 +194,25 @@ typedef struct TreeNode {
     TreePlacementOption my_placement_alternatives[200];  // All options available when this node was placed
     int my_alternatives_count;                           // Number of alternatives for this node
     int my_current_alternative_index;                    // Which alternative we're currently using (index in my_placement_alternatives)
+
+    // Memory pressure: children created on demand from placement_options,
+    // and freed (NULL) once they fail
+    int lazy_children;
 } TreeNode;
 
+// Search counters for the nodes expanded at one tree depth; a spike at one
+// depth points at the constraint resolved there
+#define MAX_DEPTH_STATS (MAX_COMPONENTS + 1)
+typedef struct DepthStats {
+    long expansions;                            // Nodes expanded at this depth
+    long options_generated;                     // Placement options generated
+    long options_conflicting;                   // Options filtered out as conflicting
+    long options_joined;                        // Options ruled out by joined constraints
+    long children_explored;                     // Children placed and searched
+    long failures;                              // Children whose placement or subtree failed
+    long nanoseconds;                           // Time spent expanding nodes at this depth
+} DepthStats;
+
 typedef struct TreeSolver {
     TreeNode* root;                             // Root of the search tree
     TreeNode* current_node;                     // Currently active node
@@ -130,16 +224,28 @@ typedef struct TreeSolver {
     int remaining_count;                        // Number of remaining constraints
     DSLConstraint* current_constraint;          // Currently processing constraint
 
+    // Constraint index for forward checking, built by init_tree_solver()
+    int constraint_ends[MAX_CONSTRAINTS][2];    // Components of each ADJACENT constraint (-1 = none)
+    int incident_count[MAX_COMPONENTS];         // ADJACENT constraints naming each component
+    int incident[MAX_COMPONENTS][MAX_CONSTRAINTS]; // Their indexes into solver->constraints
+
     // Statistics
     int nodes_created;                          // Total nodes created
     int backtracks;                             // Number of backtracking operations performed
+    DepthStats depth_stats[MAX_DEPTH_STATS];    // Indexed by the depth of the expanded node
 } TreeSolver;
 
 typedef struct LayoutSolver {
     Component components[MAX_COMPONENTS];
     int component_count;
+    PlacementRecord placements[MAX_COMPONENTS];  // Hot placement state, indexed like components
+    uint64_t tile_row_masks[MAX_COMPONENTS][MAX_TILE_SIZE];  // Bit c set = non-space at column c
+    OverlapKernel overlap_kernels[MAX_COMPONENTS][MAX_COMPONENTS];  // Per-pair width-class kernel
     DSLConstraint constraints[MAX_CONSTRAINTS];
     int constraint_count;
+    DSLConstraint vertical_constraints[MAX_CONSTRAINTS];  // ABOVE/STAIRS, solved by floors.c
+    int vertical_count;
+    int floor_count;                                      // Floors in the last solved layout
     char grid[MAX_GRID_SIZE][MAX_GRID_SIZE];
     int grid_width, grid_height;
     int grid_min_x, grid_min_y;  // Track minimum coordinates for dynamic grid
@@ -148,10 +254,72 @@ typedef struct LayoutSolver {
     int next_group_id;    // For assigning component group IDs
     FILE* debug_file;     // Debug output file for main solver
     FILE* tree_debug_file; // Debug output file for tree solver
+    int verbose;          // Print solver progress to stdout (SOLVER_LOG)
+    int tree_debug_enabled; // Write tree_placement_debug.log during solves
+
+    // Search heuristics and cooperative cancellation
+    SearchConfig search_config;        // Heuristics used by the tree search
+    unsigned int rng_state;            // rand_r() state for TIE_BREAK_RANDOM
+    const atomic_int* cancel_flag;     // Search stops when set and non-zero (NULL = never)
+    int search_cancelled;              // Last search stopped because of cancel_flag,
+                                       // an exhausted memory budget or node_limit
+    int search_threads;                // 0 = classic serial search, N > 0 = deterministic
+                                       // parallel search on N workers (parallel_search.c)
+    struct NogoodStore* nogood_store;  // Shared failure signatures for this spec (NULL = off)
+    struct NogoodStats {               // Store traffic of this solver's search, added to the
+                                       // store when solve_tree_constraint() returns
+        long lookups;                  // nogood_store_contains() calls
+        long hits;                     // Lookups that found the signature
+        long inserts;                  // Signatures added
+        long duplicates;               // Inserts that found the signature already present
+        long cas_failures;             // Lost CAS races while claiming a slot
+        long probes;                   // Slots inspected by lookups and inserts
+        long dropped;                  // Inserts given up after NOGOOD_MAX_PROBES slots
+    } nogood_stats;
+    void (*progress_hook)(struct LayoutSolver* solver, void* context); // Called after each
+                                       // successful placement in the search (NULL = off); may
+                                       // run on several worker threads at once
+    void* progress_context;            // Passed to progress_hook
+    int (*accept_hook)(struct LayoutSolver* solver, void* context); // Called with each complete
+                                       // layout (NULL = accept the first); returning 0 rejects
+                                       // it and the search backtracks. Serial search only
+    void* accept_context;              // Passed to accept_hook
+    struct MemoryBudget* memory_budget; // Accounts tree nodes and search copies (NULL = malloc)
+    int memory_exhausted;              // Last solve stopped because the budget ran out
+    struct SearchProfile* search_profile; // Per-path expansion effort for flame graphs (NULL = off)
+    struct SolverArena* arena;         // Buffers and tree nodes kept across solves (NULL = malloc);
+                                       // used by this solver and its serial root probes only
+    struct OptionCache* option_cache;  // Generated options kept until a placement nearby
+                                       // (NULL = off); search copies get their own
 
     // Tree-based constraint solver (only solver type used)
     TreeSolver tree_solver;            // Tree-based constraint resolution state
 
+    // Pruning that looks past the constraint being resolved
+    int join_constraints;              // Options must also satisfy every other constraint to a
+                                       // placed component, which enforces constraints closing a cycle
+    int forward_checking;              // After each placement, fail at once if a neighbouring
+                                       // component has no free position left (opt-in: it can
+                                       // change the layout the serial search returns)
+    // Root probing (ROOT_PROBED): short searches from the top-degree
+    // candidates estimate which root reaches a layout in the fewest nodes
+    int root_probe_nodes;              // Node budget of each probe search
+    int forced_root;                   // Component select_root_component() returns (-1 = use
+                                       // search_config.root_choice); set on probe copies
+    int root_x, root_y;                // Where run_tree_search() places an unpinned root
+    int node_limit;                    // Search stops after creating this many nodes (0 = none)
+    struct RootProbeStats {
+        int selections;                // Roots chosen by probing
+        int kept_degree_choice;        // Selections that agreed with ROOT_MOST_CONSTRAINED
+        int probes;                    // Probe searches run
+        long probe_nodes;              // Nodes created by all probes
+        int last_root;                 // Component chosen by the last selection
+        int last_degree_root;          // Component ROOT_MOST_CONSTRAINED would have chosen
+        double last_estimate;          // Probe cost of last_root: nodes used if it solved,
+                                       // else estimated nodes to a first layout
+        double last_degree_estimate;   // Probe cost of last_degree_root, counted the same way
+    } root_probe_stats;
+
     // Backtracking stack
     BacktrackState backtrack_stack[MAX_BACKTRACK_DEPTH];
     int backtrack_depth; // Current depth in backtracking stack
@@ -183,26 +351,37 @@ typedef struct LayoutSolver {
 // CORE SOLVER INTERFACE
 // =============================
 void init_solver(LayoutSolver* solver, int width, int height);
+void reset_solver(LayoutSolver* solver, int width, int height); // init_solver() keeping settings and attachments
 int solve_constraints(LayoutSolver* solver);
 
 // =============================
 // TREE-BASED CONSTRAINT SOLVER
 // =============================
 int solve_tree_constraint(LayoutSolver* solver);       // Tree-based constraint resolution
+int run_tree_search(LayoutSolver* solver);             // Single search pass with the current overlap mode
+void clear_all_placements(LayoutSolver* solver);       // Unplace every component and clear the grid
+extern const SearchConfig DEFAULT_SEARCH_CONFIG;       // Original serial heuristics
+void adopt_solver_layout(LayoutSolver* solver, const LayoutSolver* source); // Take over another copy's result
+void rebase_tree_pointers(TreeNode* node, const LayoutSolver* from, LayoutSolver* to);
 
 // =============================
 // COMPONENT MANAGEMENT
 // =============================
 Component* find_component(LayoutSolver* solver, const char* name);
 void add_component(LayoutSolver* solver, const char* name, const char* tile_data);
+void set_component_tile(LayoutSolver* solver, int index, const char* tile_data);
 void remove_component(LayoutSolver* solver, Component* comp);
 int is_placement_valid(LayoutSolver* solver, Component* comp, int x, int y);
 void place_component(LayoutSolver* solver, Component* comp, int x, int y);
+void sync_placement_record(LayoutSolver* solver, Component* comp);
+OverlapKernel select_overlap_kernel(int width1, int width2);
 
 // =============================
 // CONSTRAINT MANAGEMENT
 // =============================
 void add_constraint(LayoutSolver* solver, const char* constraint_line);
+int add_adjacent_constraint(LayoutSolver* solver, const char* component_a, const char* component_b, Direction direction);
+int add_vertical_constraint(LayoutSolver* solver, DSLConstraintType type, const char* component_a, const char* component_b);
 int satisfies_constraints(LayoutSolver* solver, Component* comp, int x, int y);
 
 // =============================
@@ -211,6 +390,7 @@ int satisfies_constraints(LayoutSolver* solver, Component* comp, int x, int y);
 int has_overlap(LayoutSolver* solver, Component* comp, int x, int y);
 int has_horizontal_overlap(int x1, int w1, int x2, int w2);
 int has_vertical_overlap(int y1, int h1, int y2, int h2);
+int placement_overlaps(LayoutSolver* solver, Component* comp, int x, int y, int other_index);
 
 // =============================
 // CONSTRAINT VALIDATION
@@ -248,8 +428,8 @@ int try_relocate_component(LayoutSolver* solver, int comp_index, Component* targ
 // =============================
 void init_tree_solver(LayoutSolver* solver);
 void cleanup_tree_solver(LayoutSolver* solver);
-TreeNode* create_tree_node(Component* comp, DSLConstraint* constraint, int x, int y, int depth, int comp_index);
-void free_tree_node(TreeNode* node);
+TreeNode* create_tree_node(LayoutSolver* solver, Component* comp, DSLConstraint* constraint, int x, int y, int depth, int comp_index);
+void free_tree_node(LayoutSolver* solver, TreeNode* node);
 int generate_placement_options_for_constraint(LayoutSolver* solver, DSLConstraint* constraint, Component* unplaced_comp, TreePlacementOption* options);
 void order_placement_options(TreePlacementOption* options, int option_count);
 int calculate_preference_score(LayoutSolver* solver, Component* comp, DSLConstraint* constraint, int x, int y);
@@ -257,7 +437,16 @@ void detect_placement_conflicts_detailed(LayoutSolver* solver, Component* comp,
 TreeNode* find_conflict_backtrack_target(LayoutSolver* solver, TreePlacementOption* failed_options, int option_count);
 int tree_place_component(LayoutSolver* solver, TreeNode* node);
 int advance_to_next_constraint(LayoutSolver* solver);
+int expand_tree_node(LayoutSolver* solver, DSLConstraint** constraint_out, Component** comp_out);
+int explore_tree_child(LayoutSolver* solver, int child_index, DSLConstraint* constraint, Component* unplaced_comp);
 DSLConstraint* get_next_constraint_involving_placed(LayoutSolver* solver);
+DSLConstraint* select_next_constraint(LayoutSolver* solver);
+DSLConstraint* get_fail_first_constraint(LayoutSolver* solver);
+Component* select_root_component(LayoutSolver* solver);
+void shuffle_tied_options(LayoutSolver* solver, TreePlacementOption* options, int option_count);
+int search_cancel_requested(LayoutSolver* solver);
+void add_depth_stats(DepthStats* total, const DepthStats* add, const DepthStats* base);
+void write_depth_stats_csv(const LayoutSolver* solver, FILE* out, const char* label);
 
 // =============================
 // SYSTEMATIC BACKTRACKING (BFS-STYLE)
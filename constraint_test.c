@@ -170,6 +170,7 @@ void test_constraint(LayoutSolver *solver, int constraint_type,
   room_a->is_placed = 1;
   room_a->placed_x = 5;
   room_a->placed_y = 3;
+  sync_placement_record(solver, room_a);
 
   // Create constraint
   DSLConstraint test_constraint;
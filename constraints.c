@@ -27,7 +27,7 @@ int generate_constraint_placements(struct LayoutSolver* solver, struct DSLConstr
             return adjacent_generate_placements(solver, constraint, unplaced_comp, placed_comp, options, max_options);
         // Add new constraint types here
         default:
-            printf("❌ Unknown constraint type %d\n", constraint->type);
+            SOLVER_LOG(solver, "❌ Unknown constraint type %d\n", constraint->type);
             return 0;
     }
 }
@@ -56,7 +56,7 @@ int validate_constraint(struct LayoutSolver* solver, struct DSLConstraint* const
             return adjacent_validate_constraint(solver, constraint);
         // Add new constraint types here
         default:
-            printf("❌ Unknown constraint type %d for validation\n", constraint->type);
+            SOLVER_LOG(solver, "❌ Unknown constraint type %d for validation\n", constraint->type);
             return 0;
     }
 }
@@ -305,66 +305,10 @@ int adjacent_validate_constraint(struct LayoutSolver* solver, struct DSLConstrai
         return 0; // Components not found or not placed
     }
 
-    // Check adjacency based on constraint direction
-    Direction dir = constraint->direction;
-
-    // Component A bounds
-    int a_x1 = comp_a->placed_x;
-    int a_y1 = comp_a->placed_y;
-    int a_x2 = comp_a->placed_x + comp_a->width;
-    int a_y2 = comp_a->placed_y + comp_a->height;
-
-    // Component B bounds
-    int b_x1 = comp_b->placed_x;
-    int b_y1 = comp_b->placed_y;
-    int b_x2 = comp_b->placed_x + comp_b->width;
-    int b_y2 = comp_b->placed_y + comp_b->height;
-
-    if (dir == 'n' || dir == 'a') {
-        // Check if A is north of B (A above B)
-        if (a_y2 == b_y1 && a_x1 < b_x2 && a_x2 > b_x1) {
-            return 1; // A touches B from above
-        }
-        // Check if B is north of A (B above A)
-        if (b_y2 == a_y1 && b_x1 < a_x2 && b_x2 > a_x1) {
-            return 1; // B touches A from above
-        }
-    }
-
-    if (dir == 's' || dir == 'a') {
-        // Check if A is south of B (A below B)
-        if (a_y1 == b_y2 && a_x1 < b_x2 && a_x2 > b_x1) {
-            return 1; // A touches B from below
-        }
-        // Check if B is south of A (B below A)
-        if (b_y1 == a_y2 && b_x1 < a_x2 && b_x2 > a_x1) {
-            return 1; // B touches A from below
-        }
-    }
-
-    if (dir == 'e' || dir == 'a') {
-        // Check if A is east of B (A right of B)
-        if (a_x1 == b_x2 && a_y1 < b_y2 && a_y2 > b_y1) {
-            return 1; // A touches B from right
-        }
-        // Check if B is east of A (B right of A)
-        if (b_x1 == a_x2 && b_y1 < a_y2 && b_y2 > a_y1) {
-            return 1; // B touches A from right
-        }
-    }
-
-    if (dir == 'w' || dir == 'a') {
-        // Check if A is west of B (A left of B)
-        if (a_x2 == b_x1 && a_y1 < b_y2 && a_y2 > b_y1) {
-            return 1; // A touches B from left
-        }
-        // Check if B is west of A (B left of A)
-        if (b_x2 == a_x1 && b_y1 < a_y2 && b_y2 > a_y1) {
-            return 1; // B touches A from left
-        }
-    }
-
-    return 0; // Not adjacent in the specified direction
+    // Either component may lie on the constraint's side of the other
+    return check_adjacent_either_side(comp_a->placed_x, comp_a->placed_y, comp_a->width,
+                                      comp_a->height, comp_b->placed_x, comp_b->placed_y,
+                                      comp_b->width, comp_b->height, constraint->direction);
 }
 
 // =============================================================================
@@ -424,6 +368,30 @@ int check_adjacent(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h
     }
 }
 
+/**
+ * @brief Check if two components touch along the axis of a direction
+ *
+ * The reading of ADJACENT that option generation guarantees: options are
+ * generated on the constraint's side of whichever component was placed
+ * first, so 'n' and 's' hold with either component above the other, and
+ * 'e' and 'w' with either one beside the other.
+ */
+int check_adjacent_either_side(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2,
+                               char dir) {
+    switch (dir) {
+    case 'n':
+    case 's':
+        return check_adjacent(x1, y1, w1, h1, x2, y2, w2, h2, 'n') ||
+               check_adjacent(x1, y1, w1, h1, x2, y2, w2, h2, 's');
+    case 'e':
+    case 'w':
+        return check_adjacent(x1, y1, w1, h1, x2, y2, w2, h2, 'e') ||
+               check_adjacent(x1, y1, w1, h1, x2, y2, w2, h2, 'w');
+    default:
+        return check_adjacent(x1, y1, w1, h1, x2, y2, w2, h2, dir);
+    }
+}
+
 /**
  * @brief Check if a constraint is satisfied between two components
  *
@@ -442,13 +410,13 @@ int check_constraint_satisfied(struct LayoutSolver* solver, struct DSLConstraint
 
     if (constraint->type == DSL_ADJACENT) {
         if (comp1_is_a) {
-            return check_adjacent(test_x, test_y, comp1->width, comp1->height,
-                                comp2->placed_x, comp2->placed_y, comp2->width,
-                                comp2->height, constraint->direction);
+            return check_adjacent_either_side(test_x, test_y, comp1->width, comp1->height,
+                                              comp2->placed_x, comp2->placed_y, comp2->width,
+                                              comp2->height, constraint->direction);
         } else {
-            return check_adjacent(comp2->placed_x, comp2->placed_y, comp2->width,
-                                comp2->height, test_x, test_y, comp1->width,
-                                comp1->height, constraint->direction);
+            return check_adjacent_either_side(comp2->placed_x, comp2->placed_y, comp2->width,
+                                              comp2->height, test_x, test_y, comp1->width,
+                                              comp1->height, constraint->direction);
         }
     }
 
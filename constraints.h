@@ -64,6 +64,8 @@ int adjacent_validate_constraint(struct LayoutSolver* solver, struct DSLConstrai
 // =============================================================================
 
 int check_adjacent(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2, char dir);
+int check_adjacent_either_side(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2,
+                               char dir);
 int check_constraint_satisfied(struct LayoutSolver* solver, struct DSLConstraint* constraint,
                               struct Component* comp1, struct Component* comp2, int test_x, int test_y);
 int has_character_overlap(struct LayoutSolver* solver, struct Component* comp1, int x1, int y1,
@@ -0,0 +1,488 @@
+#include "dsl_parser.h"
+#include "solver_arena.h"
+#include <cjson/cJSON.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// =============================================================================
+// DSL SPECIFICATION PARSER
+// =============================================================================
+// Turns structure specifications into solver components and constraints.
+// Two input formats are accepted: the original markdown-style DSL, scraped
+// line by line, and a structured JSON form parsed in one pass. Kept apart
+// from the interactive menu so headless tools can link it without libcurl.
+
+// Parsing state enumeration
+typedef enum {
+    SECTION_NONE,
+    SECTION_COMPONENTS,
+    SECTION_CONSTRAINTS,
+    SECTION_TILES
+} ParsingSection;
+
+/**
+ * @brief Reads a specification file into a NUL-terminated buffer
+ * 
+ * @param filename Path to DSL specification file
+ * @return         malloc'd file content (caller frees), or NULL on failure
+ */
+char* read_specification_file(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        return NULL;
+    }
+    
+    // Read entire file into memory
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    char* file_content = file_size >= 0 ? malloc(file_size + 1) : NULL;
+    if (!file_content) {
+        fclose(file);
+        return NULL;
+    }
+    
+    size_t bytes_read = fread(file_content, 1, file_size, file);
+    file_content[bytes_read] = '\0';
+    fclose(file);
+    return file_content;
+}
+
+/**
+ * @brief Reads a specification file into the arena's file buffer
+ *
+ * Plain open()/read(): a FILE stream would allocate its own buffer per call.
+ *
+ * @return The buffer holding the NUL-terminated content, or NULL on failure
+ */
+static char* read_specification_into_arena(const char* filename, SolverArena* arena) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    char* content = fstat(fd, &st) == 0
+                        ? arena_buffer_reserve(&arena->spec_file, (size_t)st.st_size + 1)
+                        : NULL;
+    size_t total = 0;
+    while (content && total < (size_t)st.st_size) {
+        ssize_t bytes = read(fd, content + total, (size_t)st.st_size - total);
+        if (bytes <= 0) {
+            break;
+        }
+        total += (size_t)bytes;
+    }
+    close(fd);
+    if (content) {
+        content[total] = '\0';
+    }
+    return content;
+}
+
+/**
+ * @brief Parses DSL specification from a text file
+ * 
+ * Loads the entire file content into memory and delegates to string parser.
+ * Handles file I/O operations and memory management; with solver->arena set
+ * the content goes into the arena instead of a fresh allocation.
+ * 
+ * @param filename Path to DSL specification file
+ * @param solver   Layout solver instance to populate
+ * @return         1 on success, 0 on failure
+ */
+int parse_specification_file(const char* filename, LayoutSolver* solver) {
+    SOLVER_LOG(solver, "📋 Parsing specification file: %s\n", filename);
+    
+    char* file_content = solver->arena ? read_specification_into_arena(filename, solver->arena)
+                                       : read_specification_file(filename);
+    if (!file_content) {
+        SOLVER_LOG(solver, "❌ Cannot read file: %s\n", filename);
+        return 0;
+    }
+    
+    // Parse the content
+    int result = parse_specification_string(file_content, solver);
+    if (!solver->arena) {
+        free(file_content);
+    }
+    
+    return result;
+}
+
+/**
+ * @brief Parses DSL specification from string content
+ * 
+ * Main parsing engine that processes markdown-style DSL format:
+ * - ## Components section with component descriptions
+ * - ## Constraints section with ADJACENT() statements
+ * - ## Component Tiles section with ASCII art in code blocks
+ * 
+ * A specification whose first non-blank character is '{' is handed to
+ * parse_specification_json() instead.
+ * 
+ * @param specification DSL specification string to parse
+ * @param solver        Layout solver instance to populate
+ * @return              1 on success, 0 on failure
+ */
+int parse_specification_string(const char* specification, LayoutSolver* solver) {
+    const char* first = specification;
+    while (*first == ' ' || *first == '\t' || *first == '\n' || *first == '\r') first++;
+    if (*first == '{') {
+        return parse_specification_json(specification, solver);
+    }
+
+    SOLVER_LOG(solver, "📏 Specification string length: %zu bytes\n", strlen(specification));
+    SOLVER_LOG(solver, "📋 Parsing DSL specification from string...\n");
+    
+    // Create a copy of the specification to work with
+    size_t spec_size = strlen(specification) + 1;
+    char* spec_copy = solver->arena ? arena_buffer_reserve(&solver->arena->spec_text, spec_size)
+                                    : malloc(spec_size);
+    if (!spec_copy) {
+        SOLVER_LOG(solver, "❌ Memory allocation failed\n");
+        return 0;
+    }
+    strcpy(spec_copy, specification);
+    
+    ParsingSection current_section = SECTION_NONE;
+    char current_component[256] = "";
+    char tile_buffer[2048] = "";
+    int in_code_block = 0;
+    
+    // Parse line by line; strtok_r keeps concurrent parses (async pool) apart
+    char* line_state = NULL;
+    char* line = strtok_r(spec_copy, "\n", &line_state);
+    while (line != NULL) {
+        // Trim leading whitespace
+        while (*line == ' ' || *line == '\t') line++;
+        
+        // Skip empty lines
+        if (strlen(line) == 0) {
+            line = strtok_r(NULL, "\n", &line_state);
+            continue;
+        }
+        
+        // Check for section headers
+        if (strstr(line, "## Components") || strstr(line, "Components")) {
+            current_section = SECTION_COMPONENTS;
+            SOLVER_LOG(solver, "📋 Found Components section\n");
+        } else if (strstr(line, "## Constraints") || strstr(line, "Constraints")) {
+            current_section = SECTION_CONSTRAINTS;
+            SOLVER_LOG(solver, "📋 Found Constraints section\n");
+        } else if (strstr(line, "## Component Tiles") || strstr(line, "Component Tiles")) {
+            current_section = SECTION_TILES;
+            SOLVER_LOG(solver, "📋 Found Component Tiles section\n");
+        }
+
+        // Parse components in the Components section
+        if (current_section == SECTION_COMPONENTS) {
+            // Look for **ComponentName** - description format
+            char* first_star = strstr(line, "**");
+            if (first_star) {
+                char* second_star = strstr(first_star + 2, "**");
+                if (second_star) {
+                    char* start = first_star + 2;
+                    char* end = second_star;
+                    if (end && end > start) {
+                        int len = end - start;
+                        if (len < (int)sizeof(current_component)) {
+                            strncpy(current_component, start, len);
+                            current_component[len] = '\0';
+                            SOLVER_LOG(solver, "  🏷️  Found component: '%s'\n", current_component);
+                        }
+                    }
+                }
+            }
+            // Handle numbered list format: "1. Component Name"
+            else if ((line[0] >= '1' && line[0] <= '9') && strstr(line, ". ")) {
+                char* start = strstr(line, ". ") + 2;
+                // Find end of component name (before newline or dash)
+                char* end = strchr(start, '\n');
+                if (!end) end = strchr(start, '-');
+                if (!end) end = start + strlen(start);
+
+                // Trim whitespace from end
+                while (end > start && (*(end-1) == ' ' || *(end-1) == '\t')) end--;
+
+                int len = end - start;
+                if (len > 0 && len < (int)sizeof(current_component)) {
+                    strncpy(current_component, start, len);
+                    current_component[len] = '\0';
+                    SOLVER_LOG(solver, "  🏷️  Found numbered component: '%s'\n", current_component);
+                }
+            }
+        }
+        
+        // Parse component tiles
+        if (current_section == SECTION_TILES) {
+            if (strstr(line, "```")) {
+                if (!in_code_block) {
+                    in_code_block = 1;
+                    tile_buffer[0] = '\0'; // Clear buffer
+                } else {
+                    // End of code block - add component
+                    in_code_block = 0;
+                    if (strlen(current_component) > 0 && strlen(tile_buffer) > 0) {
+                        add_component(solver, current_component, tile_buffer);
+                    }
+                }
+            } else if (in_code_block) {
+                // Accumulate tile data
+                if (strlen(tile_buffer) + strlen(line) + 1 < sizeof(tile_buffer)) {
+                    if (strlen(tile_buffer) > 0) strcat(tile_buffer, "\n");
+                    strcat(tile_buffer, line);
+                }
+            } else if (strstr(line, "**") && !in_code_block) {
+                // Component name in Component Tiles section: **ComponentName**
+                char* first_star = strstr(line, "**");
+                if (first_star) {
+                    char* second_star = strstr(first_star + 2, "**");
+                    if (second_star) {
+                        char* start = first_star + 2;
+                        char* end = second_star;
+                        if (end && end > start) {
+                            int len = end - start;
+                            if (len < (int)sizeof(current_component)) {
+                                strncpy(current_component, start, len);
+                                current_component[len] = '\0';
+
+                                // Remove trailing colon if present
+                                char* colon = strchr(current_component, ':');
+                                if (colon) *colon = '\0';
+
+                                SOLVER_LOG(solver, "  🏷️  Found tile component name: '%s'\n", current_component);
+                            }
+                        }
+                    }
+                }
+            } else if (strstr(line, ":") && !in_code_block && !strstr(line, "**")) {
+                // Component name in "Name:" format (fallback)
+                char* colon = strchr(line, ':');
+                if (colon) {
+                    int len = colon - line;
+                    if (len > 0 && len < (int)sizeof(current_component)) {
+                        strncpy(current_component, line, len);
+                        current_component[len] = '\0';
+
+                        // Trim whitespace
+                        while (len > 0 && current_component[len-1] == ' ') {
+                            current_component[--len] = '\0';
+                        }
+                        SOLVER_LOG(solver, "  🏷️  Found fallback component name: '%s'\n", current_component);
+                    }
+                }
+            }
+        }
+        
+        // Parse constraints
+        if (current_section == SECTION_CONSTRAINTS && strstr(line, "(")) {
+            // Handle bullet point format (- ADJACENT(...))
+            char* constraint_start = line;
+            if (*constraint_start == '-' || *constraint_start == '*') {
+                constraint_start++;
+                while (*constraint_start == ' ' || *constraint_start == '\t') constraint_start++; // Skip whitespace
+            }
+            SOLVER_LOG(solver, "  🔗 Found constraint: '%s'\n", constraint_start);
+            add_constraint(solver, constraint_start);
+        }
+        
+        line = strtok_r(NULL, "\n", &line_state);
+    }
+    
+    if (!solver->arena) {
+        free(spec_copy);
+    }
+    SOLVER_LOG(solver, "📊 Loaded %d components and %d constraints\n", solver->component_count, solver->constraint_count);
+    return 1;
+}
+
+// =============================================================================
+// JSON SPECIFICATION FORMAT
+// =============================================================================
+// {
+//   "components": [
+//     {"name": "Keep", "description": "...", "tile": ["XXXXX", "X...X", "XXXXX"]}
+//   ],
+//   "constraints": [
+//     {"type": "ADJACENT", "a": "Courtyard", "b": "Keep", "direction": "n"},
+//     {"type": "STAIRS", "a": "UpperStair", "b": "Stair"}
+//   ]
+// }
+// ABOVE and STAIRS take no direction: a is always on the floor above b.
+// Unlike the markdown scraper, which skips what it does not recognise, the
+// JSON parser rejects the whole spec on the first structural error so a bad
+// generation is caught before it reaches the solver.
+
+/**
+ * @brief Maps a JSON direction ("n" or "north", ..., "a" or "any") to a Direction
+ * @return The direction character, or 0 if unrecognised
+ */
+Direction parse_json_direction(const char* text) {
+    static const char* names[] = {"north", "east", "south", "west", "any"};
+    if (!text) {
+        return 0;
+    }
+    for (int i = 0; i < 5; i++) {
+        if ((text[0] == names[i][0] && text[1] == '\0') || strcmp(text, names[i]) == 0) {
+            return names[i][0];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Joins a JSON tile (array of row strings, or one string) into add_component() form
+ * @return 1 on success, 0 if the tile is malformed or larger than MAX_TILE_SIZE
+ */
+int build_json_tile(const cJSON* tile, char* buffer, size_t buffer_size) {
+    if (cJSON_IsString(tile)) {
+        snprintf(buffer, buffer_size, "%s", tile->valuestring);
+        return buffer[0] != '\0';
+    }
+    if (!cJSON_IsArray(tile) || cJSON_GetArraySize(tile) == 0 ||
+        cJSON_GetArraySize(tile) > MAX_TILE_SIZE) {
+        return 0;
+    }
+
+    size_t length = 0;
+    const cJSON* row;
+    cJSON_ArrayForEach(row, tile) {
+        if (!cJSON_IsString(row) || strlen(row->valuestring) > MAX_TILE_SIZE) {
+            return 0;
+        }
+        int written = snprintf(buffer + length, buffer_size - length, "%s%s",
+                               length > 0 ? "\n" : "", row->valuestring);
+        if (written < 0 || (size_t)written >= buffer_size - length) {
+            return 0;
+        }
+        length += written;
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds every entry of the JSON "components" array
+ * @return 1 on success, 0 on the first invalid component
+ */
+static int load_json_components(const cJSON* components, LayoutSolver* solver) {
+    char tile_buffer[MAX_TILE_SIZE * (MAX_TILE_SIZE + 1) + 1];
+    const cJSON* item;
+    cJSON_ArrayForEach(item, components) {
+        const char* name = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "name"));
+        if (!name || name[0] == '\0' || strlen(name) >= sizeof(solver->components[0].name)) {
+            SOLVER_LOG(solver, "❌ JSON component without a valid \"name\"\n");
+            return 0;
+        }
+        if (find_component(solver, name)) {
+            SOLVER_LOG(solver, "❌ Duplicate JSON component '%s'\n", name);
+            return 0;
+        }
+        if (!build_json_tile(cJSON_GetObjectItemCaseSensitive(item, "tile"), tile_buffer,
+                             sizeof(tile_buffer))) {
+            SOLVER_LOG(solver, "❌ JSON component '%s' needs a \"tile\" of at most %d rows of "
+                       "%d characters\n", name, MAX_TILE_SIZE, MAX_TILE_SIZE);
+            return 0;
+        }
+        if (solver->component_count >= MAX_COMPONENTS) {
+            SOLVER_LOG(solver, "❌ JSON spec has more than %d components\n", MAX_COMPONENTS);
+            return 0;
+        }
+        add_component(solver, name, tile_buffer);
+        SOLVER_LOG(solver, "  🏷️  Found component: '%s'\n", name);
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds every entry of the JSON "constraints" array
+ * @return 1 on success, 0 on the first invalid constraint
+ */
+int load_json_constraints(const cJSON* constraints, LayoutSolver* solver) {
+    const cJSON* item;
+    cJSON_ArrayForEach(item, constraints) {
+        const char* type = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "type"));
+        const char* a = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "a"));
+        const char* b = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "b"));
+        Direction direction = parse_json_direction(
+            cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "direction")));
+
+        int vertical = type && (strcmp(type, "ABOVE") == 0 || strcmp(type, "STAIRS") == 0);
+        if (!type || (!vertical && strcmp(type, "ADJACENT") != 0)) {
+            SOLVER_LOG(solver, "❌ Unsupported JSON constraint type '%s'\n", type ? type : "");
+            return 0;
+        }
+        if (!a || !b || !find_component(solver, a) || !find_component(solver, b)) {
+            SOLVER_LOG(solver, "❌ JSON constraint names an unknown component ('%s', '%s')\n",
+                       a ? a : "", b ? b : "");
+            return 0;
+        }
+        if (vertical) {
+            if (!add_vertical_constraint(solver, type[0] == 'A' ? DSL_ABOVE : DSL_STAIRS, a, b)) {
+                SOLVER_LOG(solver, "❌ JSON spec has more than %d vertical constraints\n",
+                           MAX_CONSTRAINTS);
+                return 0;
+            }
+            SOLVER_LOG(solver, "  🔗 Found constraint: %s(%s, %s)\n", type, a, b);
+            continue;
+        }
+        if (!direction) {
+            SOLVER_LOG(solver, "❌ JSON constraint %s/%s has no valid direction\n", a, b);
+            return 0;
+        }
+        if (!add_adjacent_constraint(solver, a, b, direction)) {
+            SOLVER_LOG(solver, "❌ JSON spec has more than %d constraints\n", MAX_CONSTRAINTS);
+            return 0;
+        }
+        SOLVER_LOG(solver, "  🔗 Found constraint: ADJACENT(%s, %s, %c)\n", a, b, direction);
+    }
+    return 1;
+}
+
+/**
+ * @brief Parses a JSON specification from string content
+ * 
+ * Components are added in array order, then constraints; a constraint may
+ * only name components declared in the same spec.
+ * 
+ * @param specification JSON specification string to parse
+ * @param solver        Layout solver instance to populate
+ * @return              1 on success, 0 on the first structural error
+ */
+int parse_specification_json(const char* specification, LayoutSolver* solver) {
+    SOLVER_LOG(solver, "📋 Parsing JSON specification (%zu bytes)...\n", strlen(specification));
+
+    if (solver->arena) {
+        solver_arena_begin_json(solver->arena);
+    }
+    cJSON* root = cJSON_Parse(specification);
+    const cJSON* components = cJSON_GetObjectItemCaseSensitive(root, "components");
+    const cJSON* constraints = cJSON_GetObjectItemCaseSensitive(root, "constraints");
+    int ok = 0;
+
+    if (!cJSON_IsObject(root)) {
+        SOLVER_LOG(solver, "❌ Specification is not a valid JSON object\n");
+    } else if (!cJSON_IsArray(components) || cJSON_GetArraySize(components) == 0) {
+        SOLVER_LOG(solver, "❌ JSON spec needs a non-empty \"components\" array\n");
+    } else if (constraints && !cJSON_IsArray(constraints)) {
+        SOLVER_LOG(solver, "❌ JSON spec \"constraints\" must be an array\n");
+    } else {
+        ok = load_json_components(components, solver) &&
+             load_json_constraints(constraints, solver);
+    }
+
+    cJSON_Delete(root);
+    if (solver->arena) {
+        solver_arena_end_json(solver->arena);
+    }
+    if (ok) {
+        SOLVER_LOG(solver, "📊 Loaded %d components and %d constraints\n",
+                   solver->component_count, solver->constraint_count);
+    }
+    return ok;
+}
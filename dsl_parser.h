@@ -0,0 +1,72 @@
+#ifndef DSL_PARSER_H
+#define DSL_PARSER_H
+
+#include "constraint_solver.h"
+#include <cjson/cJSON.h>
+
+// =============================================================================
+// DSL SPECIFICATION PARSING
+// =============================================================================
+
+/**
+ * @brief Reads a specification file into a NUL-terminated buffer
+ * @param filename Path to DSL specification file
+ * @return         malloc'd file content (caller frees), or NULL on failure
+ */
+char* read_specification_file(const char* filename);
+
+/**
+ * @brief Parses DSL specification from a text file
+ * @param filename Path to DSL specification file
+ * @param solver   Layout solver instance to populate
+ * @return         1 on success, 0 on failure
+ */
+int parse_specification_file(const char* filename, LayoutSolver* solver);
+
+/**
+ * @brief Parses DSL specification from string content
+ * @param specification DSL specification string to parse
+ * @param solver        Layout solver instance to populate
+ * @return              1 on success, 0 on failure
+ */
+int parse_specification_string(const char* specification, LayoutSolver* solver);
+
+/**
+ * @brief Parses a JSON specification (components with tile rows, typed constraints)
+ * @param specification JSON specification string to parse
+ * @param solver        Layout solver instance to populate
+ * @return              1 on success, 0 on malformed input
+ */
+int parse_specification_json(const char* specification, LayoutSolver* solver);
+
+// =============================
+// JSON SPECIFICATION HELPERS
+// =============================
+// Shared with spec repair (spec_repair.c), which patches parsed specs with
+// the same tile and constraint syntax.
+
+/**
+ * @brief Maps a JSON direction ("n" or "north", ..., "a" or "any") to a Direction
+ * @param text Direction string, may be NULL
+ * @return     The direction character, or 0 if unrecognised
+ */
+Direction parse_json_direction(const char* text);
+
+/**
+ * @brief Joins a JSON tile (array of row strings, or one string) into add_component() form
+ * @param tile        JSON tile value
+ * @param buffer      Receives the newline-separated rows
+ * @param buffer_size Size of buffer
+ * @return            1 on success, 0 if the tile is malformed or larger than MAX_TILE_SIZE
+ */
+int build_json_tile(const cJSON* tile, char* buffer, size_t buffer_size);
+
+/**
+ * @brief Adds every entry of a JSON "constraints" array to the solver
+ * @param constraints JSON array of typed constraints
+ * @param solver      Solver whose components the constraints must name
+ * @return            1 on success, 0 on the first invalid constraint
+ */
+int load_json_constraints(const cJSON* constraints, LayoutSolver* solver);
+
+#endif // DSL_PARSER_H
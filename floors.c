@@ -0,0 +1,518 @@
+#include "floors.h"
+#include "constraints.h"
+#include "memory_budget.h"
+#include "option_cache.h"
+#include "solver_arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// MULTI-FLOOR LAYOUTS
+// =============================================================================
+// Towers, dungeons and cathedrals have several storeys. The tree search stays
+// strictly 2D: a multi-floor spec is split into one private solver per floor,
+// which gives every floor its own occupancy grid, so rooms on different floors
+// never collide. Floors are searched from the ground up: by the time a floor
+// is searched, the floor below is laid out, so its ABOVE/STAIRS anchors are
+// fixed positions the search starts from rather than a shift applied after
+// the fact, and every anchor holds, not just the first. A floor layout that
+// leaves no room for the floors above is rejected through the search's accept
+// hook, so the floor below backtracks into its next layout.
+
+#define FLOOR_LAYOUT_ATTEMPTS 64            // Layouts of one floor offered to the floors above
+#define MAX_ROOT_POSITIONS (4 * MAX_TILE_SIZE * MAX_TILE_SIZE) // Overlaps of two tiles
+
+typedef struct FloorSearch {
+    LayoutSolver* solver;                   // Parent solver
+    int floor;                              // Floor being searched
+    int source_index[MAX_COMPONENTS];       // Parent component index of each floor component
+    int layouts_rejected;                   // Layouts the floors above could not be built on
+    int gave_up;                            // Stopped after FLOOR_LAYOUT_ATTEMPTS layouts
+} FloorSearch;
+
+static int component_index(LayoutSolver* solver, const char* name) {
+    Component* comp = find_component(solver, name);
+    return comp ? (int)(comp - solver->components) : -1;
+}
+
+static const char* vertical_name(const DSLConstraint* constraint) {
+    return constraint->type == DSL_STAIRS ? "STAIRS" : "ABOVE";
+}
+
+/**
+ * @brief Visits one constraint edge during floor assignment
+ * @return 1 if consistent, 0 if the neighbour already has a different floor
+ */
+static int visit_floor_edge(LayoutSolver* solver, int neighbour, int floor, int* floor_of,
+                            int* visited, int* queue, int* tail) {
+    if (neighbour < 0) {
+        return 1;
+    }
+    if (!visited[neighbour]) {
+        visited[neighbour] = 1;
+        floor_of[neighbour] = floor;
+        queue[(*tail)++] = neighbour;
+        return 1;
+    }
+    if (floor_of[neighbour] != floor) {
+        SOLVER_LOG(solver, "❌ %s would have to be on floors %d and %d; check the ABOVE/STAIRS "
+                   "constraints against the ADJACENT ones\n",
+                   solver->components[neighbour].name, floor_of[neighbour], floor);
+        return 0;
+    }
+    return 1;
+}
+
+int assign_floors(LayoutSolver* solver) {
+    int floor_of[MAX_COMPONENTS] = {0};
+    int visited[MAX_COMPONENTS] = {0};
+    int queue[MAX_COMPONENTS];
+    solver->floor_count = 1;
+
+    for (int v = 0; v < solver->vertical_count; v++) {
+        const DSLConstraint* constraint = &solver->vertical_constraints[v];
+        if (component_index(solver, constraint->component_a) < 0 ||
+            component_index(solver, constraint->component_b) < 0) {
+            SOLVER_LOG(solver, "❌ %s(%s, %s) names an unknown component\n",
+                       vertical_name(constraint), constraint->component_a,
+                       constraint->component_b);
+            return 0;
+        }
+    }
+
+    for (int start = 0; start < solver->component_count; start++) {
+        if (visited[start]) {
+            continue;
+        }
+
+        int head = 0, tail = 0;
+        visited[start] = 1;
+        queue[tail++] = start;
+
+        while (head < tail) {
+            int current = queue[head++];
+            const char* name = solver->components[current].name;
+            int floor = floor_of[current];
+
+            for (int c = 0; c < solver->constraint_count; c++) {
+                const DSLConstraint* constraint = &solver->constraints[c];
+                int neighbour = -1;
+                if (strcmp(constraint->component_a, name) == 0) {
+                    neighbour = component_index(solver, constraint->component_b);
+                } else if (strcmp(constraint->component_b, name) == 0) {
+                    neighbour = component_index(solver, constraint->component_a);
+                }
+                if (!visit_floor_edge(solver, neighbour, floor, floor_of, visited, queue, &tail)) {
+                    return 0;
+                }
+            }
+
+            for (int v = 0; v < solver->vertical_count; v++) {
+                const DSLConstraint* constraint = &solver->vertical_constraints[v];
+                int ok = 1;
+                if (strcmp(constraint->component_a, name) == 0) {
+                    ok = visit_floor_edge(solver, component_index(solver, constraint->component_b),
+                                          floor - 1, floor_of, visited, queue, &tail);
+                } else if (strcmp(constraint->component_b, name) == 0) {
+                    ok = visit_floor_edge(solver, component_index(solver, constraint->component_a),
+                                          floor + 1, floor_of, visited, queue, &tail);
+                }
+                if (!ok) {
+                    return 0;
+                }
+            }
+        }
+
+        // Each connected group starts on the ground floor
+        int lowest = 0;
+        for (int i = 0; i < tail; i++) {
+            if (floor_of[queue[i]] < lowest) lowest = floor_of[queue[i]];
+        }
+        for (int i = 0; i < tail; i++) {
+            Component* comp = &solver->components[queue[i]];
+            comp->floor = floor_of[queue[i]] - lowest;
+            if (comp->floor + 1 > solver->floor_count) {
+                solver->floor_count = comp->floor + 1;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Do the floor solvers come from the arena?
+ *
+ * Like root probe copies: pooled when there is an arena, so repeated solves
+ * stay allocation-free, and charged to the budget while they are in use.
+ */
+static int floors_pooled(const LayoutSolver* solver) {
+    return solver->arena != NULL;
+}
+
+/**
+ * @brief Builds the private solver for one floor
+ *
+ * Components are re-added from their tiles so the floor solver gets its own
+ * row masks and overlap kernels; ADJACENT constraints go to the floor of the
+ * components they name.
+ */
+static LayoutSolver* create_floor_solver(LayoutSolver* solver, int floor, int* source_index) {
+    LayoutSolver* sub;
+    if (floors_pooled(solver)) {
+        if (!memory_budget_reserve(solver->memory_budget, sizeof(LayoutSolver))) {
+            return NULL;
+        }
+        sub = (LayoutSolver*)solver->arena->floor_solvers.data + floor;
+    } else {
+        sub = memory_budget_alloc(solver->memory_budget, sizeof(LayoutSolver));
+        if (!sub) {
+            return NULL;
+        }
+    }
+
+    init_solver(sub, solver->grid_width, solver->grid_height);
+    sub->verbose = 0;
+    // One tree_placement_debug.log writer at a time
+    sub->tree_debug_enabled = floor == 0 ? solver->tree_debug_enabled : 0;
+    sub->join_constraints = solver->join_constraints;
+    sub->forward_checking = solver->forward_checking;
+    sub->search_config = solver->search_config;
+    sub->root_probe_nodes = solver->root_probe_nodes;
+    sub->rng_state = solver->rng_state;
+    sub->cancel_flag = solver->cancel_flag;
+    sub->search_threads = solver->search_threads;
+    sub->memory_budget = solver->memory_budget;
+    sub->search_profile = solver->search_profile;
+    // Floors are searched one at a time on this thread and share the node pool
+    sub->arena = solver->arena;
+    if (floors_pooled(solver)) {
+        option_cache_attach_pooled(sub, solver, &solver->arena->floor_caches[floor]);
+    } else {
+        option_cache_attach_copy(sub, solver);
+    }
+    // Nogood signatures identify states of one spec; a floor is a different spec
+    sub->nogood_store = NULL;
+
+    char tile[MAX_TILE_SIZE * (MAX_TILE_SIZE + 1) + 1];
+    for (int i = 0; i < solver->component_count; i++) {
+        const Component* comp = &solver->components[i];
+        if (comp->floor != floor) {
+            continue;
+        }
+        int length = 0;
+        for (int row = 0; row < comp->height; row++) {
+            memcpy(tile + length, comp->ascii_tile[row], comp->width);
+            length += comp->width;
+            tile[length++] = '\n';
+        }
+        tile[length] = '\0';
+        source_index[sub->component_count] = i;
+        add_component(sub, comp->name, tile);
+    }
+
+    for (int c = 0; c < solver->constraint_count; c++) {
+        const DSLConstraint* constraint = &solver->constraints[c];
+        Component* a = find_component(solver, constraint->component_a);
+        Component* b = find_component(solver, constraint->component_b);
+        if ((a && a->floor == floor) || (!a && b && b->floor == floor)) {
+            add_adjacent_constraint(sub, constraint->component_a, constraint->component_b,
+                                    constraint->direction);
+        }
+    }
+    return sub;
+}
+
+/**
+ * @brief Fixes a floor's anchors over the laid-out floor below
+ *
+ * STAIRS pins the upper stairwell onto the lower one; ABOVE restricts the
+ * upper component to positions overlapping the footprint below. The search
+ * starts from the most constrained anchored component, so the floor is laid
+ * out in the coordinates of the floors below it: a pinned root starts at its
+ * pin, an ABOVE root at each position over its footprint in turn (see
+ * footprint_root_positions()).
+ *
+ * @param solver Parent solver; floors below this one are placed
+ * @param sub    Floor solver from create_floor_solver()
+ * @param floor  Floor to anchor
+ */
+static void anchor_floor(LayoutSolver* solver, LayoutSolver* sub, int floor) {
+    const DSLConstraint* root_anchor = NULL;
+    int root_degree = 0;
+    for (int v = 0; v < solver->vertical_count; v++) {
+        const DSLConstraint* constraint = &solver->vertical_constraints[v];
+        Component* upper = find_component(solver, constraint->component_a);
+        Component* lower = find_component(solver, constraint->component_b);
+        Component* comp = find_component(sub, constraint->component_a);
+        if (upper->floor != floor || !lower->is_placed) {
+            continue;
+        }
+
+        // A second anchor on the same component is checked once the floors are laid out
+        if (constraint->type == DSL_STAIRS && !comp->is_pinned) {
+            comp->pinned_x = lower->placed_x;
+            comp->pinned_y = lower->placed_y;
+            comp->is_pinned = 1;
+        } else if (constraint->type == DSL_ABOVE && !comp->has_footprint) {
+            comp->has_footprint = 1;
+            comp->footprint_x = lower->placed_x;
+            comp->footprint_y = lower->placed_y;
+            comp->footprint_width = lower->width;
+            comp->footprint_height = lower->height;
+        }
+        // Options are generated relative to the component placed first, so the
+        // floor starts where the degree heuristic would start it
+        int degree = count_constraint_degree(sub, comp);
+        if (!root_anchor || degree > root_degree) {
+            root_anchor = constraint;
+            root_degree = degree;
+        }
+        SOLVER_LOG(solver, "  🪜 Floor %d anchored on %s(%s, %s)\n", floor,
+                   vertical_name(constraint), constraint->component_a, constraint->component_b);
+    }
+    if (!root_anchor) {
+        return;
+    }
+
+    Component* root = find_component(sub, root_anchor->component_a);
+    sub->forced_root = (int)(root - sub->components);
+}
+
+/**
+ * @brief Does root at (x, y) satisfy its ADJACENT constraints to pinned components?
+ */
+static int root_position_fits_pins(LayoutSolver* sub, const Component* root, int x, int y) {
+    for (int c = 0; c < sub->constraint_count; c++) {
+        const DSLConstraint* constraint = &sub->constraints[c];
+        const char* other = strcmp(constraint->component_a, root->name) == 0
+                                ? constraint->component_b
+                            : strcmp(constraint->component_b, root->name) == 0
+                                ? constraint->component_a
+                                : NULL;
+        const Component* pin = other ? find_component(sub, other) : NULL;
+        if (pin && pin != root && pin->is_pinned &&
+            !check_adjacent_either_side(x, y, root->width, root->height, pin->pinned_x,
+                                        pin->pinned_y, pin->width, pin->height,
+                                        constraint->direction)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Positions to start a floor from when its root is only held by ABOVE
+ *
+ * Every position at which the root overlaps its footprint, in rings around
+ * the one centred on the footprint, which is tried first. Positions that
+ * break an ADJACENT constraint to a pinned component are left out: the
+ * search would reject them before its first node.
+ *
+ * @param sub       Anchored floor solver
+ * @param positions Receives up to MAX_ROOT_POSITIONS x, y pairs
+ * @return          Number of positions, 0 if the root is pinned or unanchored
+ */
+static int footprint_root_positions(LayoutSolver* sub, int (*positions)[2]) {
+    if (sub->forced_root < 0) {
+        return 0;
+    }
+    const Component* root = &sub->components[sub->forced_root];
+    if (root->is_pinned || !root->has_footprint) {
+        return 0;
+    }
+
+    int min_x = root->footprint_x - root->width + 1;
+    int max_x = root->footprint_x + root->footprint_width - 1;
+    int min_y = root->footprint_y - root->height + 1;
+    int max_y = root->footprint_y + root->footprint_height - 1;
+    int centre_x = root->footprint_x + (root->footprint_width - root->width) / 2;
+    int centre_y = root->footprint_y + (root->footprint_height - root->height) / 2;
+    int rings = 2 * MAX_TILE_SIZE;
+
+    int count = 0;
+    for (int ring = 0; ring <= rings; ring++) {
+        for (int y = min_y; y <= max_y; y++) {
+            for (int x = min_x; x <= max_x; x++) {
+                int dx = abs(x - centre_x), dy = abs(y - centre_y);
+                if ((dx > dy ? dx : dy) == ring && count < MAX_ROOT_POSITIONS &&
+                    root_position_fits_pins(sub, root, x, y)) {
+                    positions[count][0] = x;
+                    positions[count][1] = y;
+                    count++;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+static int vertical_constraint_holds(const DSLConstraint* constraint, const Component* upper,
+                                     const Component* lower) {
+    if (constraint->type == DSL_STAIRS) {
+        return upper->placed_x == lower->placed_x && upper->placed_y == lower->placed_y;
+    }
+    return has_horizontal_overlap(upper->placed_x, upper->width, lower->placed_x, lower->width) &&
+           has_vertical_overlap(upper->placed_y, upper->height, lower->placed_y, lower->height);
+}
+
+/**
+ * @brief Checks every vertical constraint against the laid-out floors
+ * @return 1 if all of them hold
+ */
+static int verify_vertical_constraints(LayoutSolver* solver) {
+    int holds = 1;
+    for (int v = 0; v < solver->vertical_count; v++) {
+        const DSLConstraint* constraint = &solver->vertical_constraints[v];
+        if (!vertical_constraint_holds(constraint, find_component(solver, constraint->component_a),
+                                       find_component(solver, constraint->component_b))) {
+            SOLVER_LOG(solver, "❌ %s(%s, %s) does not hold once the floors are laid out\n",
+                       vertical_name(constraint), constraint->component_a,
+                       constraint->component_b);
+            holds = 0;
+        }
+    }
+    return holds;
+}
+
+/**
+ * @brief Copies a floor solver's placements into the parent solver
+ */
+static void copy_floor_layout(LayoutSolver* solver, const LayoutSolver* sub,
+                              const int* source_index) {
+    for (int j = 0; j < sub->component_count; j++) {
+        Component* comp = &solver->components[source_index[j]];
+        comp->is_placed = sub->components[j].is_placed;
+        comp->placed_x = sub->components[j].placed_x;
+        comp->placed_y = sub->components[j].placed_y;
+        sync_placement_record(solver, comp);
+    }
+}
+
+static int solve_floor(LayoutSolver* solver, int floor);
+
+/**
+ * @brief Accept hook of a floor search: lays out the floors above on this layout
+ *
+ * A layout the floors above cannot be anchored on is rejected, and the
+ * floor's search backtracks into its next layout, up to
+ * FLOOR_LAYOUT_ATTEMPTS layouts.
+ */
+static int accept_floor_layout(LayoutSolver* sub, void* context) {
+    FloorSearch* search = context;
+    copy_floor_layout(search->solver, sub, search->source_index);
+    if (solve_floor(search->solver, search->floor + 1)) {
+        return 1;
+    }
+
+    search->layouts_rejected++;
+    if (search->layouts_rejected >= FLOOR_LAYOUT_ATTEMPTS || search->solver->memory_exhausted ||
+        search->solver->search_cancelled) {
+        // Stops the floor's search at its next node
+        search->gave_up = 1;
+        sub->node_limit = 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Searches one floor around its anchors, then the floors above it
+ * @return 1 if this floor and every floor above it have a layout
+ */
+static int solve_floor(LayoutSolver* solver, int floor) {
+    FloorSearch search = {.solver = solver, .floor = floor};
+    LayoutSolver* sub = create_floor_solver(solver, floor, search.source_index);
+    if (!sub) {
+        SOLVER_LOG(solver, "❌ Out of memory for floor %d\n", floor);
+        solver->memory_exhausted = 1;
+        return 0;
+    }
+    anchor_floor(solver, sub, floor);
+    if (floor + 1 < solver->floor_count) {
+        sub->accept_hook = accept_floor_layout;
+        sub->accept_context = &search;
+        // Workers would lay out the floors above concurrently into one parent
+        sub->search_threads = 0;
+    }
+
+    // An ABOVE root is tried at each position over its footprint until one
+    // gives a layout; a pinned root has a single start
+    int positions[MAX_ROOT_POSITIONS][2];
+    int position_count = footprint_root_positions(sub, positions);
+    int solved = 0;
+    int nodes = 0;
+    int tried = 0;
+    do {
+        if (position_count > 0) {
+            sub->root_x = positions[tried][0];
+            sub->root_y = positions[tried][1];
+            clear_all_placements(sub);
+        }
+        tried++;
+        solved = solve_constraints(sub);
+        if (search.gave_up) {
+            sub->search_cancelled = 0;
+        }
+        nodes += sub->tree_solver.nodes_created;
+        solver->tree_solver.nodes_created += sub->tree_solver.nodes_created;
+        solver->tree_solver.backtracks += sub->tree_solver.backtracks;
+        add_depth_stats(solver->tree_solver.depth_stats, sub->tree_solver.depth_stats, NULL);
+        solver->memory_exhausted |= sub->memory_exhausted;
+        solver->search_cancelled |= sub->search_cancelled;
+    } while (!solved && tried < position_count && !search.gave_up &&
+             !solver->memory_exhausted && !solver->search_cancelled);
+    if (solved) {
+        copy_floor_layout(solver, sub, search.source_index);
+    }
+
+    SOLVER_LOG(solver, "  🏢 Floor %d: %s, %d components, %d nodes", floor,
+               solved ? "solved" : "no layout", sub->component_count, nodes);
+    SOLVER_LOG(solver, position_count > 1 ? ", %d of %d root positions" : "", tried,
+               position_count);
+    SOLVER_LOG(solver, search.layouts_rejected > 0 ? ", %d layouts rejected by the floors above\n"
+                                                   : "\n", search.layouts_rejected);
+    if (floors_pooled(solver)) {
+        option_cache_detach_pooled(solver, sub);
+        memory_budget_release(solver->memory_budget, sizeof(LayoutSolver));
+    } else {
+        option_cache_detach_copy(solver, sub);
+        memory_budget_free(solver->memory_budget, sub, sizeof(LayoutSolver));
+    }
+    return solved;
+}
+
+int solve_floors(LayoutSolver* solver) {
+    solver->search_cancelled = 0;
+    solver->memory_exhausted = 0;
+    solver->tree_solver.root = NULL;
+    solver->tree_solver.current_node = NULL;
+    solver->tree_solver.nodes_created = 0;
+    solver->tree_solver.backtracks = 0;
+    memset(solver->tree_solver.depth_stats, 0, sizeof(solver->tree_solver.depth_stats));
+
+    if (!assign_floors(solver)) {
+        return 0;
+    }
+    SOLVER_LOG(solver, "🏢 Multi-floor spec: %d floors, solving them from the ground up\n",
+               solver->floor_count);
+    for (int i = 0; i < solver->component_count; i++) {
+        solver->components[i].is_placed = 0;
+        sync_placement_record(solver, &solver->components[i]);
+    }
+    // Sized before the first floor: floor solvers are in use while the floors above are built
+    if (floors_pooled(solver) &&
+        !arena_buffer_reserve(&solver->arena->floor_solvers,
+                              solver->floor_count * sizeof(LayoutSolver))) {
+        SOLVER_LOG(solver, "❌ Multi-floor solve failed: out of memory for %d floor solvers\n",
+                   solver->floor_count);
+        solver->memory_exhausted = 1;
+        return 0;
+    }
+
+    if (!solve_floor(solver, 0)) {
+        SOLVER_LOG(solver, "❌ Multi-floor solve failed: no floor layout the floors above "
+                   "could be anchored on\n");
+        return 0;
+    }
+    return verify_vertical_constraints(solver);
+}
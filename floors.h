@@ -0,0 +1,42 @@
+#ifndef FLOORS_H
+#define FLOORS_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// MULTI-FLOOR LAYOUTS
+// =============================================================================
+
+#define MAX_FLOORS MAX_COMPONENTS
+
+/**
+ * @brief Assigns every component a floor from the ABOVE/STAIRS constraints
+ *
+ * Breadth-first over the constraint graph: ADJACENT keeps both components on
+ * one floor, ABOVE/STAIRS put component A one floor above component B. Each
+ * connected group is shifted so its lowest floor is 0. Sets Component.floor
+ * and solver->floor_count.
+ *
+ * @param solver Parsed solver
+ * @return       1 on success, 0 if the constraints contradict each other
+ */
+int assign_floors(LayoutSolver* solver);
+
+/**
+ * @brief Solves a multi-floor spec, one 2D search per floor from the ground up
+ *
+ * Called by solve_constraints() when the spec has vertical constraints.
+ * Components only collide with components on their own floor, so each floor
+ * gets its own solver. Floors are searched in order, each one around the
+ * anchors the floor below fixes: STAIRS pins the upper stairwell onto the
+ * lower one, ABOVE keeps the upper component over the lower one's footprint.
+ * A floor layout the floors above cannot be built on is rejected and the
+ * floor's search backtracks into its next one. Every vertical constraint is
+ * verified against the finished layout.
+ *
+ * @param solver Parsed solver; receives the layout of every floor in world coordinates
+ * @return       1 if every floor solved and every vertical constraint holds
+ */
+int solve_floors(LayoutSolver* solver);
+
+#endif // FLOORS_H
@@ -0,0 +1,717 @@
+#include "layout_archive.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// =============================================================================
+// COMPRESSED LAYOUT ARCHIVE
+// =============================================================================
+// Solved layouts are worth keeping (caches, regression corpora, generated
+// content), but a rendered grid is mostly spaces and the same few tiles
+// repeat across every layout of a spec. Storing tile references once and
+// positions as small varints keeps a layout to a few dozen bytes, and the
+// mapped file serves random lookups without reading the rest of it.
+
+#define RLE_MIN_RUN 4                   // Shorter runs are cheaper as literals
+#define RLE_RUN_MARKER 0x00             // Never a grid cell: tiles cannot hold NUL
+#define TILE_NAME_MAX 63                // Component.name minus the NUL
+#define TILE_ENTRY_MAX (1 + TILE_NAME_MAX + 2 + MAX_TILE_SIZE * MAX_TILE_SIZE)
+#define RECORD_COMPONENT_MAX 16         // Varint tile ID, state byte, two varint offsets
+#define MAX_ARCHIVE_LAYOUT_SIDE 65536   // Larger bounds mark a malformed record
+
+struct LayoutArchiveWriter {
+    FILE* file;
+    uint64_t offset;                    // Bytes written so far
+    int failed;                         // A write failed; finish reports it
+
+    uint64_t* layout_offsets;
+    int layout_count;
+    size_t layout_capacity;
+
+    // Tile table: serialized entries, deduplicated through an open-addressing
+    // table of tile IDs (-1 = empty)
+    uint8_t* tiles;
+    size_t tiles_used;
+    size_t tiles_capacity;
+    size_t* tile_offsets;
+    int tile_count;
+    size_t tile_capacity;
+    int* slots;
+    size_t slot_count;                  // Power of two
+
+    uint8_t* record;                    // Encoding scratch, grown as needed
+    size_t record_capacity;
+    char* cells;                        // Rendered grid scratch for STORE_GRID
+    size_t cells_capacity;
+};
+
+struct LayoutArchive {
+    const uint8_t* data;
+    size_t size;
+    LayoutArchiveHeader header;
+    uint64_t records_end;               // Tile table start
+};
+
+// =============================
+// ENCODING HELPERS
+// =============================
+
+static size_t put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static uint64_t fnv1a(const uint8_t* data, size_t length) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Grows a buffer to hold at least needed elements
+ * @return 1 on success, 0 on allocation failure (the buffer is kept)
+ */
+static int ensure_capacity(void** buffer, size_t* capacity, size_t needed, size_t element_size) {
+    if (needed <= *capacity) {
+        return 1;
+    }
+    size_t grown = *capacity ? *capacity : 64;
+    while (grown < needed) {
+        grown *= 2;
+    }
+    void* resized = realloc(*buffer, grown * element_size);
+    if (!resized) {
+        return 0;
+    }
+    *buffer = resized;
+    *capacity = grown;
+    return 1;
+}
+
+// Tile entry: name length, name, width, height, width * height cells row by row
+static size_t tile_entry_length(const uint8_t* entry) {
+    size_t name_length = entry[0];
+    return 1 + name_length + 2 + (size_t)entry[1 + name_length] * entry[2 + name_length];
+}
+
+static size_t serialize_tile(const Component* comp, uint8_t* entry) {
+    size_t name_length = strnlen(comp->name, TILE_NAME_MAX);
+    size_t n = 0;
+    entry[n++] = (uint8_t)name_length;
+    memcpy(entry + n, comp->name, name_length);
+    n += name_length;
+    entry[n++] = (uint8_t)comp->width;
+    entry[n++] = (uint8_t)comp->height;
+    for (int r = 0; r < comp->height; r++) {
+        memcpy(entry + n, comp->ascii_tile[r], comp->width);
+        n += comp->width;
+    }
+    return n;
+}
+
+/**
+ * @brief Draws a tile's non-space cells; callers draw components from the
+ * last to the first so the first non-space tile wins, as in display_grid()
+ */
+static void paint_tile(char* grid, size_t row_stride, const char* cells, size_t tile_stride,
+                       int width, int height, int x, int y) {
+    for (int r = 0; r < height; r++) {
+        const char* source = cells + r * tile_stride;
+        char* target = grid + (size_t)(y + r) * row_stride + x;
+        for (int c = 0; c < width; c++) {
+            if (source[c] != ' ') {
+                target[c] = source[c];
+            }
+        }
+    }
+}
+
+static size_t rle_encode(const char* cells, size_t count, uint8_t* out) {
+    size_t n = 0;
+    for (size_t i = 0; i < count;) {
+        char ch = cells[i];
+        size_t run = 1;
+        while (i + run < count && cells[i + run] == ch) {
+            run++;
+        }
+        if (run >= RLE_MIN_RUN) {
+            out[n++] = RLE_RUN_MARKER;
+            out[n++] = (uint8_t)ch;
+            n += put_varint(out + n, run - RLE_MIN_RUN);
+        } else {
+            memset(out + n, ch, run);
+            n += run;
+        }
+        i += run;
+    }
+    return n;
+}
+
+// =============================
+// WRITER
+// =============================
+
+LayoutArchiveWriter* layout_archive_create(const char* path) {
+    LayoutArchiveWriter* writer = calloc(1, sizeof(LayoutArchiveWriter));
+    if (!writer) {
+        return NULL;
+    }
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        free(writer);
+        return NULL;
+    }
+
+    // Zeroed header: without the magic an unfinished file never opens
+    LayoutArchiveHeader header = {0};
+    writer->failed = fwrite(&header, sizeof(header), 1, writer->file) != 1;
+    writer->offset = sizeof(header);
+    return writer;
+}
+
+static int rehash_tiles(LayoutArchiveWriter* writer, size_t slot_count) {
+    int* slots = malloc(slot_count * sizeof(int));
+    if (!slots) {
+        return 0;
+    }
+    for (size_t s = 0; s < slot_count; s++) {
+        slots[s] = -1;
+    }
+    for (int t = 0; t < writer->tile_count; t++) {
+        const uint8_t* entry = writer->tiles + writer->tile_offsets[t];
+        size_t s = fnv1a(entry, tile_entry_length(entry)) & (slot_count - 1);
+        while (slots[s] >= 0) {
+            s = (s + 1) & (slot_count - 1);
+        }
+        slots[s] = t;
+    }
+    free(writer->slots);
+    writer->slots = slots;
+    writer->slot_count = slot_count;
+    return 1;
+}
+
+/**
+ * @brief ID of the component's tile in the tile table, added if new
+ * @return Tile ID, or -1 on allocation failure
+ */
+static int intern_tile(LayoutArchiveWriter* writer, const Component* comp) {
+    uint8_t entry[TILE_ENTRY_MAX];
+    size_t length = serialize_tile(comp, entry);
+
+    if ((size_t)(writer->tile_count + 1) * 2 > writer->slot_count &&
+        !rehash_tiles(writer, writer->slot_count ? writer->slot_count * 2 : 256)) {
+        return -1;
+    }
+    size_t mask = writer->slot_count - 1;
+    size_t s = fnv1a(entry, length) & mask;
+    for (; writer->slots[s] >= 0; s = (s + 1) & mask) {
+        const uint8_t* known = writer->tiles + writer->tile_offsets[writer->slots[s]];
+        if (tile_entry_length(known) == length && memcmp(known, entry, length) == 0) {
+            return writer->slots[s];
+        }
+    }
+
+    if (!ensure_capacity((void**)&writer->tiles, &writer->tiles_capacity,
+                         writer->tiles_used + length, 1) ||
+        !ensure_capacity((void**)&writer->tile_offsets, &writer->tile_capacity,
+                         writer->tile_count + 1, sizeof(size_t))) {
+        return -1;
+    }
+    memcpy(writer->tiles + writer->tiles_used, entry, length);
+    writer->tile_offsets[writer->tile_count] = writer->tiles_used;
+    writer->tiles_used += length;
+    writer->slots[s] = writer->tile_count;
+    return writer->tile_count++;
+}
+
+int layout_archive_append(LayoutArchiveWriter* writer, const LayoutSolver* solver, int flags) {
+    if (writer->failed) {
+        return -1;
+    }
+
+    // Bounds of the placed components, as display_grid() computes them
+    int min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+    int first = 1;
+    for (int i = 0; i < solver->component_count; i++) {
+        const PlacementRecord* rec = &solver->placements[i];
+        if (!rec->is_placed) {
+            continue;
+        }
+        if (first || rec->x < min_x) min_x = rec->x;
+        if (first || rec->y < min_y) min_y = rec->y;
+        if (first || rec->x + rec->width - 1 > max_x) max_x = rec->x + rec->width - 1;
+        if (first || rec->y + rec->height - 1 > max_y) max_y = rec->y + rec->height - 1;
+        first = 0;
+    }
+    int width = max_x - min_x + 1;
+    int height = max_y - min_y + 1;
+    int floor_count = solver->floor_count > 0 ? solver->floor_count : 1;
+    size_t cell_count = (size_t)floor_count * width * height;
+
+    int store_grid = (flags & LAYOUT_ARCHIVE_STORE_GRID) && cell_count > 0;
+    size_t needed = 64 + (size_t)solver->component_count * RECORD_COMPONENT_MAX +
+                    (store_grid ? 10 + cell_count : 0);
+    if (!ensure_capacity((void**)&writer->record, &writer->record_capacity, needed, 1)) {
+        return -1;
+    }
+
+    uint8_t* out = writer->record;
+    size_t n = 0;
+    n += put_varint(out + n, solver->component_count);
+    n += put_varint(out + n, floor_count);
+    out[n++] = store_grid ? LAYOUT_ARCHIVE_STORE_GRID : 0;
+    n += put_varint(out + n, zigzag_encode(min_x));
+    n += put_varint(out + n, zigzag_encode(min_y));
+    n += put_varint(out + n, width);
+    n += put_varint(out + n, height);
+    for (int i = 0; i < solver->component_count; i++) {
+        const Component* comp = &solver->components[i];
+        const PlacementRecord* rec = &solver->placements[i];
+        int tile = intern_tile(writer, comp);
+        if (tile < 0) {
+            return -1;
+        }
+        n += put_varint(out + n, tile);
+        out[n++] = (uint8_t)((comp->floor << 1) | (rec->is_placed ? 1 : 0));
+        if (rec->is_placed) {
+            n += put_varint(out + n, rec->x - min_x);
+            n += put_varint(out + n, rec->y - min_y);
+        }
+    }
+
+    if (store_grid) {
+        if (!ensure_capacity((void**)&writer->cells, &writer->cells_capacity, 2 * cell_count, 1)) {
+            return -1;
+        }
+        memset(writer->cells, ' ', cell_count);
+        for (int i = solver->component_count - 1; i >= 0; i--) {
+            const Component* comp = &solver->components[i];
+            const PlacementRecord* rec = &solver->placements[i];
+            if (rec->is_placed && comp->floor < floor_count) {
+                paint_tile(writer->cells + (size_t)comp->floor * width * height, width,
+                           &comp->ascii_tile[0][0], MAX_TILE_SIZE, rec->width, rec->height,
+                           rec->x - min_x, rec->y - min_y);
+            }
+        }
+        uint8_t* encoded = (uint8_t*)writer->cells + cell_count;
+        size_t encoded_length = rle_encode(writer->cells, cell_count, encoded);
+        n += put_varint(out + n, encoded_length);
+        memcpy(out + n, encoded, encoded_length);
+        n += encoded_length;
+    }
+
+    if (!ensure_capacity((void**)&writer->layout_offsets, &writer->layout_capacity,
+                         writer->layout_count + 1, sizeof(uint64_t))) {
+        return -1;
+    }
+    if (fwrite(out, 1, n, writer->file) != n) {
+        writer->failed = 1;
+        return -1;
+    }
+    writer->layout_offsets[writer->layout_count] = writer->offset;
+    writer->offset += n;
+    return writer->layout_count++;
+}
+
+int layout_archive_finish(LayoutArchiveWriter* writer) {
+    if (!writer) {
+        return 0;
+    }
+    int ok = !writer->failed;
+
+    LayoutArchiveHeader header = {0};
+    memcpy(header.magic, LAYOUT_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = LAYOUT_ARCHIVE_VERSION;
+    header.layout_count = (uint32_t)writer->layout_count;
+    header.tile_count = (uint32_t)writer->tile_count;
+
+    uint64_t tiles_start = writer->offset;
+    header.tile_index_offset = tiles_start + writer->tiles_used;
+    header.layout_index_offset = header.tile_index_offset + (uint64_t)writer->tile_count * 8;
+
+    if (ok && writer->tiles_used > 0) {
+        ok = fwrite(writer->tiles, 1, writer->tiles_used, writer->file) == writer->tiles_used;
+    }
+    for (int t = 0; ok && t < writer->tile_count; t++) {
+        uint64_t offset = tiles_start + writer->tile_offsets[t];
+        ok = fwrite(&offset, sizeof(offset), 1, writer->file) == 1;
+    }
+    if (ok && writer->layout_count > 0) {
+        ok = fwrite(writer->layout_offsets, sizeof(uint64_t), writer->layout_count,
+                    writer->file) == (size_t)writer->layout_count;
+    }
+    if (ok) {
+        ok = fseek(writer->file, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, writer->file) == 1;
+    }
+    if (fclose(writer->file) != 0) {
+        ok = 0;
+    }
+
+    free(writer->layout_offsets);
+    free(writer->tiles);
+    free(writer->tile_offsets);
+    free(writer->slots);
+    free(writer->record);
+    free(writer->cells);
+    free(writer);
+    return ok;
+}
+
+// =============================
+// READER
+// =============================
+
+typedef struct Cursor {
+    const uint8_t* p;
+    const uint8_t* end;
+    int ok;                             // Cleared by a read past the end
+} Cursor;
+
+static uint64_t read_varint(Cursor* cursor) {
+    uint64_t value = 0;
+    for (int shift = 0; cursor->p < cursor->end && shift < 64; shift += 7) {
+        uint8_t byte = *cursor->p++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    cursor->ok = 0;
+    return 0;
+}
+
+static uint8_t read_byte(Cursor* cursor) {
+    if (cursor->p >= cursor->end) {
+        cursor->ok = 0;
+        return 0;
+    }
+    return *cursor->p++;
+}
+
+static uint64_t read_offset(const LayoutArchive* archive, uint64_t index_offset, int i) {
+    uint64_t offset;
+    memcpy(&offset, archive->data + index_offset + (uint64_t)i * 8, sizeof(offset));
+    return offset;
+}
+
+LayoutArchive* layout_archive_open(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LayoutArchiveHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the file
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    LayoutArchive* archive = malloc(sizeof(LayoutArchive));
+    if (!archive) {
+        munmap(data, size);
+        return NULL;
+    }
+    archive->data = data;
+    archive->size = size;
+    memcpy(&archive->header, data, sizeof(LayoutArchiveHeader));
+
+    const LayoutArchiveHeader* header = &archive->header;
+    uint64_t tile_index_end = header->tile_index_offset + (uint64_t)header->tile_count * 8;
+    int valid = memcmp(header->magic, LAYOUT_ARCHIVE_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == LAYOUT_ARCHIVE_VERSION &&
+                header->tile_index_offset <= size && tile_index_end <= size &&
+                header->layout_index_offset <= size &&
+                (size - header->layout_index_offset) / 8 >= header->layout_count;
+    if (valid) {
+        archive->records_end = header->tile_count > 0
+                                   ? read_offset(archive, header->tile_index_offset, 0)
+                                   : header->tile_index_offset;
+        valid = archive->records_end >= sizeof(LayoutArchiveHeader) &&
+                archive->records_end <= header->tile_index_offset;
+    }
+    if (!valid) {
+        layout_archive_close(archive);
+        return NULL;
+    }
+    return archive;
+}
+
+void layout_archive_close(LayoutArchive* archive) {
+    if (!archive) {
+        return;
+    }
+    munmap((void*)archive->data, archive->size);
+    free(archive);
+}
+
+const LayoutArchiveHeader* layout_archive_header(const LayoutArchive* archive) {
+    return &archive->header;
+}
+
+size_t layout_archive_size(const LayoutArchive* archive) {
+    return archive->size;
+}
+
+/**
+ * @brief Reads a record's header fields; the cursor is left at its components
+ */
+static int open_record(const LayoutArchive* archive, int id, LayoutArchiveInfo* info,
+                       Cursor* cursor) {
+    const LayoutArchiveHeader* header = &archive->header;
+    if (id < 0 || (uint32_t)id >= header->layout_count) {
+        return 0;
+    }
+    uint64_t start = read_offset(archive, header->layout_index_offset, id);
+    uint64_t end = (uint32_t)id + 1 < header->layout_count
+                       ? read_offset(archive, header->layout_index_offset, id + 1)
+                       : archive->records_end;
+    if (start < sizeof(LayoutArchiveHeader) || start > end || end > archive->records_end) {
+        return 0;
+    }
+    cursor->p = archive->data + start;
+    cursor->end = archive->data + end;
+    cursor->ok = 1;
+
+    uint64_t component_count = read_varint(cursor);
+    uint64_t floor_count = read_varint(cursor);
+    uint8_t flags = read_byte(cursor);
+    int64_t min_x = zigzag_decode(read_varint(cursor));
+    int64_t min_y = zigzag_decode(read_varint(cursor));
+    uint64_t width = read_varint(cursor);
+    uint64_t height = read_varint(cursor);
+    if (!cursor->ok || component_count > MAX_COMPONENTS || floor_count < 1 ||
+        floor_count > MAX_COMPONENTS || width > MAX_ARCHIVE_LAYOUT_SIDE ||
+        height > MAX_ARCHIVE_LAYOUT_SIDE || min_x < INT32_MIN || min_x > INT32_MAX ||
+        min_y < INT32_MIN || min_y > INT32_MAX) {
+        return 0;
+    }
+
+    info->component_count = (int)component_count;
+    info->floor_count = (int)floor_count;
+    info->width = (int)width;
+    info->height = (int)height;
+    info->min_x = (int)min_x;
+    info->min_y = (int)min_y;
+    info->has_grid = (flags & LAYOUT_ARCHIVE_STORE_GRID) != 0;
+    info->record_bytes = (size_t)(end - start);
+    return 1;
+}
+
+/**
+ * @brief Tile table entry by ID, NULL if out of range or truncated
+ */
+static const uint8_t* tile_entry(const LayoutArchive* archive, uint64_t tile) {
+    const LayoutArchiveHeader* header = &archive->header;
+    if (tile >= header->tile_count) {
+        return NULL;
+    }
+    uint64_t offset = read_offset(archive, header->tile_index_offset, (int)tile);
+    if (offset < archive->records_end || offset + 3 > header->tile_index_offset) {
+        return NULL;
+    }
+    const uint8_t* entry = archive->data + offset;
+    if (entry[0] > TILE_NAME_MAX || offset + 3 + entry[0] > header->tile_index_offset) {
+        return NULL;
+    }
+    uint8_t width = entry[1 + entry[0]];
+    uint8_t height = entry[2 + entry[0]];
+    if (width > MAX_TILE_SIZE || height > MAX_TILE_SIZE ||
+        offset + tile_entry_length(entry) > header->tile_index_offset) {
+        return NULL;
+    }
+    return entry;
+}
+
+typedef struct ArchivedComponent {
+    const uint8_t* tile;                // Tile table entry
+    int is_placed;
+    int floor;
+    int x, y;                           // Relative to the layout bounds
+} ArchivedComponent;
+
+/**
+ * @brief Decodes the component list and checks every placed tile lies inside the bounds
+ */
+static int read_components(const LayoutArchive* archive, const LayoutArchiveInfo* info,
+                           Cursor* cursor, ArchivedComponent* components) {
+    for (int i = 0; i < info->component_count; i++) {
+        ArchivedComponent* comp = &components[i];
+        comp->tile = tile_entry(archive, read_varint(cursor));
+        uint8_t state = read_byte(cursor);
+        comp->is_placed = state & 1;
+        comp->floor = state >> 1;
+        comp->x = comp->y = 0;
+        if (comp->is_placed) {
+            uint64_t x = read_varint(cursor);
+            uint64_t y = read_varint(cursor);
+            if (!comp->tile || x > (uint64_t)info->width || y > (uint64_t)info->height) {
+                return 0;
+            }
+            comp->x = (int)x;
+            comp->y = (int)y;
+            const uint8_t* sizes = comp->tile + 1 + comp->tile[0];
+            if (comp->floor >= info->floor_count || comp->x + sizes[0] > info->width ||
+                comp->y + sizes[1] > info->height) {
+                return 0;
+            }
+        }
+        if (!cursor->ok || !comp->tile) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int layout_archive_info(const LayoutArchive* archive, int id, LayoutArchiveInfo* info) {
+    Cursor cursor;
+    return open_record(archive, id, info, &cursor);
+}
+
+/**
+ * @brief Expands the stored RLE grid, adding a '\n' after every row
+ */
+static int decode_grid(Cursor* cursor, const LayoutArchiveInfo* info, char* out) {
+    uint64_t encoded_length = read_varint(cursor);
+    if (!cursor->ok || encoded_length > (uint64_t)(cursor->end - cursor->p)) {
+        return 0;
+    }
+    Cursor rle = { cursor->p, cursor->p + encoded_length, 1 };
+    size_t remaining = (size_t)info->floor_count * info->width * info->height;
+    int column = 0;
+    while (rle.p < rle.end) {
+        uint8_t ch = read_byte(&rle);
+        size_t run = 1;
+        if (ch == RLE_RUN_MARKER) {
+            ch = read_byte(&rle);
+            run = (size_t)read_varint(&rle) + RLE_MIN_RUN;
+        }
+        if (!rle.ok || run > remaining) {
+            return 0;
+        }
+        remaining -= run;
+        while (run > 0) {
+            size_t span = (size_t)(info->width - column);
+            if (span > run) {
+                span = run;
+            }
+            memset(out, ch, span);
+            out += span;
+            column += (int)span;
+            run -= span;
+            if (column == info->width) {
+                *out++ = '\n';
+                column = 0;
+            }
+        }
+    }
+    return remaining == 0;
+}
+
+size_t layout_archive_render(const LayoutArchive* archive, int id, char* buffer, size_t size) {
+    LayoutArchiveInfo info;
+    Cursor cursor;
+    if (!open_record(archive, id, &info, &cursor)) {
+        return 0;
+    }
+    size_t row_stride = (size_t)info.width + 1;
+    size_t needed = (size_t)info.floor_count * info.height * row_stride + 1;
+    if (!buffer || size < needed) {
+        return needed;
+    }
+
+    ArchivedComponent components[MAX_COMPONENTS];
+    if (!read_components(archive, &info, &cursor, components)) {
+        return 0;
+    }
+    if (info.has_grid) {
+        if (!decode_grid(&cursor, &info, buffer)) {
+            return 0;
+        }
+    } else {
+        memset(buffer, ' ', needed - 1);
+        for (size_t row = 0; row < (size_t)info.floor_count * info.height; row++) {
+            buffer[row * row_stride + info.width] = '\n';
+        }
+        for (int i = info.component_count - 1; i >= 0; i--) {
+            const ArchivedComponent* comp = &components[i];
+            if (!comp->is_placed) {
+                continue;
+            }
+            const uint8_t* tile = comp->tile;
+            int name_length = tile[0];
+            int width = tile[1 + name_length];
+            int height = tile[2 + name_length];
+            paint_tile(buffer + (size_t)comp->floor * info.height * row_stride, row_stride,
+                       (const char*)tile + 3 + name_length, width, width, height, comp->x,
+                       comp->y);
+        }
+    }
+    buffer[needed - 1] = '\0';
+    return needed;
+}
+
+int layout_archive_load(const LayoutArchive* archive, int id, LayoutSolver* solver) {
+    LayoutArchiveInfo info;
+    Cursor cursor;
+    ArchivedComponent components[MAX_COMPONENTS];
+    if (!open_record(archive, id, &info, &cursor) ||
+        !read_components(archive, &info, &cursor, components)) {
+        return 0;
+    }
+
+    reset_solver(solver, 60, 40);
+    for (int i = 0; i < info.component_count; i++) {
+        const uint8_t* tile = components[i].tile;
+        int name_length = tile[0];
+        int width = tile[1 + name_length];
+        int height = tile[2 + name_length];
+        const char* cells = (const char*)tile + 3 + name_length;
+
+        // Every row keeps its '\n' so blank rows and trailing blanks survive
+        char text[MAX_TILE_SIZE * (MAX_TILE_SIZE + 1) + 1];
+        size_t n = 0;
+        for (int r = 0; r < height; r++) {
+            memcpy(text + n, cells + r * width, width);
+            n += width;
+            text[n++] = '\n';
+        }
+        text[n] = '\0';
+
+        Component* comp = &solver->components[i];
+        memcpy(comp->name, tile + 1, name_length);
+        comp->name[name_length] = '\0';
+        set_component_tile(solver, i, text);
+        solver->component_count = i + 1;
+
+        comp->is_placed = components[i].is_placed;
+        comp->floor = components[i].floor;
+        comp->placed_x = info.min_x + components[i].x;
+        comp->placed_y = info.min_y + components[i].y;
+        sync_placement_record(solver, comp);
+    }
+    solver->floor_count = info.floor_count;
+    return 1;
+}
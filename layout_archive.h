@@ -0,0 +1,145 @@
+#ifndef LAYOUT_ARCHIVE_H
+#define LAYOUT_ARCHIVE_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// COMPRESSED LAYOUT ARCHIVE
+// =============================================================================
+//
+// One file holds any number of solved layouts, addressed by the ID
+// layout_archive_append() returned (0, 1, 2, ... in append order):
+//
+//   header | layout records ... | tile table | tile index | layout index
+//
+// A record stores each component as a reference into the archive-wide tile
+// table (name and shape, stored once however many layouts use it) plus its
+// position relative to the layout's bounds, all as varints: a few bytes per
+// component instead of the rendered grid. The rendered grid can be stored
+// as well (LAYOUT_ARCHIVE_STORE_GRID), run-length encoded; spaces and
+// repeated wall glyphs collapse into 3-byte runs. Integers are stored in
+// the writer's byte order.
+//
+// The reader maps the file and decodes straight from the mapping: opening
+// an archive reads only the header, and a lookup by ID is one index read
+// plus one record.
+
+#define LAYOUT_ARCHIVE_MAGIC "LAYARCH1"
+#define LAYOUT_ARCHIVE_VERSION 1
+
+#define LAYOUT_ARCHIVE_STORE_GRID 0x01  // Also store the RLE-compressed rendered grid
+
+typedef struct LayoutArchiveWriter LayoutArchiveWriter;
+typedef struct LayoutArchive LayoutArchive;
+
+typedef struct LayoutArchiveHeader {
+    char magic[8];                      // LAYOUT_ARCHIVE_MAGIC, set once the file is complete
+    uint32_t version;
+    uint32_t layout_count;
+    uint32_t tile_count;
+    uint32_t reserved;
+    uint64_t tile_index_offset;         // tile_count uint64 file offsets
+    uint64_t layout_index_offset;       // layout_count uint64 file offsets
+} LayoutArchiveHeader;
+
+typedef struct LayoutArchiveInfo {
+    int component_count;
+    int floor_count;
+    int width, height;                  // Bounds of the placed components
+    int min_x, min_y;                   // World position of the bounds
+    int has_grid;                       // Record carries the rendered grid
+    size_t record_bytes;                // Encoded size of the record
+} LayoutArchiveInfo;
+
+/**
+ * @brief Creates (or truncates) an archive file for writing
+ * @param path Archive file
+ * @return     New writer, or NULL if the file cannot be created
+ */
+LayoutArchiveWriter* layout_archive_create(const char* path);
+
+/**
+ * @brief Appends the solver's current layout
+ *
+ * Stores the components (tiles through the tile table), their placements
+ * and the floor count; constraints are not stored.
+ *
+ * @param writer Open writer
+ * @param solver Solver holding a layout (typically after a successful solve)
+ * @param flags  LAYOUT_ARCHIVE_STORE_GRID or 0
+ * @return       Layout ID, or -1 on write or allocation failure
+ */
+int layout_archive_append(LayoutArchiveWriter* writer, const LayoutSolver* solver, int flags);
+
+/**
+ * @brief Writes the tile table and indexes, closes the file and frees the writer
+ * @param writer Writer to finish, may be NULL
+ * @return       1 on success, 0 if the archive could not be completed
+ */
+int layout_archive_finish(LayoutArchiveWriter* writer);
+
+/**
+ * @brief Maps an archive for reading
+ * @param path Archive file
+ * @return     Open archive, or NULL if the file is missing, unfinished or malformed
+ */
+LayoutArchive* layout_archive_open(const char* path);
+
+/**
+ * @brief Unmaps the archive
+ * @param archive Archive to close, may be NULL
+ */
+void layout_archive_close(LayoutArchive* archive);
+
+/**
+ * @brief Archive header, for counts and sizes
+ */
+const LayoutArchiveHeader* layout_archive_header(const LayoutArchive* archive);
+
+/**
+ * @brief Size of the mapped file in bytes
+ */
+size_t layout_archive_size(const LayoutArchive* archive);
+
+/**
+ * @brief Reads a record's summary without decoding its components
+ * @param archive Open archive
+ * @param id      Layout ID
+ * @param info    Receives the summary
+ * @return        1 on success, 0 if the ID is out of range or the record is malformed
+ */
+int layout_archive_info(const LayoutArchive* archive, int id, LayoutArchiveInfo* info);
+
+/**
+ * @brief Renders a layout into a caller buffer
+ *
+ * The text is every floor from the ground up, each floor height rows of
+ * width characters and a '\n', NUL-terminated: the cells display_grid()
+ * prints, without its truncation. A stored grid is decompressed, otherwise
+ * the tiles are drawn from the tile table. Nothing is allocated.
+ *
+ * @param archive Open archive
+ * @param id      Layout ID
+ * @param buffer  Receives the text, may be NULL to query the size
+ * @param size    Size of buffer
+ * @return        Bytes needed including the NUL (nothing is written when
+ *                size is smaller), 0 if the ID is out of range or the record
+ *                is malformed
+ */
+size_t layout_archive_render(const LayoutArchive* archive, int id, char* buffer, size_t size);
+
+/**
+ * @brief Restores a layout's components and placements into a solver
+ *
+ * The solver is reset first (reset_solver()) and then holds the stored
+ * components, tiles, placements and floor count, enough for display_grid()
+ * and for reuse as a cached result. It holds no constraints.
+ *
+ * @param archive Open archive
+ * @param id      Layout ID
+ * @param solver  Initialized solver
+ * @return        1 on success, 0 if the ID is out of range or the record is malformed
+ */
+int layout_archive_load(const LayoutArchive* archive, int id, LayoutSolver* solver);
+
+#endif // LAYOUT_ARCHIVE_H
@@ -19,7 +19,7 @@ size_t WriteCallback(void *contents, size_t size, size_t nmemb, struct APIRespon
 }
 
 // =============================================================================
-// DSL PROMPT GENERATION
+// SPECIFICATION PROMPT GENERATION
 // =============================================================================
 
 void generate_dsl_prompt(const char* structure_type, char* system_prompt, char* user_prompt) {
@@ -32,20 +32,18 @@ void generate_dsl_prompt(const char* structure_type, char* system_prompt, char*
         "2. Spatial and functional constraints\n"
         "3. Self-contained ASCII components (tiles) to be assembled later by an external constraint solver\n\n"
         "🧱 Step 1: Identify Core Components\n\n"
-        "List and briefly describe the individual components that make up the structure using the format:\n"
-        "**ComponentName** - Description with function, scale, and notable features.\n\n"
-        "Use this EXACT format: **Name** - description text\n"
-        "Do NOT use numbered lists or bullet points in the Components section.\n\n"
-        "🧭 Step 2: Define Spatial Constraints (DSL)\n\n"
-        "Generate spatial constraints using EXACTLY this format:\n"
-        "ADJACENT(ComponentA, ComponentB, direction)\n\n"
-        "Do NOT use bullet points or dashes. Write each constraint on its own line.\n"
-        "Direction must be: n, e, s, w, or a (for any)\n\n"
+        "List the individual components that make up the structure, each with a short name\n"
+        "(letters, digits and underscores only) and a description of its function, scale and notable features.\n\n"
+        "🧭 Step 2: Define Spatial Constraints\n\n"
+        "Each constraint places component a next to component b.\n"
+        "Direction is the axis along which a and b touch: n or s puts one directly above the other,\n"
+        "e or w puts one directly beside the other, a allows any side. Which of the two ends up\n"
+        "on which side is left to the solver, so n and s (or e and w) for the same pair mean the same.\n"
+        "Only use component names from Step 1.\n\n"
         "🧩 Step 3: Generate Individual ASCII Components\n\n"
         "For each component identified in Step 1:\n"
-        "- Output a standalone ASCII block representing that space\n"
+        "- Output a standalone ASCII tile representing that space, at most 20 rows of at most 20 characters\n"
         "- Use only characters from the symbol library below\n"
-        "- Each component must be self-contained and enclosed in a code block\n"
         "- Contain no words\n"
         "- Reflect the function and any notable features\n\n"
         "🔠 Symbol Library (Expanded and Refined)\n\n"
@@ -79,52 +77,91 @@ void generate_dsl_prompt(const char* structure_type, char* system_prompt, char*
         "f - Flag / Banner / Hanging Cloth\n"
         ": - Lamp / Light Source / Torch\n\n"
         "✅ Output Format\n\n"
-        "Organize your output into:\n"
-        "## Components – Component list with descriptions\n"
-        "## Constraints – DSL format only\n"
-        "## Component Tiles – One ASCII tile per component (code block)\n\n"
-        "Do not generate or describe the final assembled layout.",
+        "Respond with a single JSON object and nothing else:\n"
+        "{\"components\": [{\"name\": \"Keep\", \"description\": \"...\", "
+        "\"tile\": [\"XXXXX\", \"X...X\", \"XXXXX\"]}],\n"
+        " \"constraints\": [{\"type\": \"ADJACENT\", \"a\": \"Courtyard\", \"b\": \"Keep\", "
+        "\"direction\": \"n\"}]}\n"
+        "Each tile is an array of row strings. Do not generate or describe the final assembled layout.",
         structure_type);
 
     snprintf(user_prompt, 1024,
-        "Generate a detailed specification for a %s structure using the DSL format described above. "
+        "Generate a detailed specification for a %s structure as the JSON object described above. "
         "Focus on creating modular, well-defined components with clear spatial relationships. "
-        "Ensure all constraints use proper DSL syntax and that ASCII tiles are detailed and distinctive. "
-        "Return only the structured output with Components, Constraints, and Component Tiles sections.",
+        "Ensure every constraint names declared components and that ASCII tiles are detailed and distinctive.",
         structure_type);
 }
 
+void generate_repair_prompt(const char* specification, const char* diagnosis, char* system_prompt,
+                            size_t system_size, char* user_prompt, size_t user_size) {
+    snprintf(system_prompt, system_size,
+        "🩹 ASCII Structure Specification Repair\n\n"
+        "You wrote the JSON structure specification below. Parsing or solving it failed; "
+        "the diagnosis lists what the parser and the constraint solver found.\n\n"
+        "Do NOT rewrite the specification. Respond with a single JSON patch object and nothing else:\n"
+        "{\"constraints\": [{\"type\": \"ADJACENT\", \"a\": \"Courtyard\", \"b\": \"Keep\", "
+        "\"direction\": \"n\"}],\n"
+        " \"tiles\": [{\"name\": \"Keep\", \"tile\": [\"XXXXX\", \"X...X\", \"XXXXX\"]}]}\n\n"
+        "- \"constraints\", if present, replaces the whole constraint list: repeat the constraints that are fine.\n"
+        "- \"tiles\" lists only the tiles you change; a name that is not declared yet adds that component.\n"
+        "- Leave out a key you do not need.\n"
+        "- Direction is the axis along which a and b touch: n or s (one above the other), "
+        "e or w (one beside the other), or a (any side); the solver picks which side each is on.\n"
+        "- Tiles are at most 20 rows of at most 20 characters, using the same symbols as before.\n"
+        "Fix every problem in the diagnosis with as few changes as possible.");
+
+    snprintf(user_prompt, user_size,
+        "Specification:\n%s\n\nDiagnosis:\n%s\nRespond with the JSON patch.",
+        specification, diagnosis);
+}
+
 // =============================================================================
 // MAIN LLM API FUNCTION
 // =============================================================================
 
-int generate_structure_specification(const char* structure_type, char* output_buffer, size_t buffer_size) {
+/**
+ * @brief Sends one JSON-mode chat completion and extracts the reply texts
+ *
+ * Asks for `choices` independent replies to the same prompt (the API's `n`
+ * parameter); reply i goes to output_buffers + i * buffer_size. A buffer
+ * whose reply holds no content is left untouched.
+ *
+ * @return Number of replies extracted, or -1 on transport failure
+ */
+static int request_chat_completion(const char* system_prompt, const char* user_prompt, int max_tokens,
+                                   int choices, char* output_buffers, size_t buffer_size) {
     CURL *curl;
     CURLcode res;
     struct APIResponse response = {0};
+    int extracted = 0;
 
     curl = curl_easy_init();
     if (!curl) {
         fprintf(stderr, "Failed to initialize curl\n");
-        return 1;
+        return -1;
     }
 
     // Prepare API request
     cJSON *root = cJSON_CreateObject();
-    cJSON *model = cJSON_CreateString("gpt-4");
+    // JSON mode needs a model that supports response_format
+    cJSON *model = cJSON_CreateString("gpt-4o");
     cJSON *messages = cJSON_CreateArray();
     cJSON *temperature = cJSON_CreateNumber(0.7);
-    cJSON *max_tokens = cJSON_CreateNumber(2000);
+    cJSON *max_tokens_item = cJSON_CreateNumber(max_tokens);
 
     cJSON_AddItemToObject(root, "model", model);
     cJSON_AddItemToObject(root, "messages", messages);
     cJSON_AddItemToObject(root, "temperature", temperature);
-    cJSON_AddItemToObject(root, "max_tokens", max_tokens);
+    cJSON_AddItemToObject(root, "max_tokens", max_tokens_item);
+    if (choices > 1) {
+        // Prompt tokens and request latency are paid once for all variants
+        cJSON_AddNumberToObject(root, "n", choices);
+    }
 
-    // Generate prompts
-    char system_prompt[4096];
-    char user_prompt[1024];
-    generate_dsl_prompt(structure_type, system_prompt, user_prompt);
+    // JSON mode: the reply is always one parseable JSON object, which
+    // parse_specification_string() recognises and parses in a single pass
+    cJSON *response_format = cJSON_AddObjectToObject(root, "response_format");
+    cJSON_AddStringToObject(response_format, "type", "json_object");
 
     // System message
     cJSON *sys = cJSON_CreateObject();
@@ -158,7 +195,6 @@ int generate_structure_specification(const char* structure_type, char* output_bu
     curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L); // 10 second connection timeout
 
     // Make the API call
-    printf("Generating %s structure specification...\n", structure_type);
     res = curl_easy_perform(curl);
 
     // Cleanup
@@ -169,7 +205,7 @@ int generate_structure_specification(const char* structure_type, char* output_bu
     if (res != CURLE_OK) {
         fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
         if (response.data) free(response.data);
-        return 1;
+        return -1;
     }
 
     // Parse response
@@ -177,18 +213,29 @@ int generate_structure_specification(const char* structure_type, char* output_bu
         printf("📥 Received API response (%zu bytes)\n", response.size);
         cJSON *json = cJSON_Parse(response.data);
         if (json) {
-            cJSON *choices = cJSON_GetObjectItem(json, "choices");
-            if (choices && cJSON_GetArraySize(choices) > 0) {
-                cJSON *first_choice = cJSON_GetArrayItem(choices, 0);
-                cJSON *message = cJSON_GetObjectItem(first_choice, "message");
-                cJSON *content = cJSON_GetObjectItem(message, "content");
-
-                if (content && cJSON_IsString(content)) {
-                    strncpy(output_buffer, content->valuestring, buffer_size - 1);
-                    output_buffer[buffer_size - 1] = '\0';
-                    printf("✅ Successfully extracted DSL content (%zu bytes)\n", strlen(output_buffer));
-                } else {
-                    printf("❌ No content found in API response\n");
+            cJSON *reply_choices = cJSON_GetObjectItem(json, "choices");
+            if (reply_choices && cJSON_GetArraySize(reply_choices) > 0) {
+                int position = 0;
+                cJSON *choice;
+                cJSON_ArrayForEach(choice, reply_choices) {
+                    // Choices carry their index; fall back to array order
+                    cJSON *index = cJSON_GetObjectItem(choice, "index");
+                    int slot = cJSON_IsNumber(index) ? index->valueint : position;
+                    position++;
+                    cJSON *message = cJSON_GetObjectItem(choice, "message");
+                    cJSON *content = cJSON_GetObjectItem(message, "content");
+
+                    if (slot < 0 || slot >= choices) {
+                        continue;
+                    }
+                    if (content && cJSON_IsString(content)) {
+                        char *output_buffer = output_buffers + (size_t)slot * buffer_size;
+                        strncpy(output_buffer, content->valuestring, buffer_size - 1);
+                        output_buffer[buffer_size - 1] = '\0';
+                        extracted++;
+                    } else {
+                        printf("❌ No content found in API response choice %d\n", slot);
+                    }
                 }
             } else {
                 printf("❌ No choices found in API response\n");
@@ -202,5 +249,73 @@ int generate_structure_specification(const char* structure_type, char* output_bu
         printf("❌ No response data received\n");
     }
 
+    return extracted;
+}
+
+int generate_structure_specification(const char* structure_type, char* output_buffer, size_t buffer_size) {
+    // Generate prompts
+    char system_prompt[4096];
+    char user_prompt[1024];
+    generate_dsl_prompt(structure_type, system_prompt, user_prompt);
+
+    printf("Generating %s structure specification...\n", structure_type);
+    if (request_chat_completion(system_prompt, user_prompt, SPEC_GENERATION_MAX_TOKENS, 1,
+                                output_buffer, buffer_size) < 0) {
+        return 1;
+    }
+    if (output_buffer[0] != '\0') {
+        printf("✅ Successfully extracted specification (%zu bytes)\n", strlen(output_buffer));
+    }
+    return 0;
+}
+
+int request_specification_repair(const char* specification, const char* diagnosis, char* patch_buffer,
+                                 size_t buffer_size) {
+    // The spec is echoed back in the user message, so size that from the input
+    char system_prompt[2048];
+    size_t user_size = strlen(specification) + strlen(diagnosis) + 256;
+    char *user_prompt = malloc(user_size);
+    if (!user_prompt) {
+        fprintf(stderr, "Failed to allocate repair prompt\n");
+        return 1;
+    }
+    generate_repair_prompt(specification, diagnosis, system_prompt, sizeof(system_prompt),
+                           user_prompt, user_size);
+
+    printf("🩹 Requesting a specification patch...\n");
+    patch_buffer[0] = '\0';
+    int replies = request_chat_completion(system_prompt, user_prompt, SPEC_REPAIR_MAX_TOKENS, 1,
+                                          patch_buffer, buffer_size);
+    free(user_prompt);
+    if (replies < 1) {
+        return 1;
+    }
+    printf("✅ Received patch (%zu bytes)\n", strlen(patch_buffer));
     return 0;
-}
\ No newline at end of file
+}
+
+int generate_structure_variants(const char* structure_type, int variants, char* output_buffers,
+                                size_t buffer_size) {
+    if (variants < 1) {
+        return 0;
+    }
+    if (variants > LLM_MAX_VARIANTS) {
+        variants = LLM_MAX_VARIANTS;
+    }
+    for (int i = 0; i < variants; i++) {
+        output_buffers[(size_t)i * buffer_size] = '\0';
+    }
+
+    char system_prompt[4096];
+    char user_prompt[1024];
+    generate_dsl_prompt(structure_type, system_prompt, user_prompt);
+
+    printf("Generating %d %s structure specifications in one request...\n", variants, structure_type);
+    int replies = request_chat_completion(system_prompt, user_prompt, SPEC_GENERATION_MAX_TOKENS,
+                                          variants, output_buffers, buffer_size);
+    if (replies < 0) {
+        return -1;
+    }
+    printf("✅ Successfully extracted %d of %d specifications\n", replies, variants);
+    return replies;
+}
@@ -11,6 +11,10 @@
 // LLM API INTEGRATION
 // =============================================================================
 
+#define SPEC_GENERATION_MAX_TOKENS 2000 // Reply budget of a full specification
+#define SPEC_REPAIR_MAX_TOKENS 800      // Reply budget of a repair patch
+#define LLM_MAX_VARIANTS 8              // Specifications requested in one call at most
+
 /**
  * @brief Container for HTTP response data from API calls
  * 
@@ -44,13 +48,31 @@ size_t WriteCallback(void *contents, size_t size, size_t nmemb, struct APIRespon
 // =============================
 
 /**
- * @brief Generates system and user prompts for DSL specification generation
+ * @brief Generates system and user prompts for JSON specification generation
+ *
+ * The prompts ask for the components/constraints/tiles object accepted by
+ * parse_specification_json(); the request runs in JSON mode.
  * @param structure_type Type of structure to generate (castle, village, etc.)
  * @param system_prompt  Buffer to store system prompt
  * @param user_prompt    Buffer to store user prompt
  */
 void generate_dsl_prompt(const char* structure_type, char* system_prompt, char* user_prompt);
 
+/**
+ * @brief Generates system and user prompts asking for a repair patch
+ *
+ * The reply is the patch object accepted by merge_specification_patch() and
+ * apply_specification_patch(), not a new specification.
+ * @param specification Failing JSON specification, echoed in the user prompt
+ * @param diagnosis     Problems found by the parser or the solver
+ * @param system_prompt Buffer to store system prompt
+ * @param system_size   Size of system_prompt
+ * @param user_prompt   Buffer to store user prompt
+ * @param user_size     Size of user_prompt
+ */
+void generate_repair_prompt(const char* specification, const char* diagnosis, char* system_prompt,
+                            size_t system_size, char* user_prompt, size_t user_size);
+
 // =============================
 // LLM API INTERFACE
 // =============================
@@ -73,4 +95,36 @@ void generate_dsl_prompt(const char* structure_type, char* system_prompt, char*
  */
 int generate_structure_specification(const char* structure_type, char* output_buffer, size_t buffer_size);
 
+/**
+ * @brief Generates several independent specifications in one API request
+ *
+ * Uses the chat API's `n` parameter, so the prompt is sent and billed once
+ * and all variants arrive with one round trip instead of one call each.
+ * Variant i is written to output_buffers + i * buffer_size; a variant the
+ * reply did not fill is left as an empty string.
+ *
+ * @param structure_type Type of structure (castle, village, dungeon, etc.)
+ * @param variants       Number of specifications (capped at LLM_MAX_VARIANTS)
+ * @param output_buffers variants consecutive buffers of buffer_size bytes
+ * @param buffer_size    Size of each buffer
+ * @return               Number of specifications received, -1 on request failure
+ */
+int generate_structure_variants(const char* structure_type, int variants, char* output_buffers,
+                                size_t buffer_size);
+
+/**
+ * @brief Asks for a patch to the constraint or tile sections of a failing spec
+ *
+ * Much cheaper than generating again: the reply is limited to
+ * SPEC_REPAIR_MAX_TOKENS and only carries what changes.
+ *
+ * @param specification Failing JSON specification
+ * @param diagnosis     Problems found by the parser or the solver
+ * @param patch_buffer  Buffer to store the JSON patch
+ * @param buffer_size   Size of patch buffer
+ * @return              0 on success, non-zero on failure or an empty reply
+ */
+int request_specification_repair(const char* specification, const char* diagnosis, char* patch_buffer,
+                                 size_t buffer_size);
+
 #endif // LLM_INTEGRATION_H
\ No newline at end of file
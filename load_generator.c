@@ -0,0 +1,405 @@
+#define _GNU_SOURCE  // ppoll()
+#include "load_generator.h"
+#include "async_solver.h"
+#include "dsl_parser.h"
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// =============================================================================
+// OPEN-LOOP LOAD GENERATOR
+// =============================================================================
+// The async API is what a server would put behind its socket, but nothing
+// showed how it behaves under a steady arrival rate. A closed loop (send the
+// next request when the previous one returns) slows down with the system
+// under test and never records the requests it failed to send while stalled,
+// so the schedule here is fixed up front and every latency is taken from the
+// moment the request should have gone out.
+
+// =============================
+// LATENCY HISTOGRAM
+// =============================
+
+#define LATENCY_HISTOGRAM_MAX_VALUE \
+    (((uint64_t)LATENCY_HISTOGRAM_SUB_BUCKET_COUNT << (LATENCY_HISTOGRAM_BUCKET_COUNT - 1)) - 1)
+#define HGRM_TICKS_PER_HALF_DISTANCE 5  // Percentile steps per halving of 1 - p
+
+static int histogram_index(uint64_t value) {
+    // Bucket b covers [2^(b+10), 2^(b+11)) with 1024 sub-buckets of width 2^b;
+    // bucket 0 also covers [0, 1024) at width 1
+    int magnitude = 64 - __builtin_clzll(value | (LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1));
+    int bucket = magnitude - (LATENCY_HISTOGRAM_SUB_BUCKET_HALF_BITS + 1);
+    int sub_bucket = (int)(value >> bucket);
+    return ((bucket + 1) << LATENCY_HISTOGRAM_SUB_BUCKET_HALF_BITS) +
+           (sub_bucket - LATENCY_HISTOGRAM_SUB_BUCKET_HALF);
+}
+
+/**
+ * @brief Largest value that lands in the same slot as index
+ */
+static uint64_t histogram_highest_value(int index) {
+    int bucket = (index >> LATENCY_HISTOGRAM_SUB_BUCKET_HALF_BITS) - 1;
+    uint64_t sub_bucket = (index & (LATENCY_HISTOGRAM_SUB_BUCKET_HALF - 1)) +
+                          LATENCY_HISTOGRAM_SUB_BUCKET_HALF;
+    if (bucket < 0) {
+        sub_bucket -= LATENCY_HISTOGRAM_SUB_BUCKET_HALF;
+        bucket = 0;
+    }
+    return (sub_bucket << bucket) + ((uint64_t)1 << bucket) - 1;
+}
+
+void latency_histogram_record(LatencyHistogram* histogram, uint64_t value_us) {
+    if (value_us > LATENCY_HISTOGRAM_MAX_VALUE) {
+        value_us = LATENCY_HISTOGRAM_MAX_VALUE;
+    }
+    histogram->counts[histogram_index(value_us)]++;
+    histogram->total++;
+    if (value_us > histogram->max) {
+        histogram->max = value_us;
+    }
+    histogram->sum += (double)value_us;
+    histogram->sum_squares += (double)value_us * (double)value_us;
+}
+
+uint64_t latency_histogram_percentile(const LatencyHistogram* histogram, double percentile) {
+    if (histogram->total == 0) {
+        return 0;
+    }
+    long wanted = (long)ceil(percentile / 100.0 * histogram->total);
+    if (wanted < 1) {
+        wanted = 1;
+    }
+    long cumulative = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_COUNTS; i++) {
+        cumulative += histogram->counts[i];
+        if (cumulative >= wanted) {
+            uint64_t value = histogram_highest_value(i);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+int latency_histogram_write_hgrm(const LatencyHistogram* histogram, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return 0;
+    }
+    fprintf(file, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount",
+            "1/(1-Percentile)");
+
+    // Same steps as HdrHistogram's percentile iterator: 5 lines per halving
+    // of the remaining tail, so the 99.9th and 99.99th get their own lines
+    long cumulative = 0;
+    int last_index = 0;
+    double next_percentile = 0.0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_COUNTS && cumulative < histogram->total; i++) {
+        if (histogram->counts[i] == 0) {
+            continue;
+        }
+        cumulative += histogram->counts[i];
+        last_index = i;
+        double reached = 100.0 * cumulative / histogram->total;
+        while (cumulative < histogram->total && next_percentile <= reached) {
+            double fraction = next_percentile / 100.0;
+            fprintf(file, "%12.3f %2.12f %10ld %14.2f\n", histogram_highest_value(i) / 1000.0,
+                    fraction, cumulative, 1.0 / (1.0 - fraction));
+            double half_distance = pow(2.0, floor(log2(100.0 / (100.0 - next_percentile))) + 1);
+            next_percentile += 100.0 / (HGRM_TICKS_PER_HALF_DISTANCE * half_distance);
+        }
+    }
+    if (histogram->total > 0) {
+        fprintf(file, "%12.3f %2.12f %10ld\n", histogram_highest_value(last_index) / 1000.0, 1.0,
+                histogram->total);
+    }
+
+    double mean = histogram->total ? histogram->sum / histogram->total : 0.0;
+    double variance = histogram->total ? histogram->sum_squares / histogram->total - mean * mean : 0.0;
+    fprintf(file, "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n", mean / 1000.0,
+            sqrt(variance > 0.0 ? variance : 0.0) / 1000.0);
+    fprintf(file, "#[Max     = %12.3f, Total count    = %12ld]\n", histogram->max / 1000.0,
+            histogram->total);
+    fprintf(file, "#[Buckets = %12d, SubBuckets     = %12d]\n", LATENCY_HISTOGRAM_BUCKET_COUNT,
+            LATENCY_HISTOGRAM_SUB_BUCKET_COUNT);
+    return fclose(file) == 0;
+}
+
+// =============================
+// SCHEDULE AND BOOKKEEPING
+// =============================
+
+typedef enum {
+    REQUEST_SOLVED,
+    REQUEST_UNSOLVED,                   // Spec has no layout
+    REQUEST_ERROR,                      // Parse error, memory, or submit failure
+    REQUEST_TIMEOUT,
+    REQUEST_OUTCOME_COUNT
+} RequestOutcome;
+
+static const char* outcome_names[REQUEST_OUTCOME_COUNT] = {"solved", "unsolved", "errors",
+                                                           "timeouts"};
+
+typedef struct LoadRequest {
+    AsyncSolveHandle* handle;           // NULL once completed
+    double intended;                    // Seconds after the start of the run
+    double sent;
+    int timed_out;                      // Cancelled by the generator
+} LoadRequest;
+
+typedef struct LoadRun {
+    AsyncSolvePool* pool;
+    LoadRequest* requests;
+    struct timespec start;
+    double timeout;                     // Seconds (0 = never)
+    int in_flight;
+    int oldest;                         // No unfinished request before this index
+    long outcomes[REQUEST_OUTCOME_COUNT];
+    LatencyHistogram* response;         // From the intended send time
+    LatencyHistogram* service;          // From the actual submission
+} LoadRun;
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static uint64_t to_microseconds(double seconds) {
+    return seconds > 0.0 ? (uint64_t)(seconds * 1e6 + 0.5) : 0;
+}
+
+/**
+ * @brief Records and releases every finished handle
+ */
+static void collect_completions(LoadRun* run) {
+    async_pool_ack_events(run->pool);
+    AsyncSolveHandle* handle;
+    while ((handle = async_pool_next_completed(run->pool))) {
+        LoadRequest* request = async_solve_user_data(handle);
+        AsyncSolveStats stats;
+        async_solve_stats(handle, &stats);
+
+        // Completion time from the pool's own clock rather than when this
+        // loop got around to it
+        double service = (stats.queue_ms + stats.solve_ms) / 1000.0;
+        double finished = request->sent + service;
+        latency_histogram_record(run->response, to_microseconds(finished - request->intended));
+        latency_histogram_record(run->service, to_microseconds(service));
+
+        RequestOutcome outcome;
+        if (request->timed_out ||
+            (run->timeout > 0.0 && finished - request->intended > run->timeout)) {
+            outcome = REQUEST_TIMEOUT;
+        } else if (stats.status == ASYNC_SOLVE_SOLVED) {
+            outcome = REQUEST_SOLVED;
+        } else if (stats.status == ASYNC_SOLVE_FAILED) {
+            outcome = REQUEST_UNSOLVED;
+        } else {
+            outcome = REQUEST_ERROR;
+        }
+        run->outcomes[outcome]++;
+
+        async_solve_release(handle);
+        request->handle = NULL;
+        run->in_flight--;
+    }
+}
+
+/**
+ * @brief Cancels requests past their deadline
+ * @param sent Number of requests submitted so far
+ * @return     Seconds until the next deadline, or -1 if none is pending
+ */
+static double enforce_timeouts(LoadRun* run, int sent, double now) {
+    while (run->oldest < sent && !run->requests[run->oldest].handle) {
+        run->oldest++;
+    }
+    if (run->timeout <= 0.0) {
+        return -1.0;
+    }
+    double next_deadline = -1.0;
+    for (int i = run->oldest; i < sent; i++) {
+        LoadRequest* request = &run->requests[i];
+        if (!request->handle || request->timed_out) {
+            continue;
+        }
+        double deadline = request->intended + run->timeout;
+        if (deadline <= now) {
+            async_solve_cancel(request->handle);
+            request->timed_out = 1;
+        } else {
+            // Intended times only grow, so the first live one is the nearest
+            next_deadline = deadline - now;
+            break;
+        }
+    }
+    return next_deadline;
+}
+
+/**
+ * @brief Waits for completions, at most the given number of seconds
+ */
+static void wait_for_events(LoadRun* run, double seconds) {
+    struct pollfd pfd = { .fd = async_pool_event_fd(run->pool), .events = POLLIN };
+    struct timespec timeout;
+    struct timespec* limit = NULL;
+    if (seconds >= 0.0) {
+        timeout.tv_sec = (time_t)seconds;
+        timeout.tv_nsec = (long)((seconds - (double)timeout.tv_sec) * 1e9);
+        limit = &timeout;
+    }
+    if (ppoll(&pfd, 1, limit, NULL) > 0) {
+        collect_completions(run);
+    }
+}
+
+static double min_wait(double a, double b) {
+    if (a < 0.0) {
+        return b;
+    }
+    return (b < 0.0 || a < b) ? a : b;
+}
+
+static void print_latencies(const char* name, const LatencyHistogram* histogram) {
+    static const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+    printf("  %-9s", name);
+    for (size_t p = 0; p < sizeof(percentiles) / sizeof(percentiles[0]); p++) {
+        printf(" p%-4g %9.3f ms ", percentiles[p],
+               latency_histogram_percentile(histogram, percentiles[p]) / 1000.0);
+    }
+    printf(" max %9.3f ms\n", histogram->max / 1000.0);
+}
+
+// =============================
+// DRIVER
+// =============================
+
+int run_load_generator(const LoadGeneratorConfig* config) {
+    if (config->rate <= 0.0 || config->duration <= 0.0 || config->file_count < 1) {
+        fprintf(stderr, "❌ Load test needs a positive rate, a duration and at least one spec\n");
+        return -1;
+    }
+    long total_long = (long)(config->rate * config->duration + 0.5);
+    if (total_long < 1 || total_long > 10000000) {
+        fprintf(stderr, "❌ Rate x duration must give between 1 and 10000000 requests\n");
+        return -1;
+    }
+    int total = (int)total_long;
+    int pool_threads = config->pool_threads > 0 ? config->pool_threads : 1;
+
+    char** specs = calloc(config->file_count, sizeof(char*));
+    LoadRun run = {0};
+    run.requests = calloc(total, sizeof(LoadRequest));
+    run.response = calloc(1, sizeof(LatencyHistogram));
+    run.service = calloc(1, sizeof(LatencyHistogram));
+    run.timeout = config->timeout_ms / 1000.0;
+    int result = -1;
+    if (!specs || !run.requests || !run.response || !run.service) {
+        fprintf(stderr, "❌ Memory allocation failed\n");
+        goto done;
+    }
+    for (int f = 0; f < config->file_count; f++) {
+        specs[f] = read_specification_file(config->files[f]);
+        if (!specs[f]) {
+            goto done;
+        }
+    }
+    run.pool = async_pool_create(pool_threads);
+    if (!run.pool) {
+        fprintf(stderr, "❌ Could not start the solver pool\n");
+        goto done;
+    }
+
+    printf("🚦 Load test: %d requests at %.1f/s over %.1f s, %d spec%s, pool of %d%s\n", total,
+           config->rate, config->duration, config->file_count, config->file_count == 1 ? "" : "s",
+           pool_threads, run.timeout > 0.0 ? "" : ", no timeout");
+
+    double interval = 1.0 / config->rate;
+    double max_lag = 0.0;
+    double lag_sum = 0.0;
+    clock_gettime(CLOCK_MONOTONIC, &run.start);
+
+    int sent = 0;
+    while (sent < total) {
+        double now = seconds_since(&run.start);
+        double next_deadline = enforce_timeouts(&run, sent, now);
+        LoadRequest* request = &run.requests[sent];
+        request->intended = sent * interval;
+        if (now < request->intended) {
+            wait_for_events(&run, min_wait(next_deadline, request->intended - now));
+            continue;
+        }
+
+        // Behind schedule: send at once, the lag stays in the response time
+        request->sent = seconds_since(&run.start);
+        double lag = request->sent - request->intended;
+        lag_sum += lag;
+        if (lag > max_lag) {
+            max_lag = lag;
+        }
+        request->handle = async_solve_submit(run.pool, specs[sent % config->file_count], NULL,
+                                             NULL, request);
+        if (request->handle) {
+            run.in_flight++;
+        } else {
+            run.outcomes[REQUEST_ERROR]++;
+        }
+        sent++;
+    }
+    double send_seconds = seconds_since(&run.start);
+
+    while (run.in_flight > 0) {
+        double next_deadline = enforce_timeouts(&run, sent, seconds_since(&run.start));
+        wait_for_events(&run, next_deadline);
+    }
+    double wall_seconds = seconds_since(&run.start);
+
+    long completed = run.response->total;
+    printf("  sent      %d in %.3f s (%.1f/s offered, %.1f/s achieved), "
+           "schedule lag mean %.3f ms, max %.3f ms\n",
+           total, send_seconds, config->rate, total / send_seconds, lag_sum / total * 1000.0,
+           max_lag * 1000.0);
+    printf("  completed %ld in %.3f s (%.1f/s throughput)\n", completed, wall_seconds,
+           completed / wall_seconds);
+    printf("  outcomes ");
+    for (int o = 0; o < REQUEST_OUTCOME_COUNT; o++) {
+        printf(" %s %ld (%.2f%%)%s", outcome_names[o], run.outcomes[o],
+               100.0 * run.outcomes[o] / total, o + 1 < REQUEST_OUTCOME_COUNT ? "," : "\n");
+    }
+    print_latencies("response", run.response);
+    print_latencies("service", run.service);
+
+    result = (int)(run.outcomes[REQUEST_ERROR] + run.outcomes[REQUEST_TIMEOUT]);
+    if (config->histogram_prefix) {
+        const char* kinds[2] = {"response", "service"};
+        const LatencyHistogram* histograms[2] = {run.response, run.service};
+        for (int h = 0; h < 2; h++) {
+            char path[1024];
+            snprintf(path, sizeof(path), "%s.%s.hgrm", config->histogram_prefix, kinds[h]);
+            if (latency_histogram_write_hgrm(histograms[h], path)) {
+                printf("  📈 %s histogram written to %s\n", kinds[h], path);
+            } else {
+                fprintf(stderr, "❌ Could not write %s\n", path);
+                result = -1;
+            }
+        }
+    }
+
+done:
+    if (run.pool) {
+        async_pool_destroy(run.pool);
+    }
+    if (specs) {
+        for (int f = 0; f < config->file_count; f++) {
+            free(specs[f]);
+        }
+    }
+    free(specs);
+    free(run.requests);
+    free(run.response);
+    free(run.service);
+    return result;
+}
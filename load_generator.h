@@ -0,0 +1,86 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <stdint.h>
+
+// =============================================================================
+// OPEN-LOOP LOAD GENERATOR
+// =============================================================================
+
+// Log-linear latency histogram in the HdrHistogram layout: values (in
+// microseconds) keep 3 significant digits up to 2^36 us, about 19 hours
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 11
+#define LATENCY_HISTOGRAM_SUB_BUCKET_HALF_BITS (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1)
+#define LATENCY_HISTOGRAM_SUB_BUCKET_COUNT (1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_SUB_BUCKET_HALF (1 << LATENCY_HISTOGRAM_SUB_BUCKET_HALF_BITS)
+#define LATENCY_HISTOGRAM_BUCKET_COUNT 26
+#define LATENCY_HISTOGRAM_COUNTS \
+    ((LATENCY_HISTOGRAM_BUCKET_COUNT + 1) * LATENCY_HISTOGRAM_SUB_BUCKET_HALF)
+
+typedef struct LatencyHistogram {
+    long counts[LATENCY_HISTOGRAM_COUNTS];
+    long total;
+    uint64_t max;                       // Largest recorded value
+    double sum;                         // For mean and standard deviation
+    double sum_squares;
+} LatencyHistogram;
+
+typedef struct LoadGeneratorConfig {
+    double rate;                        // Requests per second
+    double duration;                    // Seconds of scheduled sends
+    int pool_threads;                   // Async pool size
+    double timeout_ms;                  // Cancel requests older than this (0 = never)
+    const char** files;                 // Spec corpus, replayed round robin
+    int file_count;
+    const char* histogram_prefix;       // Write PREFIX.response.hgrm and
+                                        // PREFIX.service.hgrm (NULL = none)
+} LoadGeneratorConfig;
+
+/**
+ * @brief Records one latency
+ * @param histogram Histogram to add to
+ * @param value_us  Latency in microseconds; larger values than the histogram
+ *                  covers count as its maximum
+ */
+void latency_histogram_record(LatencyHistogram* histogram, uint64_t value_us);
+
+/**
+ * @brief Latency at a percentile (highest value equivalent to the bucket)
+ * @param histogram  Histogram to read
+ * @param percentile 0 to 100
+ * @return           Latency in microseconds, 0 if nothing was recorded
+ */
+uint64_t latency_histogram_percentile(const LatencyHistogram* histogram, double percentile);
+
+/**
+ * @brief Writes the histogram in HdrHistogram's percentile distribution (.hgrm) form
+ *
+ * Values are written in milliseconds, so the file plots directly with the
+ * HdrHistogram plotter.
+ *
+ * @param histogram Histogram to write
+ * @param path      Output file
+ * @return          1 on success, 0 if the file could not be written
+ */
+int latency_histogram_write_hgrm(const LatencyHistogram* histogram, const char* path);
+
+/**
+ * @brief Replays a spec corpus against the async solve API at a fixed rate
+ *
+ * Open loop and coordinated-omission safe: request i is due at
+ * start + i / rate whatever happened to earlier requests, and its response
+ * time is measured from that intended send time, so a stalled pool or a
+ * late generator shows up as latency instead of as fewer samples. The
+ * service time (from the actual submission) is kept in a second histogram;
+ * the gap between the two is time spent waiting to be sent.
+ *
+ * Requests still unfinished timeout_ms after their intended send time are
+ * cancelled and counted as timeouts. Specs without a layout count as
+ * unsolved, parse errors and exhausted memory as errors.
+ *
+ * @param config Rate, duration, pool and corpus
+ * @return       Number of requests that errored or timed out, -1 on setup failure
+ */
+int run_load_generator(const LoadGeneratorConfig* config);
+
+#endif // LOAD_GENERATOR_H
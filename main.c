@@ -1,30 +1,47 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "constraint_solver.h"
+#include "dsl_parser.h"
+#include "portfolio.h"
+#include "parallel_search.h"
+#include "nogood_store.h"
+#include "async_solver.h"
+#include "memory_budget.h"
+#include "search_profile.h"
+#include "solver_arena.h"
+#include "option_cache.h"
+#include "root_probe.h"
+#include "unsat_core.h"
+#include "spec_repair.h"
+#include "alloc_counter.h"
+#include "parser_bench.h"
+#include "load_generator.h"
+#include "layout_archive.h"
 #include "llm_integration.h"
+#include <poll.h>
 
 // =============================================================================
-// MAIN APPLICATION - PARSING AND MENU SYSTEM
+// MAIN APPLICATION - MENU SYSTEM AND HEADLESS SOLVING
 // =============================================================================
 
-// Parsing state enumeration
-typedef enum {
-    SECTION_NONE,
-    SECTION_COMPONENTS,
-    SECTION_CONSTRAINTS,
-    SECTION_TILES
-} ParsingSection;
+#define GENERATED_SPEC_BUFFER_SIZE 32768   // One LLM reply; 32KB for larger responses
 
 // =============================
 // FUNCTION PROTOTYPES
 // =============================
-int parse_specification_file(const char* filename, LayoutSolver* solver);
-int parse_specification_string(const char* specification, LayoutSolver* solver);
 void parse_and_solve_specification(const char* specification);
+void solve_generated_specification(char* specification, size_t buffer_size);
 void show_menu(void);
 int list_test_files(char filenames[][256], int max_files);
 void load_test_file_menu(void);
+int run_headless_solve(int argc, char** argv);
+int run_headless_generate(int argc, char** argv);
+int run_headless_parser_bench(int argc, char** argv);
+int run_headless_load_test(int argc, char** argv);
+int run_headless_show_archive(int argc, char** argv);
+int wait_for_async_solves(AsyncSolvePool* pool, int pending, int print_layout);
 
 /**
  * @brief Lists available test files in the tests/ directory and returns count
@@ -34,7 +51,7 @@ int list_test_files(char filenames[][256], int max_files) {
     printf("----------------------------------------\n");
 
     // Use popen to read directory listing
-    FILE* fp = popen("ls -1 tests/*.txt 2>/dev/null | sed 's|tests/||'", "r");
+    FILE* fp = popen("ls -1 tests/*.txt tests/*.json 2>/dev/null | sed 's|tests/||'", "r");
     if (!fp) {
         printf("❌ Error reading test directory\n");
         return 0;
@@ -102,218 +119,37 @@ void show_menu(void) {
 }
 
 /**
- * @brief Parses DSL specification from a text file
- * 
- * Loads the entire file content into memory and delegates to string parser.
- * Handles file I/O operations and memory management.
- * 
- * @param filename Path to DSL specification file
- * @param solver   Layout solver instance to populate
- * @return         1 on success, 0 on failure
+ * @brief Explains a failed solve by the constraints no root can lay out together
+ *
+ * Prints nothing if the failure was a budget or cancellation stop, or if no
+ * core could be established. A spec that solves from another root has no
+ * core; that is reported instead, and the solver keeps the layout.
+ *
+ * @param solver Solver whose last solve failed, still holding the parsed spec
+ * @param indent Prefix for the core lines
+ * @return       1 if the solver now holds a layout from another root
  */
-int parse_specification_file(const char* filename, LayoutSolver* solver) {
-    printf("📋 Parsing specification file: %s\n", filename);
-    
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("❌ Cannot open file: %s\n", filename);
+static int print_failure_core(LayoutSolver* solver, const char* indent) {
+    if (solver->memory_exhausted || solver->search_cancelled) {
         return 0;
     }
-    
-    // Read entire file into memory
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    char* file_content = malloc(file_size + 1);
-    if (!file_content) {
-        printf("❌ Memory allocation failed\n");
-        fclose(file);
-        return 0;
-    }
-    
-    fread(file_content, 1, file_size, file);
-    file_content[file_size] = '\0';
-    fclose(file);
-    
-    // Parse the content
-    int result = parse_specification_string(file_content, solver);
-    free(file_content);
-    
-    return result;
-}
 
-/**
- * @brief Parses DSL specification from string content
- * 
- * Main parsing engine that processes markdown-style DSL format:
- * - ## Components section with component descriptions
- * - ## Constraints section with ADJACENT() statements
- * - ## Component Tiles section with ASCII art in code blocks
- * 
- * @param specification DSL specification string to parse
- * @param solver        Layout solver instance to populate
- * @return              1 on success, 0 on failure
- */
-int parse_specification_string(const char* specification, LayoutSolver* solver) {
-    printf("📏 Specification string length: %zu bytes\n", strlen(specification));
-    printf("📋 Parsing DSL specification from string...\n");
-    
-    // Create a copy of the specification to work with
-    char* spec_copy = malloc(strlen(specification) + 1);
-    if (!spec_copy) {
-        printf("❌ Memory allocation failed\n");
-        return 0;
-    }
-    strcpy(spec_copy, specification);
-    
-    ParsingSection current_section = SECTION_NONE;
-    char current_component[256] = "";
-    char tile_buffer[2048] = "";
-    int in_code_block = 0;
-    
-    // Parse line by line
-    char* line = strtok(spec_copy, "\n");
-    while (line != NULL) {
-        // Trim leading whitespace
-        while (*line == ' ' || *line == '\t') line++;
-        
-        // Skip empty lines
-        if (strlen(line) == 0) {
-            line = strtok(NULL, "\n");
-            continue;
-        }
-        
-        // Check for section headers
-        if (strstr(line, "## Components") || strstr(line, "Components")) {
-            current_section = SECTION_COMPONENTS;
-            printf("📋 Found Components section\n");
-        } else if (strstr(line, "## Constraints") || strstr(line, "Constraints")) {
-            current_section = SECTION_CONSTRAINTS;
-            printf("📋 Found Constraints section\n");
-        } else if (strstr(line, "## Component Tiles") || strstr(line, "Component Tiles")) {
-            current_section = SECTION_TILES;
-            printf("📋 Found Component Tiles section\n");
-        }
-
-        // Parse components in the Components section
-        if (current_section == SECTION_COMPONENTS) {
-            // Look for **ComponentName** - description format
-            char* first_star = strstr(line, "**");
-            if (first_star) {
-                char* second_star = strstr(first_star + 2, "**");
-                if (second_star) {
-                    char* start = first_star + 2;
-                    char* end = second_star;
-                    if (end && end > start) {
-                        int len = end - start;
-                        if (len < (int)sizeof(current_component)) {
-                            strncpy(current_component, start, len);
-                            current_component[len] = '\0';
-                            printf("  🏷️  Found component: '%s'\n", current_component);
-                        }
-                    }
-                }
-            }
-            // Handle numbered list format: "1. Component Name"
-            else if ((line[0] >= '1' && line[0] <= '9') && strstr(line, ". ")) {
-                char* start = strstr(line, ". ") + 2;
-                // Find end of component name (before newline or dash)
-                char* end = strchr(start, '\n');
-                if (!end) end = strchr(start, '-');
-                if (!end) end = start + strlen(start);
-
-                // Trim whitespace from end
-                while (end > start && (*(end-1) == ' ' || *(end-1) == '\t')) end--;
-
-                int len = end - start;
-                if (len > 0 && len < (int)sizeof(current_component)) {
-                    strncpy(current_component, start, len);
-                    current_component[len] = '\0';
-                    printf("  🏷️  Found numbered component: '%s'\n", current_component);
-                }
-            }
-        }
-        
-        // Parse component tiles
-        if (current_section == SECTION_TILES) {
-            if (strstr(line, "```")) {
-                if (!in_code_block) {
-                    in_code_block = 1;
-                    tile_buffer[0] = '\0'; // Clear buffer
-                } else {
-                    // End of code block - add component
-                    in_code_block = 0;
-                    if (strlen(current_component) > 0 && strlen(tile_buffer) > 0) {
-                        add_component(solver, current_component, tile_buffer);
-                    }
-                }
-            } else if (in_code_block) {
-                // Accumulate tile data
-                if (strlen(tile_buffer) + strlen(line) + 1 < sizeof(tile_buffer)) {
-                    if (strlen(tile_buffer) > 0) strcat(tile_buffer, "\n");
-                    strcat(tile_buffer, line);
-                }
-            } else if (strstr(line, "**") && !in_code_block) {
-                // Component name in Component Tiles section: **ComponentName**
-                char* first_star = strstr(line, "**");
-                if (first_star) {
-                    char* second_star = strstr(first_star + 2, "**");
-                    if (second_star) {
-                        char* start = first_star + 2;
-                        char* end = second_star;
-                        if (end && end > start) {
-                            int len = end - start;
-                            if (len < (int)sizeof(current_component)) {
-                                strncpy(current_component, start, len);
-                                current_component[len] = '\0';
-
-                                // Remove trailing colon if present
-                                char* colon = strchr(current_component, ':');
-                                if (colon) *colon = '\0';
-
-                                printf("  🏷️  Found tile component name: '%s'\n", current_component);
-                            }
-                        }
-                    }
-                }
-            } else if (strstr(line, ":") && !in_code_block && !strstr(line, "**")) {
-                // Component name in "Name:" format (fallback)
-                char* colon = strchr(line, ':');
-                if (colon) {
-                    int len = colon - line;
-                    if (len > 0 && len < (int)sizeof(current_component)) {
-                        strncpy(current_component, line, len);
-                        current_component[len] = '\0';
-
-                        // Trim whitespace
-                        while (len > 0 && current_component[len-1] == ' ') {
-                            current_component[--len] = '\0';
-                        }
-                        printf("  🏷️  Found fallback component name: '%s'\n", current_component);
-                    }
-                }
-            }
+    UnsatCore core;
+    if (!extract_unsat_core(solver, 0, &core)) {
+        if (core.solved_root < 0) {
+            return 0;
         }
-        
-        // Parse constraints
-        if (current_section == SECTION_CONSTRAINTS && strstr(line, "(")) {
-            // Handle bullet point format (- ADJACENT(...))
-            char* constraint_start = line;
-            if (*constraint_start == '-' || *constraint_start == '*') {
-                constraint_start++;
-                while (*constraint_start == ' ' || *constraint_start == '\t') constraint_start++; // Skip whitespace
-            }
-            printf("  🔗 Found constraint: '%s'\n", constraint_start);
-            add_constraint(solver, constraint_start);
-        }
-        
-        line = strtok(NULL, "\n");
+        printf("%s🧩 No core: solves from root %s (%d checks, %ld nodes)\n", indent,
+               solver->components[core.solved_root].name, core.checks, core.nodes);
+        return 1;
     }
-    
-    free(spec_copy);
-    printf("📊 Loaded %d components and %d constraints\n", solver->component_count, solver->constraint_count);
-    return 1;
+    printf("%s🧩 Unsatisfiable core: %d of %d constraints%s (%d checks, %ld nodes)\n", indent,
+           core.constraint_count, solver->constraint_count, core.minimal ? "" : ", not minimal",
+           core.checks, core.nodes);
+    char inner[32];
+    snprintf(inner, sizeof(inner), "%s    ", indent);
+    print_unsat_core(solver, &core, inner);
+    return 0;
 }
 
 /**
@@ -330,7 +166,8 @@ void parse_and_solve_specification(const char* specification) {
     init_solver(&solver, 60, 40);
 
     // Parse specification from file or string
-    if (strstr(specification, ".txt") && strlen(specification) < 100) {
+    if ((strstr(specification, ".txt") || strstr(specification, ".json")) &&
+        strlen(specification) < 100) {
         if (!parse_specification_file(specification, &solver)) {
             return;
         }
@@ -347,7 +184,908 @@ void parse_and_solve_specification(const char* specification) {
         printf("\n📋 Detailed tree solver debug available in: tree_placement_debug.log\n");
     } else {
         printf("❌ Tree constraint solver failed to find a solution\n");
+        if (print_failure_core(&solver, "   ")) {
+            display_grid(&solver);
+        }
+    }
+}
+
+/**
+ * @brief Solves an LLM-generated spec, repairing it with patches on failure
+ *
+ * A spec that fails to parse or solve is diagnosed (parser problems, or the
+ * solver's contradictions and unsatisfiable core) and the diagnosis is sent
+ * back for a patch to the constraints or tiles, up to SPEC_REPAIR_MAX_ROUNDS
+ * times. A patch is applied to the spec already parsed, so unchanged tiles
+ * are not compiled again; a spec that never parsed is reparsed patched.
+ *
+ * @param specification Generated JSON spec; replaced by the patched text
+ * @param buffer_size   Size of the specification buffer
+ */
+void solve_generated_specification(char* specification, size_t buffer_size) {
+    LayoutSolver solver;
+    init_solver(&solver, 60, 40);
+    int parsed = parse_specification_string(specification, &solver);
+
+    for (int round = 0;; round++) {
+        if (parsed && solve_constraints(&solver)) {
+            display_grid(&solver);
+            printf("\n📋 Detailed tree solver debug available in: tree_placement_debug.log\n");
+            return;
+        }
+        if (parsed && (solver.memory_exhausted || solver.search_cancelled)) {
+            printf("❌ Tree constraint solver stopped before finding a solution\n");
+            return;
+        }
+        if (round == SPEC_REPAIR_MAX_ROUNDS) {
+            break;
+        }
+
+        char diagnosis[SPEC_REPAIR_REPORT_SIZE];
+        int findings = parsed ? diagnose_failed_solve(&solver, diagnosis, sizeof(diagnosis))
+                              : diagnose_specification_json(specification, diagnosis,
+                                                            sizeof(diagnosis));
+        if (findings < 0) {
+            // Another root lays the spec out: nothing to repair
+            printf("🧩 Solved from another root than the search started from\n");
+            display_grid(&solver);
+            return;
+        }
+        if (findings == 0) {
+            snprintf(diagnosis, sizeof(diagnosis),
+                     "- The solver found no layout; no single constraint could be blamed\n");
+        }
+        printf("\n🩺 %s (repair round %d of %d):\n%s", parsed ? "Solve failed" : "Parse failed",
+               round + 1, SPEC_REPAIR_MAX_ROUNDS, diagnosis);
+
+        char patch[8192];
+        if (request_specification_repair(specification, diagnosis, patch, sizeof(patch)) != 0) {
+            break;
+        }
+        printf("%s\n", patch);
+
+        char* merged = malloc(buffer_size);
+        if (!merged || !merge_specification_patch(specification, patch, merged, buffer_size)) {
+            printf("❌ Patch could not be merged into the specification\n");
+            free(merged);
+            break;
+        }
+        snprintf(specification, buffer_size, "%s", merged);
+        free(merged);
+
+        if (!parsed || !apply_specification_patch(patch, &solver)) {
+            init_solver(&solver, 60, 40);
+            parsed = parse_specification_string(specification, &solver);
+        }
+    }
+
+    printf(parsed ? "❌ Tree constraint solver failed to find a solution\n"
+                  : "❌ Failed to parse DSL specification from string\n");
+}
+
+// =============================
+// HEADLESS SOLVE
+// =============================
+
+// Settings of a --solve run; flags apply to every FILE wherever they appear
+typedef struct SolveOptions {
+    int quiet;
+    int repeat;
+    int search_threads;
+    int portfolio_size;
+    const char* portfolio_log;
+    long nogood_capacity;
+    int async_threads;
+    size_t memory_limit;
+    const char* flame_path;
+    SearchProfileMetric flame_metric;
+    const char* depth_path;
+    int join_constraints;
+    int forward_check;
+    int option_caching;
+    int root_probe_nodes;
+    int unsat_core;
+    int check_allocations;
+    const char* archive_path;
+    int archive_flags;
+    int print_layout;
+    const char** files;                 // Compacted to the front of argv[2..]
+    int file_count;
+} SolveOptions;
+
+// Files written across the whole run, one section or record per spec
+typedef struct SolveOutputs {
+    FILE* flame_file;
+    FILE* depth_file;
+    LayoutArchiveWriter* archive;
+} SolveOutputs;
+
+static void print_solve_usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s --solve [--quiet] [--repeat N] [--threads N] [--portfolio K]\n"
+            "               [--portfolio-log FILE] [--nogoods SLOTS] [--async N]\n"
+            "               [--memory-budget MB] [--flame-graph FILE]\n"
+            "               [--flame-metric time|nodes] [--depth-stats FILE]\n"
+            "               [--join-constraints] [--forward-check]\n"
+            "               [--no-option-cache] [--probe-root NODES] [--unsat-core]\n"
+            "               [--check-allocations] [--archive FILE] [--archive-grid]\n"
+            "               [--print-layout] FILE...\n",
+            program);
+}
+
+/**
+ * @brief Reads the --solve flags and files
+ * @param argc    Argument count from main
+ * @param argv    Argument vector from main (argv[1] is --solve)
+ * @param options Receives the settings
+ * @return        1 on success, 0 on an unknown flag or without files
+ */
+static int parse_solve_options(int argc, char** argv, SolveOptions* options) {
+    *options = (SolveOptions){
+        .repeat = 1,
+        .flame_metric = SEARCH_PROFILE_TIME,
+        .option_caching = 1,
+        .files = (const char**)&argv[2],
+    };
+
+    for (int i = 2; i < argc; i++) {
+        const char* flag = argv[i];
+        int has_value = i + 1 < argc;
+        if (strcmp(flag, "--quiet") == 0) {
+            options->quiet = 1;
+        } else if (strcmp(flag, "--repeat") == 0 && has_value) {
+            options->repeat = atoi(argv[++i]);
+            if (options->repeat < 1) options->repeat = 1;
+        } else if (strcmp(flag, "--threads") == 0 && has_value) {
+            options->search_threads = atoi(argv[++i]);
+            if (options->search_threads < 0) options->search_threads = 0;
+            if (options->search_threads > MAX_SEARCH_THREADS) {
+                options->search_threads = MAX_SEARCH_THREADS;
+            }
+        } else if (strcmp(flag, "--nogoods") == 0 && has_value) {
+            options->nogood_capacity = atol(argv[++i]);
+            if (options->nogood_capacity < 0) options->nogood_capacity = 0;
+        } else if (strcmp(flag, "--print-layout") == 0) {
+            options->print_layout = 1;
+        } else if (strcmp(flag, "--join-constraints") == 0) {
+            options->join_constraints = 1;
+        } else if (strcmp(flag, "--forward-check") == 0) {
+            options->forward_check = 1;
+        } else if (strcmp(flag, "--probe-root") == 0 && has_value) {
+            options->root_probe_nodes = atoi(argv[++i]);
+            if (options->root_probe_nodes < 1) options->root_probe_nodes = DEFAULT_ROOT_PROBE_NODES;
+        } else if (strcmp(flag, "--unsat-core") == 0) {
+            options->unsat_core = 1;
+        } else if (strcmp(flag, "--no-option-cache") == 0) {
+            options->option_caching = 0;
+        } else if (strcmp(flag, "--check-allocations") == 0) {
+            if (ALLOC_COUNTER_AVAILABLE) {
+                options->check_allocations = 1;
+            } else {
+                fprintf(stderr, "⚠️  --check-allocations needs a glibc build without "
+                                "sanitizers, ignored\n");
+            }
+        } else if (strcmp(flag, "--memory-budget") == 0 && has_value) {
+            double megabytes = atof(argv[++i]);
+            options->memory_limit = megabytes > 0 ? (size_t)(megabytes * 1024 * 1024) : 0;
+        } else if (strcmp(flag, "--flame-graph") == 0 && has_value) {
+            options->flame_path = argv[++i];
+        } else if (strcmp(flag, "--flame-metric") == 0 && has_value) {
+            options->flame_metric = strcmp(argv[++i], "nodes") == 0 ? SEARCH_PROFILE_NODES
+                                                                    : SEARCH_PROFILE_TIME;
+        } else if (strcmp(flag, "--depth-stats") == 0 && has_value) {
+            options->depth_path = argv[++i];
+        } else if (strcmp(flag, "--async") == 0 && has_value) {
+            options->async_threads = atoi(argv[++i]);
+            if (options->async_threads < 0) options->async_threads = 0;
+        } else if (strcmp(flag, "--portfolio") == 0 && has_value) {
+            options->portfolio_size = atoi(argv[++i]);
+            if (options->portfolio_size > DEFAULT_PORTFOLIO_SIZE) {
+                options->portfolio_size = DEFAULT_PORTFOLIO_SIZE;
+            }
+        } else if (strcmp(flag, "--portfolio-log") == 0 && has_value) {
+            options->portfolio_log = argv[++i];
+        } else if (strcmp(flag, "--archive") == 0 && has_value) {
+            options->archive_path = argv[++i];
+        } else if (strcmp(flag, "--archive-grid") == 0) {
+            options->archive_flags |= LAYOUT_ARCHIVE_STORE_GRID;
+        } else if (flag[0] == '-' && flag[1] == '-') {
+            return 0;
+        } else {
+            options->files[options->file_count++] = argv[i];
+        }
+    }
+    if (options->check_allocations && options->repeat < 2) {
+        options->repeat = 2;
+    }
+    return options->file_count > 0;
+}
+
+static void close_solve_outputs(SolveOutputs* outputs) {
+    if (outputs->flame_file) {
+        fclose(outputs->flame_file);
+    }
+    if (outputs->depth_file) {
+        fclose(outputs->depth_file);
+    }
+    outputs->flame_file = NULL;
+    outputs->depth_file = NULL;
+}
+
+/**
+ * @brief Creates the files the options ask for
+ * @return 1 on success, 0 if one could not be created (reported)
+ */
+static int open_solve_outputs(const SolveOptions* options, SolveOutputs* outputs) {
+    memset(outputs, 0, sizeof(SolveOutputs));
+    if (options->flame_path && !(outputs->flame_file = fopen(options->flame_path, "w"))) {
+        perror(options->flame_path);
+        return 0;
+    }
+    if (options->depth_path) {
+        if (!(outputs->depth_file = fopen(options->depth_path, "w"))) {
+            perror(options->depth_path);
+            close_solve_outputs(outputs);
+            return 0;
+        }
+        fprintf(outputs->depth_file,
+                "spec,depth,expanded,options,conflicting,joined,explored,failed,ms\n");
+    }
+    if (options->archive_path && !(outputs->archive = layout_archive_create(options->archive_path))) {
+        perror(options->archive_path);
+        close_solve_outputs(outputs);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Appends a file's search effort to the flame graph, named by its basename
+ */
+static void write_flame_graph(SearchProfile* profile, FILE* out, const char* filename,
+                              SearchProfileMetric metric) {
+    const char* base = strrchr(filename, '/');
+    search_profile_write_folded(profile, out, base ? base + 1 : filename, metric);
+}
+
+/**
+ * @brief Appends a solved file's layout to the archive
+ * @return 1 on success, 0 if the append failed (reported)
+ */
+static int archive_solved_layout(LayoutArchiveWriter* archive, const LayoutSolver* solver,
+                                 int flags, const char* filename) {
+    if (layout_archive_append(archive, solver, flags) < 0) {
+        fprintf(stderr, "❌ Could not append %s to the layout archive\n", filename);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Queues every run of one file on the async pool
+ * @return Number of runs that could not be queued
+ */
+static int submit_async_file(AsyncSolvePool* pool, const SolveOptions* options,
+                             const char* filename, int* pending) {
+    char* spec = read_specification_file(filename);
+    if (!spec) {
+        printf("%s: FAILED (cannot read file)\n", filename);
+        return 1;
+    }
+    AsyncSolveOptions async_options = {
+        .search_threads = options->search_threads,
+        .search_config = options->search_threads > 0 ? &DETERMINISTIC_SEARCH_CONFIG : NULL,
+        .nogood_store = NULL,
+        .memory_limit = options->memory_limit
+    };
+    int failures = 0;
+    for (int run = 0; run < options->repeat; run++) {
+        // The handle is picked up again through async_pool_next_completed()
+        if (async_solve_submit(pool, spec, &async_options, NULL, (void*)filename)) {
+            (*pending)++;
+        } else {
+            failures++;
+        }
+    }
+    free(spec);
+    return failures;
+}
+
+/**
+ * @brief Solves one file --repeat times on the calling thread and reports it
+ * @return 1 if a run failed or the allocation check did, 0 otherwise
+ */
+static int solve_file(LayoutSolver* solver, SolverArena* arena, const SolveOptions* options,
+                      SolveOutputs* outputs, const char* filename) {
+    int solved = 0;
+    int memory_exhausted = 0;
+    long steady_allocations = 0;
+    int wins[MAX_PORTFOLIO_SIZE] = {0};
+    struct timespec start, end;
+
+    // One store per spec: signatures only identify states within a spec
+    NogoodStore* nogoods = options->nogood_capacity > 0
+                               ? nogood_store_create(options->nogood_capacity) : NULL;
+    MemoryBudget* budget = options->memory_limit > 0 ? memory_budget_create(options->memory_limit)
+                                                     : NULL;
+    // The solver is charged like every search copy, as async requests are
+    int solver_fits = memory_budget_reserve(budget, sizeof(LayoutSolver));
+    SearchProfile* profile = outputs->flame_file ? search_profile_create() : NULL;
+    OptionCache* option_cache = options->option_caching ? option_cache_create(budget) : NULL;
+    init_solver(solver, 60, 40);
+    solver->verbose = !options->quiet;
+    solver->tree_debug_enabled = !options->quiet && !options->check_allocations;
+    solver->search_threads = options->search_threads;
+    solver->join_constraints = options->join_constraints;
+    solver->forward_checking = options->forward_check;
+    solver->nogood_store = nogoods;
+    solver->memory_budget = budget;
+    solver->search_profile = profile;
+    solver->arena = arena;
+    solver->option_cache = option_cache;
+    if (options->search_threads > 0) {
+        solver->search_config = DETERMINISTIC_SEARCH_CONFIG;
+    }
+    if (options->root_probe_nodes > 0) {
+        solver->search_config.root_choice = ROOT_PROBED;
+        solver->root_probe_nodes = options->root_probe_nodes;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int run = 0; run < options->repeat; run++) {
+        // The first run sizes the arena, the others must reuse it
+        if (options->check_allocations && run > 0) {
+            alloc_counter_start();
+        }
+        reset_solver(solver, 60, 40);
+        if (solver_fits && parse_specification_file(filename, solver)) {
+            // Each floor of a multi-floor spec depends on the one below; no race
+            if (options->portfolio_size > 0 && solver->vertical_count == 0) {
+                PortfolioResult race;
+                if (solve_portfolio(solver, DEFAULT_PORTFOLIO, options->portfolio_size, &race,
+                                    options->portfolio_log)) {
+                    wins[race.winner]++;
+                    solved++;
+                }
+            } else if (solve_constraints(solver)) {
+                solved++;
+            }
+        }
+        if (options->check_allocations && run > 0) {
+            steady_allocations += alloc_counter_stop();
+        }
+        memory_exhausted += !solver_fits || solver->memory_exhausted;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 +
+                        (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("%s: %s %d/%d runs, %.3f ms/run, %d components, %d constraints, %d nodes\n",
+           filename,
+           solved == options->repeat ? "solved" : memory_exhausted ? "MEMORY EXHAUSTED" : "FAILED",
+           solved, options->repeat,
+           elapsed_ms / options->repeat, solver->component_count,
+           solver->constraint_count + solver->vertical_count,
+           solver->tree_solver.nodes_created);
+    for (int p = 0; p < options->portfolio_size; p++) {
+        if (wins[p] > 0) {
+            printf("    🏆 %s won %d/%d\n", DEFAULT_PORTFOLIO[p].name, wins[p], options->repeat);
+        }
+    }
+    int other_root = options->unsat_core && solved < options->repeat &&
+                     print_failure_core(solver, "    ");
+    if (options->check_allocations) {
+        printf("    🧮 allocations: %ld in %d runs after warm-up%s\n", steady_allocations,
+               options->repeat - 1, steady_allocations > 0 ? " (expected 0)" : "");
+    }
+
+    if (nogoods) {
+        nogood_store_print_stats(nogoods, "    🚫 nogoods");
+        nogood_store_destroy(nogoods);
+    }
+    if (options->root_probe_nodes > 0 && !options->quiet) {
+        root_probe_print_stats(solver, "    🌱 root probes");
+    }
+    if (option_cache) {
+        if (!options->quiet) {
+            option_cache_print_stats(option_cache, "    🗂️  option cache");
+        }
+        option_cache_destroy(option_cache);
+        solver->option_cache = NULL;
+    }
+    if (budget) {
+        if (solver_fits) {
+            memory_budget_release(budget, sizeof(LayoutSolver));
+        }
+        memory_budget_print_stats(budget, "    💾 memory");
+        memory_budget_destroy(budget);
+    }
+    if (outputs->depth_file) {
+        write_depth_stats_csv(solver, outputs->depth_file, filename);
+    }
+    if (profile) {
+        write_flame_graph(profile, outputs->flame_file, filename, options->flame_metric);
+        search_profile_destroy(profile);
+    }
+
+    int failed = solved != options->repeat || steady_allocations > 0;
+    if (options->print_layout && (solved > 0 || other_root)) {
+        display_grid(solver);
+    }
+    if (outputs->archive && solved > 0 &&
+        !archive_solved_layout(outputs->archive, solver, options->archive_flags, filename)) {
+        failed = 1;
     }
+    return failed;
+}
+
+/**
+ * @brief Headless batch solve of specification files
+ *
+ * Non-interactive entry point used by scripts and by the profile-guided
+ * build to train on a workload. Each file is parsed and solved --repeat
+ * times; one summary line per file is printed.
+ *
+ * Usage: ascii_structure_system --solve [--quiet] [--repeat N] FILE...
+ *   --quiet   Silence solver progress output and tree_placement_debug.log
+ *   --repeat  Solve each file N times (default 1)
+ *   --async   Submit every run to an N-thread async pool and report
+ *             completions as they arrive (--portfolio and --nogoods ignored)
+ *   --portfolio-log  Append each --portfolio race's outcome to FILE as CSV
+ *   --memory-budget  Cap each solve's tree and solvers (its own and every
+ *                    search copy) at MB megabytes
+ *   --flame-graph    Append each file's search effort per tree path to FILE as
+ *                    folded stacks (--flame-metric time|nodes, default time)
+ *   --depth-stats    Write the per-depth search counters of each file's last
+ *                    run to FILE as CSV
+ *   --join-constraints  Options must satisfy every constraint to an already
+ *                    placed component, so constraints closing a cycle hold
+ *                    (ignored with --async)
+ *   --forward-check  After each placement, fail the branch at once when a
+ *                    neighbouring component has no free position left
+ *                    (ignored with --async)
+ *   --no-option-cache  Regenerate every option list instead of reusing the
+ *                    ones no placement has touched (ignored with --async)
+ *   --probe-root     Choose the root by NODES-node probe searches from the
+ *                    top-degree components instead of by degree alone
+ *                    (ignored with --portfolio and --async)
+ *   --unsat-core     When a file has no layout, print a small set of its
+ *                    constraints that already fail together from every root
+ *                    (ignored with --async)
+ *   --check-allocations  Count heap allocations in every run after a file's
+ *                    first (at least 2 runs) and fail unless there are none;
+ *                    also turns off tree_placement_debug.log (ignored with --async)
+ *   --archive        Append each solved file's layout to the layout archive
+ *                    FILE (--archive-grid also stores the compressed rendered
+ *                    grid; ignored with --async)
+ *
+ * @param argc Argument count from main
+ * @param argv Argument vector from main (argv[1] is --solve)
+ * @return     0 if every file solved, 1 otherwise
+ */
+int run_headless_solve(int argc, char** argv) {
+    SolveOptions options;
+    if (!parse_solve_options(argc, argv, &options)) {
+        print_solve_usage(argv[0]);
+        return 1;
+    }
+
+    if (options.async_threads > 0) {
+        AsyncSolvePool* pool = async_pool_create(options.async_threads);
+        if (!pool) {
+            fprintf(stderr, "❌ Could not start async solver pool\n");
+            return 1;
+        }
+        int pending = 0;
+        int failures = 0;
+        for (int f = 0; f < options.file_count; f++) {
+            failures += submit_async_file(pool, &options, options.files[f], &pending);
+        }
+        failures += wait_for_async_solves(pool, pending, options.print_layout);
+        async_pool_destroy(pool);
+        return failures > 0 ? 1 : 0;
+    }
+
+    SolveOutputs outputs;
+    LayoutSolver* solver = malloc(sizeof(LayoutSolver));
+    if (!solver || !open_solve_outputs(&options, &outputs)) {
+        if (!solver) fprintf(stderr, "❌ Memory allocation failed\n");
+        free(solver);
+        return 1;
+    }
+
+    // One arena for every file: its buffers settle at the largest spec
+    SolverArena* arena = solver_arena_create();
+    int failures = 0;
+    for (int f = 0; f < options.file_count; f++) {
+        failures += solve_file(solver, arena, &options, &outputs, options.files[f]);
+    }
+
+    free(solver);
+    solver_arena_destroy(arena);
+    if (outputs.archive && !layout_archive_finish(outputs.archive)) {
+        fprintf(stderr, "❌ Could not complete the layout archive\n");
+        failures++;
+    }
+    close_solve_outputs(&outputs);
+    return failures > 0 ? 1 : 0;
+}
+
+/**
+ * @brief Event loop for --solve --async: waits on the pool's notification fd
+ *
+ * Prints one line per submission in completion order, the way a server
+ * would reply to requests as their solves finish.
+ *
+ * @param pool         Pool the runs were submitted to
+ * @param pending      Number of submissions still outstanding
+ * @param print_layout Whether to display each solved layout
+ * @return             Number of submissions that did not solve
+ */
+int wait_for_async_solves(AsyncSolvePool* pool, int pending, int print_layout) {
+    static const char* status_names[] = {
+        "queued", "running", "solved", "FAILED", "PARSE ERROR", "CANCELLED", "MEMORY EXHAUSTED"
+    };
+    struct pollfd pfd = { .fd = async_pool_event_fd(pool), .events = POLLIN };
+    int failures = 0;
+
+    while (pending > 0) {
+        if (poll(&pfd, 1, -1) < 0) {
+            perror("poll");
+            return failures + pending;
+        }
+        async_pool_ack_events(pool);
+
+        AsyncSolveHandle* handle;
+        while ((handle = async_pool_next_completed(pool))) {
+            AsyncSolveStats stats;
+            async_solve_stats(handle, &stats);
+            printf("%s: %s (async), %.3f ms queued, %.3f ms solving, %d/%d components placed, "
+                   "%d nodes, %zu KB peak\n",
+                   (const char*)async_solve_user_data(handle), status_names[stats.status],
+                   stats.queue_ms, stats.solve_ms, stats.placed_count, stats.component_count,
+                   stats.nodes_created, stats.memory_peak / 1024);
+
+            if (stats.status == ASYNC_SOLVE_SOLVED) {
+                if (print_layout) {
+                    display_grid(async_solve_result(handle));
+                }
+            } else {
+                failures++;
+            }
+            async_solve_release(handle);
+            pending--;
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief Headless bulk generation: several variants from one API request
+ *
+ * Usage: ascii_structure_system --generate TYPE [--variants N] [--async N] [--print-layout]
+ *   --variants      Specifications requested in the single API call
+ *                   (default 4, at most LLM_MAX_VARIANTS)
+ *   --async         Solver threads for the variants (default one per variant)
+ *   --print-layout  Display each solved layout
+ *
+ * Each variant is submitted to the async pool on its own as soon as the
+ * reply is in and reported as its solve completes, so one variant's parse
+ * error or failed search does not hold up the others. Failed variants are
+ * not repaired; regenerate or repair them one at a time from the menu.
+ *
+ * @param argc Argument count from main
+ * @param argv Argument vector from main (argv[1] is --generate)
+ * @return     0 if every variant solved, 1 otherwise
+ */
+int run_headless_generate(int argc, char** argv) {
+    const char* structure_type = NULL;
+    int variants = 4;
+    int async_threads = 0;
+    int print_layout = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--variants") == 0 && i + 1 < argc) {
+            variants = atoi(argv[++i]);
+            if (variants < 1) variants = 1;
+            if (variants > LLM_MAX_VARIANTS) variants = LLM_MAX_VARIANTS;
+            continue;
+        }
+        if (strcmp(argv[i], "--async") == 0 && i + 1 < argc) {
+            async_threads = atoi(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "--print-layout") == 0) {
+            print_layout = 1;
+            continue;
+        }
+        if (!structure_type && argv[i][0] != '-') {
+            structure_type = argv[i];
+            continue;
+        }
+        structure_type = NULL;
+        break;
+    }
+    if (!structure_type) {
+        fprintf(stderr, "Usage: %s --generate TYPE [--variants N] [--async N] [--print-layout]\n",
+                argv[0]);
+        return 1;
+    }
+
+    char* specs = malloc((size_t)variants * GENERATED_SPEC_BUFFER_SIZE);
+    if (!specs) {
+        fprintf(stderr, "❌ Memory allocation failed\n");
+        return 1;
+    }
+    int received = generate_structure_variants(structure_type, variants, specs,
+                                               GENERATED_SPEC_BUFFER_SIZE);
+    if (received <= 0) {
+        printf("❌ Failed to generate structure specifications.\n");
+        free(specs);
+        return 1;
+    }
+
+    AsyncSolvePool* pool = async_pool_create(async_threads > 0 ? async_threads : variants);
+    if (!pool) {
+        fprintf(stderr, "❌ Could not start async solver pool\n");
+        free(specs);
+        return 1;
+    }
+
+    char labels[LLM_MAX_VARIANTS][300];
+    int pending = 0;
+    int failures = 0;
+    for (int v = 0; v < variants; v++) {
+        const char* spec = specs + (size_t)v * GENERATED_SPEC_BUFFER_SIZE;
+        snprintf(labels[v], sizeof(labels[v]), "%s variant %d", structure_type, v + 1);
+        if (spec[0] == '\0') {
+            printf("%s: NO SPECIFICATION\n", labels[v]);
+            failures++;
+            continue;
+        }
+        // The pool copies the spec text; the handle comes back through
+        // async_pool_next_completed()
+        if (async_solve_submit(pool, spec, NULL, NULL, labels[v])) {
+            pending++;
+        } else {
+            printf("%s: NOT SUBMITTED\n", labels[v]);
+            failures++;
+        }
+    }
+
+    failures += wait_for_async_solves(pool, pending, print_layout);
+    async_pool_destroy(pool);
+    free(specs);
+    printf("%d of %d variants solved from one request\n", variants - failures, variants);
+    return failures > 0 ? 1 : 0;
+}
+
+/**
+ * @brief Parser throughput benchmark over a synthetic and/or file corpus
+ *
+ * Usage: ascii_structure_system --bench-parser [--specs N] [--rounds N] [--seed S] [FILE...]
+ *   --specs   Synthetic spec pairs to generate (default PARSER_BENCH_DEFAULT_SPECS,
+ *             0 with FILEs to time only the files)
+ *   --rounds  Timed passes per parser and mode (default PARSER_BENCH_DEFAULT_ROUNDS)
+ *   --seed    Generator seed (default 1)
+ *
+ * @param argc Argument count from main
+ * @param argv Argument vector from main (argv[1] is --bench-parser)
+ * @return     0 if both parsers agree on every spec, 1 otherwise
+ */
+int run_headless_parser_bench(int argc, char** argv) {
+    ParserBenchConfig config = {
+        .synthetic_specs = PARSER_BENCH_DEFAULT_SPECS,
+        .rounds = PARSER_BENCH_DEFAULT_ROUNDS,
+        .seed = 1,
+        // FILE arguments are compacted to the front of argv[2..]
+        .files = (const char**)&argv[2],
+        .file_count = 0,
+    };
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--specs") == 0 && i + 1 < argc) {
+            config.synthetic_specs = atoi(argv[++i]);
+            if (config.synthetic_specs < 0) config.synthetic_specs = 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            config.rounds = atoi(argv[++i]);
+            if (config.rounds < 1) config.rounds = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s --bench-parser [--specs N] [--rounds N] [--seed S] [FILE...]\n",
+                    argv[0]);
+            return 1;
+        }
+        config.files[config.file_count++] = argv[i];
+    }
+
+    return run_parser_benchmark(&config) == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Open-loop load test of the async solve API
+ *
+ * Usage: ascii_structure_system --load-test [--rate R] [--duration S] [--pool N]
+ *                               [--timeout MS] [--hgrm PREFIX] FILE...
+ *   --rate      Requests per second (default 100)
+ *   --duration  Seconds of scheduled sends (default 10)
+ *   --pool      Async pool threads (default 4)
+ *   --timeout   Cancel requests unfinished this many ms after their send time
+ *               (default 0 = never)
+ *   --hgrm      Write PREFIX.response.hgrm and PREFIX.service.hgrm
+ *
+ * @param argc Argument count from main
+ * @param argv Argument vector from main (argv[1] is --load-test)
+ * @return     0 if no request errored or timed out, 1 otherwise
+ */
+int run_headless_load_test(int argc, char** argv) {
+    LoadGeneratorConfig config = {
+        .rate = 100.0,
+        .duration = 10.0,
+        .pool_threads = 4,
+        .timeout_ms = 0.0,
+        // FILE arguments are compacted to the front of argv[2..]
+        .files = (const char**)&argv[2],
+        .file_count = 0,
+        .histogram_prefix = NULL,
+    };
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            config.rate = atof(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            config.duration = atof(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "--pool") == 0 && i + 1 < argc) {
+            config.pool_threads = atoi(argv[++i]);
+            if (config.pool_threads < 1) config.pool_threads = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            config.timeout_ms = atof(argv[++i]);
+            if (config.timeout_ms < 0.0) config.timeout_ms = 0.0;
+            continue;
+        }
+        if (strcmp(argv[i], "--hgrm") == 0 && i + 1 < argc) {
+            config.histogram_prefix = argv[++i];
+            continue;
+        }
+        if (argv[i][0] == '-') {
+            config.file_count = 0;
+            break;
+        }
+        config.files[config.file_count++] = argv[i];
+    }
+    if (config.file_count == 0) {
+        fprintf(stderr, "Usage: %s --load-test [--rate R] [--duration S] [--pool N] "
+                        "[--timeout MS] [--hgrm PREFIX] FILE...\n", argv[0]);
+        return 1;
+    }
+
+    return run_load_generator(&config) == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Summarizes a layout archive and renders layouts from it
+ *
+ * Usage: ascii_structure_system --show-archive FILE [--quiet] [ID...]
+ *   --quiet   Only print the summary and decode timing
+ *   ID        Layouts to render (default all)
+ *
+ * @param argc Argument count from main
+ * @param argv Argument vector from main (argv[1] is --show-archive)
+ * @return     0 if every layout decoded, 1 otherwise
+ */
+int run_headless_show_archive(int argc, char** argv) {
+    const char* path = NULL;
+    int quiet = 0;
+    int first_id = argc;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = 1;
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else if (path && argv[i][0] != '-') {
+            first_id = i;
+            break;
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Usage: %s --show-archive FILE [--quiet] [ID...]\n", argv[0]);
+        return 1;
+    }
+    LayoutArchive* archive = layout_archive_open(path);
+    if (!archive) {
+        fprintf(stderr, "❌ %s is not a complete layout archive\n", path);
+        return 1;
+    }
+    const LayoutArchiveHeader* header = layout_archive_header(archive);
+    int count = (int)header->layout_count;
+
+    // One buffer for every render, sized by the largest layout
+    size_t buffer_size = 1;
+    size_t rendered_bytes = 0;
+    size_t record_bytes = 0;
+    for (int id = 0; id < count; id++) {
+        LayoutArchiveInfo info;
+        size_t needed = layout_archive_render(archive, id, NULL, 0);
+        rendered_bytes += needed > 0 ? needed - 1 : 0;
+        record_bytes += layout_archive_info(archive, id, &info) ? info.record_bytes : 0;
+        if (needed > buffer_size) buffer_size = needed;
+    }
+    char* buffer = malloc(buffer_size);
+    if (!buffer) {
+        fprintf(stderr, "❌ Memory allocation failed\n");
+        layout_archive_close(archive);
+        return 1;
+    }
+
+    int failures = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int id = 0; id < count; id++) {
+        if (layout_archive_render(archive, id, buffer, buffer_size) == 0) {
+            failures++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    size_t file_size = layout_archive_size(archive);
+    printf("🗄️  %s: %d layouts, %u tiles, %zu bytes (records %zu, %.1f bytes/layout)\n",
+           path, count, header->tile_count, file_size, record_bytes,
+           count ? (double)record_bytes / count : 0.0);
+    printf("    rendered layouts: %zu bytes, %.1fx the archive, %.1fx the records\n",
+           rendered_bytes, (double)rendered_bytes / file_size,
+           record_bytes ? (double)rendered_bytes / record_bytes : 0.0);
+    if (count > 0 && seconds > 0) {
+        printf("    decoded all layouts in %.3f ms (%.2f us/layout, %.1f MB/s rendered)\n",
+               seconds * 1000.0, seconds * 1e6 / count, rendered_bytes / 1e6 / seconds);
+    }
+    if (failures > 0) {
+        printf("❌ %d malformed layouts\n", failures);
+    }
+
+    // Without IDs every layout is rendered
+    int shown = quiet ? 0 : first_id < argc ? argc - first_id : count;
+    for (int n = 0; n < shown; n++) {
+        int id = first_id < argc ? atoi(argv[first_id + n]) : n;
+        LayoutArchiveInfo info;
+        if (!layout_archive_info(archive, id, &info) ||
+            !layout_archive_render(archive, id, buffer, buffer_size)) {
+            printf("❌ layout %d: no such layout\n", id);
+            failures++;
+            continue;
+        }
+        printf("\nLayout %d: %d components, %d floor%s, %dx%d, %zu-byte record%s\n", id,
+               info.component_count, info.floor_count, info.floor_count == 1 ? "" : "s",
+               info.width, info.height, info.record_bytes, info.has_grid ? " with grid" : "");
+        size_t floor_bytes = (size_t)info.height * (info.width + 1);
+        for (int floor = 0; floor < info.floor_count; floor++) {
+            if (info.floor_count > 1) {
+                printf("--- Floor %d ---\n", floor);
+            }
+            fwrite(buffer + floor * floor_bytes, 1, floor_bytes, stdout);
+        }
+    }
+
+    free(buffer);
+    layout_archive_close(archive);
+    return failures > 0 ? 1 : 0;
 }
 
 /**
@@ -362,13 +1100,36 @@ void parse_and_solve_specification(const char* specification) {
  * Uses tree-based constraint solver with modular debug system.
  * Generates detailed debug output in tree_placement_debug.log
  *
+ * Passing --solve as the first argument skips the menu and runs
+ * run_headless_solve() instead; --generate runs run_headless_generate(),
+ * --bench-parser runs run_headless_parser_bench(), --load-test runs
+ * run_headless_load_test() and --show-archive runs run_headless_show_archive().
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
  * @return Program exit code
  */
-int main() {
-    char output_buffer[32768]; // Increased to 32KB for larger LLM responses
+int main(int argc, char** argv) {
+    char output_buffer[GENERATED_SPEC_BUFFER_SIZE];
     char structure_type[256];
     int choice;
 
+    if (argc > 1 && strcmp(argv[1], "--solve") == 0) {
+        return run_headless_solve(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) {
+        return run_headless_generate(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-parser") == 0) {
+        return run_headless_parser_bench(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--load-test") == 0) {
+        return run_headless_load_test(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--show-archive") == 0) {
+        return run_headless_show_archive(argc, argv);
+    }
+
     // Initialize output buffer
     memset(output_buffer, 0, sizeof(output_buffer));
 
@@ -453,8 +1214,8 @@ int main() {
             printf("%s\n", output_buffer);
             printf("==================================================\n");
 
-            // Phase 2: Parse and solve constraints
-            parse_and_solve_specification(output_buffer);
+            // Phase 2: Parse and solve constraints, repairing the spec on failure
+            solve_generated_specification(output_buffer, sizeof(output_buffer));
         } else {
             printf("❌ Failed to generate structure specification.\n");
         }
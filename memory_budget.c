@@ -0,0 +1,205 @@
+#include "memory_budget.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// =============================================================================
+// PER-SOLVE MEMORY BUDGET
+// =============================================================================
+// Tree nodes are ~70KB each and a hard spec can create tens of thousands of
+// them, so an unbounded search can take a whole machine down. Every solver
+// allocation goes through this accountant: usage is checked against the limit
+// before malloc() is called, the search reads the pressure stage to shed
+// memory it can rebuild, and an allocation that still does not fit stops the
+// search with LayoutSolver.memory_exhausted set instead of letting the
+// process be OOM-killed.
+
+static const char* PRESSURE_NAMES[] = {
+    "none", "prune-tree", "shrink-caches", "lazy-expansion", "exhausted"
+};
+
+static void raise_max_pressure(MemoryBudget* budget, MemoryPressure pressure) {
+    int seen = atomic_load_explicit(&budget->max_pressure, memory_order_relaxed);
+    while ((int)pressure > seen &&
+           !atomic_compare_exchange_weak(&budget->max_pressure, &seen, (int)pressure)) {
+    }
+}
+
+/**
+ * @brief Frees every cached node; the cache is the first thing to go under pressure
+ */
+static void release_node_cache(MemoryBudget* budget) {
+    pthread_mutex_lock(&budget->cache_lock);
+    int count = budget->node_cache_count;
+    for (int i = 0; i < count; i++) {
+        free(budget->node_cache[i]);
+    }
+    budget->node_cache_count = 0;
+    pthread_mutex_unlock(&budget->cache_lock);
+
+    if (count > 0) {
+        atomic_fetch_sub(&budget->in_use, count * sizeof(TreeNode));
+    }
+}
+
+/**
+ * @brief Undoes a charge that did not fit or could not be backed by malloc()
+ */
+static void refuse(MemoryBudget* budget, size_t size) {
+    atomic_fetch_sub(&budget->in_use, size);
+    atomic_fetch_add_explicit(&budget->failures, 1, memory_order_relaxed);
+    raise_max_pressure(budget, MEMORY_PRESSURE_EXHAUSTED);
+}
+
+MemoryBudget* memory_budget_create(size_t limit) {
+    MemoryBudget* budget = malloc(sizeof(MemoryBudget));
+    if (!budget) {
+        return NULL;
+    }
+
+    budget->limit = limit;
+    atomic_init(&budget->in_use, 0);
+    atomic_init(&budget->peak, 0);
+    atomic_init(&budget->allocations, 0);
+    atomic_init(&budget->failures, 0);
+    atomic_init(&budget->max_pressure, MEMORY_PRESSURE_NONE);
+    pthread_mutex_init(&budget->cache_lock, NULL);
+    budget->node_cache_count = 0;
+    return budget;
+}
+
+void memory_budget_destroy(MemoryBudget* budget) {
+    if (!budget) {
+        return;
+    }
+    release_node_cache(budget);
+    pthread_mutex_destroy(&budget->cache_lock);
+    free(budget);
+}
+
+MemoryPressure memory_budget_pressure(MemoryBudget* budget) {
+    if (!budget || budget->limit == 0) {
+        return MEMORY_PRESSURE_NONE;
+    }
+
+    size_t in_use = atomic_load_explicit(&budget->in_use, memory_order_relaxed);
+    MemoryPressure pressure = MEMORY_PRESSURE_NONE;
+    if (in_use >= budget->limit / 10 * 9) {
+        pressure = MEMORY_PRESSURE_LAZY_EXPANSION;
+    } else if (in_use >= budget->limit / 4 * 3) {
+        pressure = MEMORY_PRESSURE_SHRINK_CACHES;
+    } else if (in_use >= budget->limit / 2) {
+        pressure = MEMORY_PRESSURE_PRUNE_TREE;
+    }
+    raise_max_pressure(budget, pressure);
+    return pressure;
+}
+
+/**
+ * @brief Adds size to the bytes in use if it fits the limit
+ * @return 1 if charged, 0 if refused (counted as a failure)
+ */
+static int charge(MemoryBudget* budget, size_t size) {
+    if (memory_budget_pressure(budget) >= MEMORY_PRESSURE_SHRINK_CACHES) {
+        release_node_cache(budget);
+    }
+
+    size_t in_use = atomic_fetch_add(&budget->in_use, size) + size;
+    if (budget->limit > 0 && in_use > budget->limit) {
+        refuse(budget, size);
+        return 0;
+    }
+
+    size_t peak = atomic_load_explicit(&budget->peak, memory_order_relaxed);
+    while (in_use > peak && !atomic_compare_exchange_weak(&budget->peak, &peak, in_use)) {
+    }
+    return 1;
+}
+
+void* memory_budget_alloc(MemoryBudget* budget, size_t size) {
+    if (!budget) {
+        return malloc(size);
+    }
+
+    atomic_fetch_add_explicit(&budget->allocations, 1, memory_order_relaxed);
+    if (!charge(budget, size)) {
+        return NULL;
+    }
+    void* ptr = malloc(size);
+    if (!ptr) {
+        refuse(budget, size);
+    }
+    return ptr;
+}
+
+void memory_budget_free(MemoryBudget* budget, void* ptr, size_t size) {
+    if (!ptr) {
+        return;
+    }
+    free(ptr);
+    if (budget) {
+        atomic_fetch_sub(&budget->in_use, size);
+    }
+}
+
+TreeNode* memory_budget_alloc_node(MemoryBudget* budget) {
+    if (!budget) {
+        return malloc(sizeof(TreeNode));
+    }
+
+    // Cached nodes are already charged
+    void* cached = NULL;
+    pthread_mutex_lock(&budget->cache_lock);
+    if (budget->node_cache_count > 0) {
+        cached = budget->node_cache[--budget->node_cache_count];
+    }
+    pthread_mutex_unlock(&budget->cache_lock);
+    if (cached) {
+        atomic_fetch_add_explicit(&budget->allocations, 1, memory_order_relaxed);
+        return cached;
+    }
+    return memory_budget_alloc(budget, sizeof(TreeNode));
+}
+
+void memory_budget_free_node(MemoryBudget* budget, TreeNode* node) {
+    if (!node) {
+        return;
+    }
+
+    if (budget && memory_budget_pressure(budget) < MEMORY_PRESSURE_SHRINK_CACHES) {
+        pthread_mutex_lock(&budget->cache_lock);
+        int cached = budget->node_cache_count < MEMORY_BUDGET_NODE_CACHE;
+        if (cached) {
+            budget->node_cache[budget->node_cache_count++] = node;
+        }
+        pthread_mutex_unlock(&budget->cache_lock);
+        if (cached) {
+            return;
+        }
+    }
+    memory_budget_free(budget, node, sizeof(TreeNode));
+}
+
+int memory_budget_reserve(MemoryBudget* budget, size_t size) {
+    return !budget || charge(budget, size);
+}
+
+void memory_budget_release(MemoryBudget* budget, size_t size) {
+    if (budget) {
+        atomic_fetch_sub(&budget->in_use, size);
+    }
+}
+
+void memory_budget_print_stats(MemoryBudget* budget, const char* label) {
+    int pressure = atomic_load(&budget->max_pressure);
+    if (budget->limit > 0) {
+        printf("%s: peak %zu KB of %zu KB (%.1f%%), %ld allocations, %ld refused, "
+               "deepest stage %s\n",
+               label, atomic_load(&budget->peak) / 1024, budget->limit / 1024,
+               100.0 * atomic_load(&budget->peak) / budget->limit,
+               atomic_load(&budget->allocations), atomic_load(&budget->failures),
+               PRESSURE_NAMES[pressure]);
+    } else {
+        printf("%s: peak %zu KB (no limit), %ld allocations\n", label,
+               atomic_load(&budget->peak) / 1024, atomic_load(&budget->allocations));
+    }
+}
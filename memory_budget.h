@@ -0,0 +1,126 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include "constraint_solver.h"
+#include <pthread.h>
+
+// =============================================================================
+// PER-SOLVE MEMORY BUDGET
+// =============================================================================
+
+#define MEMORY_BUDGET_NODE_CACHE 32     // Freed tree nodes kept for reuse
+
+// Degradation stages, entered as the bytes in use approach the limit. Each
+// stage keeps the ones below it; none of them changes the search order, so a
+// degraded solve finds the same layout as an unconstrained one.
+typedef enum {
+    MEMORY_PRESSURE_NONE,               // Below 50%: full tree kept until the solve ends
+    MEMORY_PRESSURE_PRUNE_TREE,         // From 50%: failed subtrees are freed immediately
+    MEMORY_PRESSURE_SHRINK_CACHES,      // From 75%: the node cache is released
+    MEMORY_PRESSURE_LAZY_EXPANSION,     // From 90%: children are created one at a time
+    MEMORY_PRESSURE_EXHAUSTED           // An allocation did not fit: the search stops
+} MemoryPressure;
+
+// Accounting allocator shared by a solve and all its search copies (parallel
+// workers, portfolio members, floor sub-solvers, root probes, core checks).
+// Counters are atomics; the node cache has its own lock. A refused allocation
+// is reported to the copy that made it (LayoutSolver.memory_exhausted); the
+// others keep going on what is left.
+//
+// Every LayoutSolver that works on a budgeted solve is charged, the solve's
+// own solver included: copies the budget allocates are charged by
+// memory_budget_alloc(), solvers that live elsewhere (the caller's solver,
+// copies pooled in a SolverArena) by memory_budget_reserve(). Tree nodes and
+// option lists taken from an arena are reserved the same way while in use.
+// A spec with N floors therefore needs N + 1 solvers' worth of budget before
+// its first node.
+typedef struct MemoryBudget {
+    size_t limit;                       // Bytes, 0 = account only
+    atomic_size_t in_use;               // Live allocations plus cached nodes
+    atomic_size_t peak;
+    atomic_long allocations;
+    atomic_long failures;               // Allocations refused or failed
+    atomic_int max_pressure;            // Deepest MemoryPressure reached
+
+    pthread_mutex_t cache_lock;
+    void* node_cache[MEMORY_BUDGET_NODE_CACHE];
+    int node_cache_count;
+} MemoryBudget;
+
+/**
+ * @brief Creates a budget
+ * @param limit Maximum bytes of solver allocations, 0 for no limit
+ * @return      New budget, or NULL on allocation failure
+ */
+MemoryBudget* memory_budget_create(size_t limit);
+
+/**
+ * @brief Releases the node cache and frees the budget
+ * @param budget Budget to free, may be NULL
+ */
+void memory_budget_destroy(MemoryBudget* budget);
+
+/**
+ * @brief Allocates size bytes against the budget
+ * @param budget Budget to charge, NULL for a plain malloc()
+ * @param size   Bytes to allocate
+ * @return       Memory, or NULL if the budget or the system is out of memory
+ */
+void* memory_budget_alloc(MemoryBudget* budget, size_t size);
+
+/**
+ * @brief Frees memory from memory_budget_alloc()
+ * @param budget Budget that was charged, NULL for a plain free()
+ * @param ptr    Memory to free, may be NULL
+ * @param size   Size passed to memory_budget_alloc()
+ */
+void memory_budget_free(MemoryBudget* budget, void* ptr, size_t size);
+
+/**
+ * @brief Takes a tree node from the cache, or allocates one against the budget
+ * @param budget Budget to charge, NULL for a plain malloc()
+ * @return       Uninitialized node, or NULL if the budget or the system is out of memory
+ */
+TreeNode* memory_budget_alloc_node(MemoryBudget* budget);
+
+/**
+ * @brief Returns a node from memory_budget_alloc_node() to the cache, or frees it
+ * @param budget Budget that was charged, NULL for a plain free()
+ * @param node   Node to free, may be NULL
+ */
+void memory_budget_free_node(MemoryBudget* budget, TreeNode* node);
+
+/**
+ * @brief Charges memory the budget did not allocate
+ *
+ * For solver copies owned by someone else (the caller, an arena pool), so
+ * they count against the limit like the copies the budget allocates.
+ *
+ * @param budget Budget to charge, NULL to do nothing
+ * @param size   Bytes to charge
+ * @return       1 if the charge fits the limit, 0 if it was refused
+ */
+int memory_budget_reserve(MemoryBudget* budget, size_t size);
+
+/**
+ * @brief Removes a charge made by memory_budget_reserve()
+ * @param budget Budget that was charged, NULL to do nothing
+ * @param size   Size passed to memory_budget_reserve()
+ */
+void memory_budget_release(MemoryBudget* budget, size_t size);
+
+/**
+ * @brief Current degradation stage
+ * @param budget Budget, NULL means MEMORY_PRESSURE_NONE
+ * @return       MemoryPressure for the bytes in use now
+ */
+MemoryPressure memory_budget_pressure(MemoryBudget* budget);
+
+/**
+ * @brief Prints peak usage, failures and the deepest degradation stage
+ * @param budget Budget to report on
+ * @param label  Prefix for the report line
+ */
+void memory_budget_print_stats(MemoryBudget* budget, const char* label);
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,199 @@
+#include "nogood_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// SHARED NOGOOD STORE
+// =============================================================================
+// Threads searching the same spec keep rediscovering the same dead partial
+// placements. A subtree that fails exhaustively publishes the signature of
+// its root state; any search reaching the same state again skips it.
+//
+// Signatures are 64-bit hashes, so two different states can collide and one
+// of them would be pruned wrongly. With a 2^16-entry table that chance is
+// about 2^-48 per lookup, which is accepted in exchange for lock-free slots.
+
+/**
+ * @brief splitmix64 finalizer, used to fold state words into the signature
+ */
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+NogoodStore* nogood_store_create(size_t capacity) {
+    size_t slots = 1;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    NogoodStore* store = malloc(sizeof(NogoodStore));
+    if (!store) {
+        return NULL;
+    }
+
+    store->slots = calloc(slots, sizeof(*store->slots));
+    if (!store->slots) {
+        free(store);
+        return NULL;
+    }
+
+    store->capacity = slots;
+    store->mask = slots - 1;
+    atomic_init(&store->lookups, 0);
+    atomic_init(&store->hits, 0);
+    atomic_init(&store->inserts, 0);
+    atomic_init(&store->duplicates, 0);
+    atomic_init(&store->cas_failures, 0);
+    atomic_init(&store->probes, 0);
+    atomic_init(&store->dropped, 0);
+    return store;
+}
+
+void nogood_store_destroy(NogoodStore* store) {
+    if (!store) {
+        return;
+    }
+    free((void*)store->slots);
+    free(store);
+}
+
+int nogood_store_contains(NogoodStore* store, struct NogoodStats* stats, uint64_t signature) {
+    size_t index = signature & store->mask;
+    int probes = 0;
+    int found = 0;
+
+    while (probes < NOGOOD_MAX_PROBES) {
+        uint64_t slot = atomic_load_explicit(&store->slots[index], memory_order_acquire);
+        probes++;
+        if (slot == signature) {
+            found = 1;
+            break;
+        }
+        if (slot == 0) {
+            break;
+        }
+        index = (index + 1) & store->mask;
+    }
+
+    stats->lookups++;
+    stats->probes += probes;
+    stats->hits += found;
+    return found;
+}
+
+int nogood_store_insert(NogoodStore* store, struct NogoodStats* stats, uint64_t signature) {
+    size_t index = signature & store->mask;
+    int probes = 0;
+
+    while (probes < NOGOOD_MAX_PROBES) {
+        uint64_t slot = atomic_load_explicit(&store->slots[index], memory_order_acquire);
+        probes++;
+
+        if (slot == 0) {
+            uint64_t expected = 0;
+            if (atomic_compare_exchange_strong_explicit(&store->slots[index], &expected,
+                                                        signature, memory_order_acq_rel,
+                                                        memory_order_acquire)) {
+                stats->inserts++;
+                stats->probes += probes;
+                return 1;
+            }
+            // Another thread claimed the slot first; it may hold our signature
+            stats->cas_failures++;
+            slot = expected;
+        }
+
+        if (slot == signature) {
+            stats->duplicates++;
+            stats->probes += probes;
+            return 1;
+        }
+        index = (index + 1) & store->mask;
+    }
+
+    stats->dropped++;
+    stats->probes += probes;
+    return 0;
+}
+
+void nogood_stats_merge(struct NogoodStats* total, const struct NogoodStats* stats) {
+    total->lookups += stats->lookups;
+    total->hits += stats->hits;
+    total->inserts += stats->inserts;
+    total->duplicates += stats->duplicates;
+    total->cas_failures += stats->cas_failures;
+    total->probes += stats->probes;
+    total->dropped += stats->dropped;
+}
+
+void nogood_store_flush_stats(NogoodStore* store, struct NogoodStats* stats) {
+    if (!store) {
+        return;
+    }
+    atomic_fetch_add_explicit(&store->lookups, stats->lookups, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->hits, stats->hits, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->inserts, stats->inserts, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->duplicates, stats->duplicates, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->cas_failures, stats->cas_failures, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->probes, stats->probes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->dropped, stats->dropped, memory_order_relaxed);
+    memset(stats, 0, sizeof(*stats));
+}
+
+void nogood_store_print_stats(NogoodStore* store, const char* label) {
+    long lookups = atomic_load(&store->lookups);
+    long hits = atomic_load(&store->hits);
+    long inserts = atomic_load(&store->inserts);
+    long operations = lookups + inserts + atomic_load(&store->duplicates) +
+                      atomic_load(&store->dropped);
+    long probes = atomic_load(&store->probes);
+
+    printf("%s: %ld lookups, %ld hits (%.1f%%), %ld inserts, %ld duplicates, "
+           "%ld dropped, %ld CAS failures, %.2f probes/op, %.2f%% full (%zu slots)\n",
+           label, lookups, hits, lookups ? 100.0 * hits / lookups : 0.0, inserts,
+           atomic_load(&store->duplicates), atomic_load(&store->dropped),
+           atomic_load(&store->cas_failures), operations ? (double)probes / operations : 0.0,
+           100.0 * inserts / store->capacity, store->capacity);
+}
+
+uint64_t compute_failure_signature(const LayoutSolver* solver) {
+    uint64_t hash = mix64(0x6a09e667f3bcc909ULL ^
+                          ((uint64_t)solver->search_config.constraint_order << 8) ^
+                          ((uint64_t)(solver->search_threads > 0) << 16));
+
+    int anchor_x = 0, anchor_y = 0, anchored = 0;
+    for (int i = 0; i < solver->component_count; i++) {
+        const PlacementRecord* rec = &solver->placements[i];
+        if (!rec->is_placed) {
+            continue;
+        }
+        if (!anchored) {
+            anchor_x = rec->x;
+            anchor_y = rec->y;
+            anchored = 1;
+        }
+
+        uint64_t dx = (uint32_t)(rec->x - anchor_x) & 0xffffff;
+        uint64_t dy = (uint32_t)(rec->y - anchor_y) & 0xffffff;
+        hash = mix64(hash ^ ((uint64_t)(i + 1) << 48 | dx << 24 | dy));
+    }
+
+    const TreeSolver* ts = &solver->tree_solver;
+    for (int i = 0; i < ts->remaining_count; i++) {
+        uint64_t constraint_index = ts->remaining_constraints[i] - solver->constraints;
+        hash = mix64(hash ^ (0x8000000000000000ULL | (uint64_t)i << 16 | constraint_index));
+    }
+
+    return hash ? hash : 1;
+}
+
+int nogood_store_usable(const LayoutSolver* solver) {
+    return solver->nogood_store &&
+           (solver->search_threads > 0 || solver->search_config.tie_break == TIE_BREAK_PREFERENCE);
+}
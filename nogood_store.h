@@ -0,0 +1,112 @@
+#ifndef NOGOOD_STORE_H
+#define NOGOOD_STORE_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// SHARED NOGOOD STORE
+// =============================================================================
+
+#define DEFAULT_NOGOOD_CAPACITY (1 << 16)
+#define NOGOOD_MAX_PROBES 16         // Linear-probe window per lookup or insert
+
+// Fixed-size, open-addressed set of failure signatures shared by every
+// search over one spec (parallel workers, portfolio members). Slots hold the
+// 64-bit signature itself, 0 marks an empty slot; inserts claim slots with a
+// CAS and nothing is ever deleted, so readers need no lock.
+typedef struct NogoodStore {
+    _Atomic uint64_t* slots;
+    size_t capacity;                 // Power of two
+    size_t mask;
+
+    // Totals of every search's NogoodStats. Lookups and inserts count into
+    // the searching solver, so these atomics are touched once per search
+    // rather than on every node
+    atomic_long lookups;
+    atomic_long hits;
+    atomic_long inserts;
+    atomic_long duplicates;
+    atomic_long cas_failures;
+    atomic_long probes;
+    atomic_long dropped;
+} NogoodStore;
+
+/**
+ * @brief Creates a store with at least the requested number of slots
+ * @param capacity Requested slot count, rounded up to a power of two
+ * @return         New store, or NULL on allocation failure
+ */
+NogoodStore* nogood_store_create(size_t capacity);
+
+/**
+ * @brief Frees a store created by nogood_store_create()
+ * @param store Store to free, may be NULL
+ */
+void nogood_store_destroy(NogoodStore* store);
+
+/**
+ * @brief Checks whether a failure signature has been published
+ * @param store     Shared store
+ * @param stats     Counters of the searching solver
+ * @param signature Non-zero signature from compute_failure_signature()
+ * @return          1 if the signature is known to fail, 0 otherwise
+ */
+int nogood_store_contains(NogoodStore* store, struct NogoodStats* stats, uint64_t signature);
+
+/**
+ * @brief Publishes a failure signature
+ * @param store     Shared store
+ * @param stats     Counters of the searching solver
+ * @param signature Non-zero signature from compute_failure_signature()
+ * @return          1 if stored (or already present), 0 if the probe window was full
+ */
+int nogood_store_insert(NogoodStore* store, struct NogoodStats* stats, uint64_t signature);
+
+/**
+ * @brief Adds a search copy's counters to another solver's, e.g. at a join
+ * @param total Counters to add to
+ * @param stats Counters to add
+ */
+void nogood_stats_merge(struct NogoodStats* total, const struct NogoodStats* stats);
+
+/**
+ * @brief Adds a finished search's counters to the store's totals and zeroes them
+ * @param store Shared store, may be NULL
+ * @param stats Counters of the solver whose search ended
+ */
+void nogood_store_flush_stats(NogoodStore* store, struct NogoodStats* stats);
+
+/**
+ * @brief Prints hit rate, contention and fill statistics
+ * @param store Store to report on
+ * @param label Prefix for the report line
+ */
+void nogood_store_print_stats(NogoodStore* store, const char* label);
+
+/**
+ * @brief Signature of the current search state for the nogood store
+ *
+ * Covers the search policy, the placed components with positions relative
+ * to the lowest-index placed component (so searches with different roots
+ * share entries) and the remaining constraints in order.
+ *
+ * @param solver Solver whose state to hash
+ * @return       Non-zero 64-bit signature
+ */
+uint64_t compute_failure_signature(const LayoutSolver* solver);
+
+/**
+ * @brief Whether the solver's searches may publish and consult nogoods
+ *
+ * A failed subtree is only a nogood when its outcome depends on nothing but
+ * the signature: always true when backtracked constraints keep their slot
+ * (deterministic mode), and in the classic search with preference
+ * tie-breaking. Random tie-breaking in the classic search makes the
+ * constraint order below a node depend on the random stream, so it stays out.
+ *
+ * @param solver Solver about to search
+ * @return       1 if solver->nogood_store may be used
+ */
+int nogood_store_usable(const LayoutSolver* solver);
+
+#endif // NOGOOD_STORE_H
@@ -0,0 +1,215 @@
+#include "option_cache.h"
+#include "memory_budget.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// PLACEMENT OPTION CACHE
+// =============================================================================
+// Fail-first ordering regenerates the options of every ready constraint at
+// each node, and the classic order revisits a constraint after every
+// backtrack. An option list only depends on the partner's position and on
+// what is placed inside the band of positions around it, so most of those
+// regenerations produce the list they produced last time.
+
+#define OPTION_LIST_BYTES (OPTION_CACHE_LIST_SIZE * sizeof(TreePlacementOption))
+
+OptionCache* option_cache_create(MemoryBudget* budget) {
+    OptionCache* cache = calloc(1, sizeof(OptionCache));
+    if (cache) {
+        cache->budget = budget;
+    }
+    return cache;
+}
+
+void option_cache_destroy(OptionCache* cache) {
+    if (!cache) {
+        return;
+    }
+    option_cache_release(cache);
+    free(cache);
+}
+
+void option_cache_clear(OptionCache* cache) {
+    for (int i = 0; i < cache->entry_limit; i++) {
+        cache->entries[i].valid = 0;
+    }
+    cache->entry_limit = 0;
+}
+
+void option_cache_release(OptionCache* cache) {
+    for (int i = 0; i < MAX_CONSTRAINTS; i++) {
+        OptionCacheEntry* entry = &cache->entries[i];
+        memory_budget_free(cache->budget, entry->options, OPTION_LIST_BYTES);
+        entry->options = NULL;
+        entry->valid = 0;
+    }
+    cache->entry_limit = 0;
+}
+
+/**
+ * @brief Does the entry describe the options of this constraint right now?
+ */
+static int entry_matches(const OptionCacheEntry* entry, LayoutSolver* solver,
+                         const Component* unplaced, const Component* partner) {
+    return entry->valid && !entry->placed_since &&
+           entry->unplaced_index == unplaced - solver->components &&
+           entry->partner_index == partner - solver->components &&
+           entry->partner_x == partner->placed_x && entry->partner_y == partner->placed_y;
+}
+
+int option_cache_lookup(OptionCache* cache, LayoutSolver* solver, const DSLConstraint* constraint,
+                        const Component* unplaced, const Component* partner,
+                        TreePlacementOption* options) {
+    const OptionCacheEntry* entry = &cache->entries[constraint - solver->constraints];
+    if (!entry_matches(entry, solver, unplaced, partner)) {
+        cache->misses++;
+        return -1;
+    }
+    memcpy(options, entry->options, entry->option_count * sizeof(TreePlacementOption));
+    cache->hits++;
+    return entry->option_count;
+}
+
+void option_cache_store(OptionCache* cache, LayoutSolver* solver, const DSLConstraint* constraint,
+                        const Component* unplaced, const Component* partner,
+                        const TreePlacementOption* options, int option_count) {
+    if (memory_budget_pressure(cache->budget) >= MEMORY_PRESSURE_SHRINK_CACHES) {
+        option_cache_release(cache);
+        return;
+    }
+
+    int index = constraint - solver->constraints;
+    OptionCacheEntry* entry = &cache->entries[index];
+    if (!entry->options &&
+        !(entry->options = memory_budget_alloc(cache->budget, OPTION_LIST_BYTES))) {
+        return;
+    }
+    if (option_count > OPTION_CACHE_LIST_SIZE) {
+        option_count = OPTION_CACHE_LIST_SIZE;
+    }
+
+    memcpy(entry->options, options, option_count * sizeof(TreePlacementOption));
+    entry->option_count = option_count;
+    entry->unplaced_index = unplaced - solver->components;
+    entry->partner_index = partner - solver->components;
+    entry->partner_x = partner->placed_x;
+    entry->partner_y = partner->placed_y;
+    // Options touch the partner from any side, so they stay within its
+    // rectangle grown by the unplaced component's size
+    entry->region_x = partner->placed_x - unplaced->width;
+    entry->region_y = partner->placed_y - unplaced->height;
+    entry->region_width = partner->width + 2 * unplaced->width;
+    entry->region_height = partner->height + 2 * unplaced->height;
+    entry->placed_since = 0;
+    entry->valid = 1;
+    if (index >= cache->entry_limit) {
+        cache->entry_limit = index + 1;
+    }
+}
+
+void option_cache_track_placement(OptionCache* cache, int component_index, int placed, int x, int y,
+                                  int width, int height) {
+    uint64_t bit = (uint64_t)1 << component_index;
+    for (int i = 0; i < cache->entry_limit; i++) {
+        OptionCacheEntry* entry = &cache->entries[i];
+        // A list never conflicts with the component it places, and a moved
+        // partner is caught by the position check in lookup
+        if (!entry->valid || entry->unplaced_index == component_index ||
+            entry->partner_index == component_index ||
+            !has_horizontal_overlap(x, width, entry->region_x, entry->region_width) ||
+            !has_vertical_overlap(y, height, entry->region_y, entry->region_height)) {
+            continue;
+        }
+
+        if (placed) {
+            entry->placed_since |= bit;
+        } else if (entry->placed_since & bit) {
+            // Backtracking undid a placement made after the list was generated
+            entry->placed_since &= ~bit;
+        } else {
+            entry->valid = 0;
+            cache->invalidations++;
+        }
+    }
+}
+
+void option_cache_attach_copy(LayoutSolver* copy, const LayoutSolver* solver) {
+    copy->option_cache =
+        solver->option_cache ? option_cache_create(solver->option_cache->budget) : NULL;
+}
+
+static void merge_counters(LayoutSolver* solver, const OptionCache* cache) {
+    if (solver->option_cache) {
+        solver->option_cache->hits += cache->hits;
+        solver->option_cache->misses += cache->misses;
+        solver->option_cache->invalidations += cache->invalidations;
+    }
+}
+
+void option_cache_detach_copy(LayoutSolver* solver, LayoutSolver* copy) {
+    if (!copy || !copy->option_cache) {
+        return;
+    }
+    merge_counters(solver, copy->option_cache);
+    option_cache_destroy(copy->option_cache);
+    copy->option_cache = NULL;
+}
+
+/**
+ * @brief Bytes of lists the cache holds
+ */
+static size_t list_bytes(const OptionCache* cache) {
+    size_t bytes = 0;
+    for (int i = 0; i < MAX_CONSTRAINTS; i++) {
+        if (cache->entries[i].options) {
+            bytes += OPTION_LIST_BYTES;
+        }
+    }
+    return bytes;
+}
+
+void option_cache_attach_pooled(LayoutSolver* copy, const LayoutSolver* solver,
+                                OptionCache** pool) {
+    copy->option_cache = NULL;
+    if (!solver->option_cache) {
+        return;
+    }
+    MemoryBudget* budget = solver->option_cache->budget;
+    if (!*pool) {
+        *pool = option_cache_create(budget);
+        if (!*pool) {
+            return;
+        }
+    } else {
+        // Pooled lists are only charged while a copy uses them; the budget
+        // may belong to another solve than the one that allocated them
+        if (!memory_budget_reserve(budget, list_bytes(*pool))) {
+            option_cache_release(*pool);
+        }
+        (*pool)->budget = budget;
+        option_cache_clear(*pool);
+        (*pool)->hits = 0;
+        (*pool)->misses = 0;
+        (*pool)->invalidations = 0;
+    }
+    copy->option_cache = *pool;
+}
+
+void option_cache_detach_pooled(LayoutSolver* solver, LayoutSolver* copy) {
+    OptionCache* cache = copy ? copy->option_cache : NULL;
+    if (!cache) {
+        return;
+    }
+    merge_counters(solver, cache);
+    memory_budget_release(cache->budget, list_bytes(cache));
+    cache->budget = NULL;
+    copy->option_cache = NULL;
+}
+
+void option_cache_print_stats(const OptionCache* cache, const char* label) {
+    long lookups = cache->hits + cache->misses;
+    printf("%s: %ld lookups, %ld hits (%.1f%%), %ld invalidations\n", label, lookups,
+           cache->hits, lookups ? 100.0 * cache->hits / lookups : 0.0, cache->invalidations);
+}
@@ -0,0 +1,144 @@
+#ifndef OPTION_CACHE_H
+#define OPTION_CACHE_H
+
+#include "constraint_solver.h"
+#include <stdint.h>
+
+// =============================================================================
+// PLACEMENT OPTION CACHE
+// =============================================================================
+
+#define OPTION_CACHE_LIST_SIZE 200      // Options per list, as generated per constraint
+
+// Options generated for one constraint, valid while region holds the
+// placements it held when they were generated
+typedef struct OptionCacheEntry {
+    int valid;
+    uint64_t placed_since;              // Components placed in region since, by index
+    int unplaced_index;                 // Component the options place
+    int partner_index;                  // Placed component they are adjacent to
+    int partner_x, partner_y;           // Where the partner was
+    int region_x, region_y;             // Every option rectangle lies inside
+    int region_width, region_height;
+    int option_count;
+    TreePlacementOption* options;       // OPTION_CACHE_LIST_SIZE slots, NULL until first use
+} OptionCacheEntry;
+
+// Generated option lists per constraint of one solver. Placing or removing
+// a component only affects the lists whose region it touches, and a
+// placement that backtracking removes again leaves them valid, so a
+// frontier constraint revisited after unrelated or undone placements is not
+// regenerated. Lists are charged to the solver's memory budget and are
+// released at MEMORY_PRESSURE_SHRINK_CACHES. Not shared between threads:
+// search copies get their own cache.
+typedef struct OptionCache {
+    OptionCacheEntry entries[MAX_CONSTRAINTS];  // Indexed by constraint
+    int entry_limit;                    // One past the highest entry stored since the last clear
+    struct MemoryBudget* budget;        // Charged for the lists, NULL = malloc
+    long hits;
+    long misses;
+    long invalidations;                 // Valid lists dropped by a placement or removal
+} OptionCache;
+
+/**
+ * @brief Creates an empty cache
+ * @param budget Budget to charge for the lists, NULL for plain malloc()
+ * @return       New cache, or NULL on allocation failure
+ */
+OptionCache* option_cache_create(struct MemoryBudget* budget);
+
+/**
+ * @brief Frees the cache and its lists
+ * @param cache Cache to free, may be NULL
+ */
+void option_cache_destroy(OptionCache* cache);
+
+/**
+ * @brief Invalidates every list but keeps the memory for the next solve
+ */
+void option_cache_clear(OptionCache* cache);
+
+/**
+ * @brief Frees every list; the cache refills on later misses
+ */
+void option_cache_release(OptionCache* cache);
+
+/**
+ * @brief Copies the cached options of a constraint, if still valid
+ * @param cache      Cache to look in
+ * @param solver     Solver the cache belongs to
+ * @param constraint Constraint whose options are wanted
+ * @param unplaced   Component the options place
+ * @param partner    Placed component of the constraint
+ * @param options    Receives the options on a hit
+ * @return           Number of options, or -1 on a miss
+ */
+int option_cache_lookup(OptionCache* cache, LayoutSolver* solver, const DSLConstraint* constraint,
+                        const Component* unplaced, const Component* partner,
+                        TreePlacementOption* options);
+
+/**
+ * @brief Remembers freshly generated options of a constraint
+ *
+ * Under memory pressure the cache is released and nothing is stored.
+ */
+void option_cache_store(OptionCache* cache, LayoutSolver* solver, const DSLConstraint* constraint,
+                        const Component* unplaced, const Component* partner,
+                        const TreePlacementOption* options, int option_count);
+
+/**
+ * @brief Updates the lists a placed or removed component may change
+ *
+ * A placement holds back the lists whose region it intersects until the
+ * same component is removed again; removing a component that was placed
+ * when a list was generated invalidates the list.
+ *
+ * @param cache           Cache to update
+ * @param component_index Component that was placed or removed
+ * @param placed          1 after placing it, 0 before removing it
+ * @param x, y, width, height Its rectangle
+ */
+void option_cache_track_placement(OptionCache* cache, int component_index, int placed, int x, int y,
+                                  int width, int height);
+
+/**
+ * @brief Gives a search copy its own empty cache if solver has one
+ *
+ * Call after copying solver into copy; a failed allocation leaves the copy
+ * without a cache.
+ */
+void option_cache_attach_copy(LayoutSolver* copy, const LayoutSolver* solver);
+
+/**
+ * @brief Adds a search copy's counters to solver's cache and frees the copy's cache
+ * @param solver Solver the copy was made from
+ * @param copy   Search copy, may be NULL
+ */
+void option_cache_detach_copy(LayoutSolver* solver, LayoutSolver* copy);
+
+/**
+ * @brief Gives a search copy a pooled cache if solver has one
+ *
+ * Like option_cache_attach_copy(), but the cache is taken from *pool
+ * (created there on first use, cleared on reuse) and kept with its lists
+ * for the next copy. The lists are charged to solver's budget until
+ * option_cache_detach_pooled().
+ */
+void option_cache_attach_pooled(LayoutSolver* copy, const LayoutSolver* solver,
+                                OptionCache** pool);
+
+/**
+ * @brief Adds a pooled copy's counters to solver's cache and hands the cache back to its pool
+ * @param solver Solver the copy was made from
+ * @param copy   Search copy, may be NULL
+ */
+void option_cache_detach_pooled(LayoutSolver* solver, LayoutSolver* copy);
+
+/**
+ * @brief Prints hits, misses and invalidations
+ * @param cache Cache to report on
+ * @param label Prefix for the report line
+ */
+void option_cache_print_stats(const OptionCache* cache, const char* label);
+
+#endif // OPTION_CACHE_H
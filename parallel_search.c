@@ -0,0 +1,262 @@
+#include "parallel_search.h"
+#include "memory_budget.h"
+#include "nogood_store.h"
+#include "option_cache.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// DETERMINISTIC PARALLEL SEARCH
+// =============================================================================
+// The content pipeline needs the same layout for the same spec and seed no
+// matter how many threads run, so workers never race for the result. Each
+// child of the root is searched as an independent subtree: the constraint
+// order below a node depends only on the path to it (explore_tree_child()
+// restores constraint slots in this mode) and every subtree gets its own
+// tie-break seed. Children are claimed in increasing order, and a solution
+// below child i only cancels subtrees of children after i.
+
+const SearchConfig DETERMINISTIC_SEARCH_CONFIG = {
+    "fail-first/preference/most-constrained", CONSTRAINT_ORDER_FAIL_FIRST,
+    TIE_BREAK_PREFERENCE, ROOT_MOST_CONSTRAINED, 0};
+
+typedef struct SubtreeShared {
+    TreeNode* root;                 // Expanded root, children are the work items
+    int child_count;                // Number of subtrees
+    unsigned int rng_base;          // Tie-break state after the root expansion
+    atomic_int next_child;          // Next unclaimed child index
+    atomic_int best_child;          // Lowest child index with a solution (child_count = none)
+    const atomic_int* user_cancel;  // Caller's cancel flag, checked between subtrees
+    struct SubtreeWorker* workers;  // All workers, for cancelling later subtrees
+    int worker_count;
+} SubtreeShared;
+
+typedef struct SubtreeWorker {
+    LayoutSolver* solver;           // Private copy with the root placed
+    DSLConstraint* constraint;      // Root constraint, in this copy
+    Component* component;           // Component placed by the root's children, in this copy
+    atomic_int cancel;              // Set when the current subtree comes after best_child
+    atomic_int current_child;       // Child being searched, -1 before the first claim
+    int solved_child;               // Child whose layout this copy holds, -1 if none
+    int exhausted_child;            // Child abandoned when the memory budget ran out, -1 if none
+    SubtreeShared* shared;
+} SubtreeWorker;
+
+/**
+ * @brief Records a solution below child_index and cancels later subtrees
+ */
+static void commit_subtree_solution(SubtreeShared* shared, int child_index) {
+    int best = atomic_load(&shared->best_child);
+    while (child_index < best &&
+           !atomic_compare_exchange_weak(&shared->best_child, &best, child_index)) {
+    }
+
+    best = atomic_load(&shared->best_child);
+    for (int i = 0; i < shared->worker_count; i++) {
+        if (atomic_load(&shared->workers[i].current_child) > best) {
+            atomic_store(&shared->workers[i].cancel, 1);
+        }
+    }
+}
+
+/**
+ * @brief Worker body: claim children in order and search each subtree
+ *
+ * The copy backtracks to the root state after every failed subtree, so one
+ * copy serves all the subtrees a worker claims. A worker stops after its
+ * first solution; any child it could still claim comes later in DFS order.
+ */
+static void* run_subtree_worker(void* arg) {
+    SubtreeWorker* worker = arg;
+    SubtreeShared* shared = worker->shared;
+    LayoutSolver* solver = worker->solver;
+
+    for (;;) {
+        if ((shared->user_cancel && atomic_load(shared->user_cancel)) ||
+            solver->memory_exhausted) {
+            solver->search_cancelled = 1;
+            break;
+        }
+
+        int child_index = atomic_fetch_add(&shared->next_child, 1);
+        if (child_index >= shared->child_count) {
+            break;
+        }
+
+        // Reset before publishing the claim so a cancel aimed at this child sticks
+        atomic_store(&worker->cancel, 0);
+        atomic_store(&worker->current_child, child_index);
+        if (child_index > atomic_load(&shared->best_child)) {
+            break;
+        }
+
+        solver->search_cancelled = 0;
+        solver->rng_state = shared->rng_base ^ ((unsigned int)(child_index + 1) * 0x9e3779b9u);
+        if (explore_tree_child(solver, child_index, worker->constraint, worker->component)) {
+            worker->solved_child = child_index;
+            commit_subtree_solution(shared, child_index);
+            break;
+        }
+        if (solver->memory_exhausted) {
+            worker->exhausted_child = child_index;
+            break;
+        }
+    }
+    return NULL;
+}
+
+int run_deterministic_parallel_search(LayoutSolver* solver) {
+    if (search_cancel_requested(solver)) {
+        return 0;
+    }
+
+    DSLConstraint* constraint = NULL;
+    Component* component = NULL;
+    int child_count = expand_tree_node(solver, &constraint, &component);
+    if (child_count <= 0) {
+        return child_count < 0;
+    }
+
+    int worker_count = solver->search_threads;
+    if (worker_count > MAX_SEARCH_THREADS) worker_count = MAX_SEARCH_THREADS;
+    if (worker_count > child_count) worker_count = child_count;
+
+    SOLVER_LOG(solver, "🧵 Deterministic parallel search: %d subtrees on %d workers\n",
+               child_count, worker_count);
+
+    SubtreeWorker workers[MAX_SEARCH_THREADS];
+    pthread_t threads[MAX_SEARCH_THREADS];
+    int started[MAX_SEARCH_THREADS] = {0};
+
+    SubtreeShared shared;
+    shared.root = solver->tree_solver.current_node;
+    shared.child_count = child_count;
+    shared.rng_base = solver->rng_state;
+    shared.user_cancel = solver->cancel_flag;
+    atomic_init(&shared.next_child, 0);
+    atomic_init(&shared.best_child, child_count);
+    shared.workers = workers;
+    shared.worker_count = 0;
+
+    // Copies are made before any thread starts: they share the expanded root
+    const int base_nodes_created = solver->tree_solver.nodes_created;
+    const int base_backtracks = solver->tree_solver.backtracks;
+    DepthStats depth_stats[MAX_DEPTH_STATS];
+    memcpy(depth_stats, solver->tree_solver.depth_stats, sizeof(depth_stats));
+
+    for (int i = 0; i < worker_count; i++) {
+        SubtreeWorker* worker = &workers[shared.worker_count];
+        worker->solver = memory_budget_alloc(solver->memory_budget, sizeof(LayoutSolver));
+        if (!worker->solver) {
+            break;
+        }
+
+        memcpy(worker->solver, solver, sizeof(LayoutSolver));
+        worker->solver->verbose = 0;
+        worker->solver->tree_debug_enabled = 0;
+        worker->solver->debug_file = NULL;
+        worker->solver->tree_debug_file = NULL;
+        worker->solver->cancel_flag = &worker->cancel;
+        worker->solver->arena = NULL;
+        option_cache_attach_copy(worker->solver, solver);
+        memset(&worker->solver->nogood_stats, 0, sizeof(worker->solver->nogood_stats));
+
+        TreeSolver* ts = &worker->solver->tree_solver;
+        for (int c = 0; c < ts->remaining_count; c++) {
+            ts->remaining_constraints[c] =
+                worker->solver->constraints + (ts->remaining_constraints[c] - solver->constraints);
+        }
+        worker->constraint = worker->solver->constraints + (constraint - solver->constraints);
+        worker->component = worker->solver->components + (component - solver->components);
+
+        atomic_init(&worker->cancel, 0);
+        atomic_init(&worker->current_child, -1);
+        worker->solved_child = -1;
+        worker->exhausted_child = -1;
+        worker->shared = &shared;
+        shared.worker_count++;
+    }
+
+    if (shared.worker_count == 0) {
+        SOLVER_LOG(solver, "❌ Parallel search: out of memory for worker copies\n");
+        solver->memory_exhausted = 1;
+        solver->search_cancelled = 1;
+        return 0;
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, SEARCH_THREAD_STACK_SIZE);
+    for (int i = 0; i < shared.worker_count; i++) {
+        started[i] = pthread_create(&threads[i], &attr, run_subtree_worker, &workers[i]) == 0;
+    }
+    pthread_attr_destroy(&attr);
+
+    // A worker whose thread could not start runs here; the committed layout
+    // does not depend on which thread searched which subtree
+    for (int i = 0; i < shared.worker_count; i++) {
+        if (!started[i]) {
+            run_subtree_worker(&workers[i]);
+        }
+    }
+    for (int i = 0; i < shared.worker_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    // A subtree abandoned for lack of memory was not proven empty, so a
+    // solution after it would not be the first in DFS order
+    int best = atomic_load(&shared.best_child);
+    int memory_exhausted = 0;
+    for (int i = 0; i < shared.worker_count; i++) {
+        int exhausted_child = workers[i].exhausted_child;
+        if (exhausted_child >= 0 && exhausted_child < best) {
+            best = child_count;
+        }
+    }
+    for (int i = 0; i < shared.worker_count && best == child_count; i++) {
+        memory_exhausted |= workers[i].solver->memory_exhausted;
+    }
+    int cancelled = best == child_count &&
+                    ((shared.user_cancel && atomic_load(shared.user_cancel)) || memory_exhausted);
+    int nodes_created = base_nodes_created;
+    int backtracks = base_backtracks;
+    struct NogoodStats nogood_stats = solver->nogood_stats;
+    for (int i = 0; i < shared.worker_count; i++) {
+        const LayoutSolver* copy = workers[i].solver;
+        nodes_created += copy->tree_solver.nodes_created - base_nodes_created;
+        backtracks += copy->tree_solver.backtracks - base_backtracks;
+        add_depth_stats(depth_stats, copy->tree_solver.depth_stats,
+                        solver->tree_solver.depth_stats);
+        nogood_stats_merge(&nogood_stats, &copy->nogood_stats);
+    }
+
+    for (int i = 0; i < shared.worker_count; i++) {
+        if (best < child_count && workers[i].solved_child == best) {
+            adopt_solver_layout(solver, workers[i].solver);
+        }
+    }
+    for (int i = 0; i < shared.worker_count; i++) {
+        rebase_tree_pointers(shared.root, workers[i].solver, solver);
+        option_cache_detach_copy(solver, workers[i].solver);
+        memory_budget_free(solver->memory_budget, workers[i].solver, sizeof(LayoutSolver));
+    }
+
+    solver->tree_solver.nodes_created = nodes_created;
+    solver->tree_solver.backtracks = backtracks;
+    memcpy(solver->tree_solver.depth_stats, depth_stats, sizeof(depth_stats));
+    solver->nogood_stats = nogood_stats;
+    solver->search_cancelled = cancelled;
+    solver->memory_exhausted = memory_exhausted;
+
+    if (best < child_count) {
+        SOLVER_LOG(solver, "✅ Committed solution below subtree %d/%d\n", best + 1, child_count);
+        return 1;
+    }
+
+    SOLVER_LOG(solver, "❌ All %d subtrees exhausted for %s\n", child_count, component->name);
+    return 0;
+}
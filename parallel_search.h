@@ -0,0 +1,33 @@
+#ifndef PARALLEL_SEARCH_H
+#define PARALLEL_SEARCH_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// DETERMINISTIC PARALLEL SEARCH
+// =============================================================================
+
+#define MAX_SEARCH_THREADS 64
+
+// Heuristics for deterministic runs. The static order thrashes once its
+// history-dependent reordering is removed (a late constraint that cannot be
+// met forces every earlier option to be retried); fail-first only depends on
+// the placements so far and keeps the subtrees small.
+extern const SearchConfig DETERMINISTIC_SEARCH_CONFIG;
+
+/**
+ * @brief Searches the subtrees below the first expansion concurrently
+ *
+ * Called by run_tree_search() in place of advance_to_next_constraint() when
+ * solver->search_threads > 0. The root is expanded once, then up to
+ * search_threads workers claim its children in order. The layout committed
+ * is the one below the lowest-index child that has a solution, which is the
+ * first solution in serial DFS order; only subtrees after that child are
+ * cancelled. The result is byte-identical for any thread count.
+ *
+ * @param solver Solver with the root placed and ts->current_node at the root
+ * @return       1 if a layout was found, 0 otherwise
+ */
+int run_deterministic_parallel_search(LayoutSolver* solver);
+
+#endif // PARALLEL_SEARCH_H
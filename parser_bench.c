@@ -0,0 +1,704 @@
+#include "parser_bench.h"
+#include "constraint_solver.h"
+#include "dsl_parser.h"
+#include "solver_arena.h"
+#include "alloc_counter.h"
+#include <cjson/cJSON.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// =============================================================================
+// PARSER THROUGHPUT BENCHMARK
+// =============================================================================
+// Parsing sits in front of every solve and every generated spec, but was
+// never measured. The corpus pairs each spec with its twin in the other
+// format, so the same content is timed through both parsers and a parser
+// change that alters what gets loaded shows up as a mismatch.
+
+typedef enum {
+    FORMAT_MARKDOWN,
+    FORMAT_JSON,
+    FORMAT_COUNT
+} SpecFormat;
+
+static const char* format_names[FORMAT_COUNT] = {"markdown", "json"};
+
+// Parsed content of one spec, independent of its text form
+typedef struct BenchSpec {
+    int component_count;
+    char names[MAX_COMPONENTS][64];
+    int heights[MAX_COMPONENTS];
+    char rows[MAX_COMPONENTS][MAX_TILE_SIZE][MAX_TILE_SIZE + 1];
+    int constraint_count;
+    DSLConstraint constraints[MAX_CONSTRAINTS];
+    int vertical_count;
+    DSLConstraint vertical[MAX_CONSTRAINTS];
+} BenchSpec;
+
+typedef struct BenchEntry {
+    char label[64];
+    size_t offset[FORMAT_COUNT];        // Into the corpus text
+    size_t length[FORMAT_COUNT];
+    int comparable;                     // Both forms carry the same content
+} BenchEntry;
+
+typedef struct BenchCorpus {
+    BenchEntry* entries;
+    int count;
+    int capacity;
+    char* text;                         // NUL-separated spec texts
+    size_t used;
+    size_t text_capacity;
+} BenchCorpus;
+
+// =============================
+// CORPUS STORAGE
+// =============================
+
+/**
+ * @brief Appends one NUL-terminated text to the corpus
+ * @return Offset of the text, or (size_t)-1 on allocation failure
+ */
+static size_t corpus_add_text(BenchCorpus* corpus, const char* text, size_t length) {
+    if (corpus->used + length + 1 > corpus->text_capacity) {
+        size_t capacity = corpus->text_capacity ? corpus->text_capacity : 1 << 20;
+        while (corpus->used + length + 1 > capacity) {
+            capacity *= 2;
+        }
+        char* grown = realloc(corpus->text, capacity);
+        if (!grown) {
+            return (size_t)-1;
+        }
+        corpus->text = grown;
+        corpus->text_capacity = capacity;
+    }
+    size_t offset = corpus->used;
+    memcpy(corpus->text + offset, text, length);
+    corpus->text[offset + length] = '\0';
+    corpus->used += length + 1;
+    return offset;
+}
+
+static BenchEntry* corpus_add_entry(BenchCorpus* corpus) {
+    if (corpus->count == corpus->capacity) {
+        int capacity = corpus->capacity ? corpus->capacity * 2 : 256;
+        BenchEntry* grown = realloc(corpus->entries, capacity * sizeof(BenchEntry));
+        if (!grown) {
+            return NULL;
+        }
+        corpus->entries = grown;
+        corpus->capacity = capacity;
+    }
+    BenchEntry* entry = &corpus->entries[corpus->count++];
+    memset(entry, 0, sizeof(BenchEntry));
+    return entry;
+}
+
+// Growable text the writers append to
+typedef struct TextBuffer {
+    char* data;
+    size_t length;
+    size_t capacity;
+} TextBuffer;
+
+static void text_append(TextBuffer* buffer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (needed < 0) {
+        return;
+    }
+    if (buffer->length + needed + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (buffer->length + needed + 1 > capacity) {
+            capacity *= 2;
+        }
+        char* grown = realloc(buffer->data, capacity);
+        if (!grown) {
+            return;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+    va_end(args);
+    buffer->length += needed;
+}
+
+// =============================
+// SPEC CONTENT
+// =============================
+
+/**
+ * @brief Copies what a parse loaded into a BenchSpec
+ *
+ * Tile rows lose their trailing blanks: both formats pad short rows to the
+ * tile width, so trailing blanks are not part of the content.
+ */
+static void bench_spec_from_solver(const LayoutSolver* solver, BenchSpec* spec) {
+    memset(spec, 0, sizeof(BenchSpec));
+    spec->component_count = solver->component_count;
+    for (int i = 0; i < solver->component_count; i++) {
+        const Component* comp = &solver->components[i];
+        snprintf(spec->names[i], sizeof(spec->names[i]), "%s", comp->name);
+        spec->heights[i] = comp->height;
+        for (int r = 0; r < comp->height; r++) {
+            int width = comp->width;
+            while (width > 0 && comp->ascii_tile[r][width - 1] == ' ') {
+                width--;
+            }
+            memcpy(spec->rows[i][r], comp->ascii_tile[r], width);
+            spec->rows[i][r][width] = '\0';
+        }
+    }
+    spec->constraint_count = solver->constraint_count;
+    memcpy(spec->constraints, solver->constraints, solver->constraint_count * sizeof(DSLConstraint));
+    spec->vertical_count = solver->vertical_count;
+    memcpy(spec->vertical, solver->vertical_constraints,
+           solver->vertical_count * sizeof(DSLConstraint));
+}
+
+/**
+ * @brief Whether the markdown form can carry every tile row unchanged
+ *
+ * The markdown scraper strips leading blanks and skips blank lines, so rows
+ * that start with a blank or are empty cannot survive it.
+ */
+static int bench_spec_markdown_safe(const BenchSpec* spec) {
+    for (int i = 0; i < spec->component_count; i++) {
+        for (int r = 0; r < spec->heights[i]; r++) {
+            char first = spec->rows[i][r][0];
+            if (first == '\0' || first == ' ' || first == '\t') {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static const char* direction_word(Direction direction) {
+    switch (direction) {
+        case 'n': return "north";
+        case 'e': return "east";
+        case 's': return "south";
+        case 'w': return "west";
+        default:  return "any";
+    }
+}
+
+/**
+ * @brief Compares two parses field by field
+ * @return 1 if identical, else 0 with the first difference in what
+ */
+static int compare_parses(const LayoutSolver* a, const LayoutSolver* b, char* what, size_t size) {
+    if (a->component_count != b->component_count) {
+        snprintf(what, size, "%d vs %d components", a->component_count, b->component_count);
+        return 0;
+    }
+    for (int i = 0; i < a->component_count; i++) {
+        const Component* ca = &a->components[i];
+        const Component* cb = &b->components[i];
+        if (strcmp(ca->name, cb->name) != 0) {
+            snprintf(what, size, "component %d named '%s' vs '%s'", i, ca->name, cb->name);
+            return 0;
+        }
+        if (ca->width != cb->width || ca->height != cb->height ||
+            memcmp(ca->ascii_tile, cb->ascii_tile, sizeof(ca->ascii_tile)) != 0) {
+            snprintf(what, size, "tile of '%s' (%dx%d vs %dx%d)", ca->name, ca->width, ca->height,
+                     cb->width, cb->height);
+            return 0;
+        }
+    }
+
+    const DSLConstraint* lists[2][2] = {{a->constraints, b->constraints},
+                                        {a->vertical_constraints, b->vertical_constraints}};
+    int counts[2][2] = {{a->constraint_count, b->constraint_count},
+                        {a->vertical_count, b->vertical_count}};
+    for (int kind = 0; kind < 2; kind++) {
+        const char* kind_name = kind == 0 ? "adjacent" : "vertical";
+        if (counts[kind][0] != counts[kind][1]) {
+            snprintf(what, size, "%d vs %d %s constraints", counts[kind][0], counts[kind][1],
+                     kind_name);
+            return 0;
+        }
+        for (int k = 0; k < counts[kind][0]; k++) {
+            const DSLConstraint* x = &lists[kind][0][k];
+            const DSLConstraint* y = &lists[kind][1][k];
+            if (x->type != y->type || x->direction != y->direction ||
+                strcmp(x->component_a, y->component_a) != 0 ||
+                strcmp(x->component_b, y->component_b) != 0) {
+                snprintf(what, size, "%s constraint %d (%s, %s, %c) vs (%s, %s, %c)", kind_name, k,
+                         x->component_a, x->component_b, x->direction ? x->direction : '-',
+                         y->component_a, y->component_b, y->direction ? y->direction : '-');
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// =============================
+// WRITERS
+// =============================
+
+// Prose the markdown writer mixes in. None of it contains a section keyword,
+// "**" or "(" where the scraper would pick it up.
+static const char* preambles[] = {
+    "Here is a detailed specification for the %s.",
+    "Below is the structure design for your %s, organised for the constraint solver.",
+    "Sure! This %s is broken into modular pieces.",
+};
+static const char* descriptions[] = {
+    "Large open area used for gatherings.",
+    "Small fortified room with thick walls.",
+    "Storage space lined with shelves and crates.",
+    "Quiet chamber with a single light source.",
+    "Wide hall supported by rows of pillars.",
+};
+static const char* epilogues[] = {
+    "Let me know if you would like any adjustments to this layout.",
+    "Note: every tile uses the expanded symbol library.",
+    "",
+};
+
+#define PICK(array, seed) (array[rand_r(seed) % (sizeof(array) / sizeof(array[0]))])
+
+/**
+ * @brief Writes a spec as LLM-style markdown, with styles chosen from seed
+ */
+static void write_markdown(const BenchSpec* spec, const char* subject, unsigned int* seed,
+                           TextBuffer* out) {
+    int list_style = rand_r(seed) % 3;
+    int name_style = rand_r(seed) % 3;
+
+    if (rand_r(seed) % 2) {
+        text_append(out, PICK(preambles, seed), subject);
+        text_append(out, "\n\n");
+    }
+    static const char* component_headers[] = {"## Components", "### Components", "## Components:"};
+    text_append(out, "%s\n\n", PICK(component_headers, seed));
+    for (int i = 0; i < spec->component_count; i++) {
+        const char* description = PICK(descriptions, seed);
+        switch (list_style) {
+            case 0: text_append(out, "**%s** - %s\n\n", spec->names[i], description); break;
+            case 1: text_append(out, "- **%s**: %s\n", spec->names[i], description); break;
+            default: text_append(out, "%d. %s - %s\n", i + 1, spec->names[i], description); break;
+        }
+    }
+
+    static const char* constraint_headers[] = {"## Constraints", "### Spatial Constraints"};
+    text_append(out, "\n%s\n\n", PICK(constraint_headers, seed));
+    static const char* bullets[] = {"", "- ", "* "};
+    for (int k = 0; k < spec->constraint_count; k++) {
+        const DSLConstraint* constraint = &spec->constraints[k];
+        const char* bullet = PICK(bullets, seed);
+        if (rand_r(seed) % 2) {
+            text_append(out, "%sADJACENT(%s, %s, %c)", bullet, constraint->component_a,
+                        constraint->component_b, constraint->direction);
+        } else {
+            text_append(out, "%sADJACENT(%s, %s, %s)", bullet, constraint->component_a,
+                        constraint->component_b, direction_word(constraint->direction));
+        }
+        text_append(out, rand_r(seed) % 4 == 0 ? "  - keeps the two rooms together\n" : "\n");
+        // Constraint types the solver ignores, as generations often include them
+        if (rand_r(seed) % 8 == 0) {
+            text_append(out, "%sCONNECTED(%s, %s, door, n)\n", bullet, constraint->component_a,
+                        constraint->component_b);
+        }
+    }
+    for (int k = 0; k < spec->vertical_count; k++) {
+        const DSLConstraint* constraint = &spec->vertical[k];
+        text_append(out, "- %s(%s, %s)\n", constraint->type == DSL_ABOVE ? "ABOVE" : "STAIRS",
+                    constraint->component_a, constraint->component_b);
+    }
+    if (spec->component_count > 0 && rand_r(seed) % 2) {
+        text_append(out, "ACCESSIBLE_FROM(%s, ALL)\n", spec->names[0]);
+    }
+
+    static const char* tile_headers[] = {"## Component Tiles", "### Component Tiles:"};
+    static const char* fences[] = {"```", "```text", "```ascii"};
+    text_append(out, "\n%s\n\n", PICK(tile_headers, seed));
+    for (int i = 0; i < spec->component_count; i++) {
+        switch (name_style) {
+            case 0: text_append(out, "**%s:**\n", spec->names[i]); break;
+            case 1: text_append(out, "**%s**\n", spec->names[i]); break;
+            default: text_append(out, "%s:\n", spec->names[i]); break;
+        }
+        text_append(out, "%s\n", PICK(fences, seed));
+        for (int r = 0; r < spec->heights[i]; r++) {
+            text_append(out, "%s\n", spec->rows[i][r]);
+        }
+        text_append(out, "```\n\n");
+    }
+    text_append(out, "%s\n", PICK(epilogues, seed));
+}
+
+/**
+ * @brief Writes a spec as compact or pretty JSON, with styles chosen from seed
+ */
+static void write_json(const BenchSpec* spec, unsigned int* seed, TextBuffer* out) {
+    int tile_as_string = rand_r(seed) % 4 == 0;
+    int long_directions = rand_r(seed) % 2;
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON* components = cJSON_AddArrayToObject(root, "components");
+    for (int i = 0; i < spec->component_count; i++) {
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", spec->names[i]);
+        if (rand_r(seed) % 2) {
+            cJSON_AddStringToObject(item, "description", PICK(descriptions, seed));
+        }
+        if (tile_as_string) {
+            char joined[MAX_TILE_SIZE * (MAX_TILE_SIZE + 1) + 1] = "";
+            for (int r = 0; r < spec->heights[i]; r++) {
+                strcat(joined, spec->rows[i][r]);
+                if (r + 1 < spec->heights[i]) strcat(joined, "\n");
+            }
+            cJSON_AddStringToObject(item, "tile", joined);
+        } else {
+            cJSON* tile = cJSON_AddArrayToObject(item, "tile");
+            for (int r = 0; r < spec->heights[i]; r++) {
+                cJSON_AddItemToArray(tile, cJSON_CreateString(spec->rows[i][r]));
+            }
+        }
+        cJSON_AddItemToArray(components, item);
+    }
+
+    cJSON* constraints = cJSON_AddArrayToObject(root, "constraints");
+    for (int k = 0; k < spec->constraint_count; k++) {
+        const DSLConstraint* constraint = &spec->constraints[k];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "type", "ADJACENT");
+        cJSON_AddStringToObject(item, "a", constraint->component_a);
+        cJSON_AddStringToObject(item, "b", constraint->component_b);
+        char short_direction[2] = {constraint->direction, '\0'};
+        cJSON_AddStringToObject(item, "direction",
+                                long_directions ? direction_word(constraint->direction)
+                                                : short_direction);
+        cJSON_AddItemToArray(constraints, item);
+    }
+    for (int k = 0; k < spec->vertical_count; k++) {
+        const DSLConstraint* constraint = &spec->vertical[k];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "type", constraint->type == DSL_ABOVE ? "ABOVE" : "STAIRS");
+        cJSON_AddStringToObject(item, "a", constraint->component_a);
+        cJSON_AddStringToObject(item, "b", constraint->component_b);
+        cJSON_AddItemToArray(constraints, item);
+    }
+
+    char* text = rand_r(seed) % 2 ? cJSON_Print(root) : cJSON_PrintUnformatted(root);
+    if (text) {
+        text_append(out, "%s\n", text);
+        cJSON_free(text);
+    }
+    cJSON_Delete(root);
+}
+
+// =============================
+// CORPUS GENERATION
+// =============================
+
+static const char* room_words[] = {
+    "Keep", "Gatehouse", "Courtyard", "Chapel", "Armory", "Barracks", "Well", "Stable",
+    "Library", "Kitchen", "Cellar", "Tower", "Garden", "Forge", "Vault", "Great_Hall",
+};
+// Interior glyphs; blanks only ever appear inside a row
+static const char interior_glyphs[] = "....~$TBhp: rwC";
+
+/**
+ * @brief Generates a random spec whose tiles the markdown form can carry
+ */
+static void generate_bench_spec(BenchSpec* spec, unsigned int* seed) {
+    memset(spec, 0, sizeof(BenchSpec));
+    spec->component_count = 3 + rand_r(seed) % (MAX_COMPONENTS - 8);
+    int word_count = sizeof(room_words) / sizeof(room_words[0]);
+
+    for (int i = 0; i < spec->component_count; i++) {
+        const char* word = room_words[rand_r(seed) % word_count];
+        snprintf(spec->names[i], sizeof(spec->names[i]), "%s_%d", word, i + 1);
+
+        int height = 2 + rand_r(seed) % 7;
+        int width = 3 + rand_r(seed) % 14;
+        spec->heights[i] = height;
+        for (int r = 0; r < height; r++) {
+            for (int c = 0; c < width; c++) {
+                int border = r == 0 || r == height - 1 || c == 0 || c == width - 1;
+                spec->rows[i][r][c] = border ? 'X' : interior_glyphs[rand_r(seed) % (sizeof(interior_glyphs) - 1)];
+            }
+            spec->rows[i][r][width] = '\0';
+        }
+    }
+
+    // A spanning tree of ADJACENT constraints plus a few extra edges
+    static const Direction directions[] = {'n', 'e', 's', 'w', 'a'};
+    int extra = rand_r(seed) % 4;
+    for (int k = 0; k < spec->component_count - 1 + extra; k++) {
+        int a = k < spec->component_count - 1 ? k + 1 : rand_r(seed) % spec->component_count;
+        int b = rand_r(seed) % (a > 0 ? a : 1);
+        if (a == b) {
+            continue;
+        }
+        DSLConstraint* constraint = &spec->constraints[spec->constraint_count++];
+        constraint->type = DSL_ADJACENT;
+        snprintf(constraint->component_a, sizeof(constraint->component_a), "%s", spec->names[a]);
+        snprintf(constraint->component_b, sizeof(constraint->component_b), "%s", spec->names[b]);
+        constraint->direction = directions[rand_r(seed) % 5];
+    }
+    if (rand_r(seed) % 10 == 0) {
+        DSLConstraint* constraint = &spec->vertical[spec->vertical_count++];
+        constraint->type = rand_r(seed) % 2 ? DSL_ABOVE : DSL_STAIRS;
+        snprintf(constraint->component_a, sizeof(constraint->component_a), "%s", spec->names[1]);
+        snprintf(constraint->component_b, sizeof(constraint->component_b), "%s", spec->names[0]);
+        constraint->direction = 'a';
+    }
+}
+
+/**
+ * @brief Adds an entry holding both written forms of a spec
+ * @return 1 on success, 0 on allocation failure
+ */
+static int corpus_add_spec(BenchCorpus* corpus, const BenchSpec* spec, const char* label,
+                           const char* subject, unsigned int* seed, int comparable) {
+    TextBuffer markdown = {0}, json = {0};
+    write_markdown(spec, subject, seed, &markdown);
+    write_json(spec, seed, &json);
+
+    BenchEntry* entry = corpus_add_entry(corpus);
+    int ok = entry && markdown.data && json.data;
+    if (ok) {
+        snprintf(entry->label, sizeof(entry->label), "%s", label);
+        entry->comparable = comparable;
+        entry->offset[FORMAT_MARKDOWN] = corpus_add_text(corpus, markdown.data, markdown.length);
+        entry->length[FORMAT_MARKDOWN] = markdown.length;
+        entry->offset[FORMAT_JSON] = corpus_add_text(corpus, json.data, json.length);
+        entry->length[FORMAT_JSON] = json.length;
+        ok = entry->offset[FORMAT_MARKDOWN] != (size_t)-1 && entry->offset[FORMAT_JSON] != (size_t)-1;
+    }
+    free(markdown.data);
+    free(json.data);
+    return ok;
+}
+
+/**
+ * @brief Adds a spec file: the file text itself plus its twin in the other format
+ */
+static int corpus_add_file(BenchCorpus* corpus, const char* filename, LayoutSolver* solver,
+                           unsigned int* seed) {
+    char* text = read_specification_file(filename);
+    if (!text) {
+        fprintf(stderr, "❌ Cannot read %s\n", filename);
+        return 0;
+    }
+    reset_solver(solver, 60, 40);
+    if (!parse_specification_string(text, solver)) {
+        fprintf(stderr, "❌ Cannot parse %s\n", filename);
+        free(text);
+        return 0;
+    }
+
+    BenchSpec spec;
+    bench_spec_from_solver(solver, &spec);
+    TextBuffer twin = {0};
+    const char* first = text;
+    while (*first == ' ' || *first == '\t' || *first == '\n' || *first == '\r') first++;
+    SpecFormat original = *first == '{' ? FORMAT_JSON : FORMAT_MARKDOWN;
+    if (original == FORMAT_JSON) {
+        write_markdown(&spec, filename, seed, &twin);
+    } else {
+        write_json(&spec, seed, &twin);
+    }
+
+    BenchEntry* entry = corpus_add_entry(corpus);
+    int ok = entry && twin.data;
+    if (ok) {
+        snprintf(entry->label, sizeof(entry->label), "%s", filename);
+        entry->comparable = bench_spec_markdown_safe(&spec);
+        entry->offset[original] = corpus_add_text(corpus, text, strlen(text));
+        entry->length[original] = strlen(text);
+        entry->offset[!original] = corpus_add_text(corpus, twin.data, twin.length);
+        entry->length[!original] = twin.length;
+        ok = entry->offset[original] != (size_t)-1 && entry->offset[!original] != (size_t)-1;
+    }
+    free(twin.data);
+    free(text);
+    return ok;
+}
+
+// =============================
+// MEASUREMENT
+// =============================
+
+typedef struct ParserStats {
+    double seconds;
+    size_t bytes;
+    long specs;
+    long failures;
+    long allocations;                   // -1 if this build cannot count
+} ParserStats;
+
+static double elapsed_seconds(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Parses every entry's text of one format, rounds times
+ *
+ * Only the parse calls are timed; the solver reset between specs is not
+ * part of parsing. Allocations are counted over the whole pass.
+ */
+static void measure_parser(const BenchCorpus* corpus, SpecFormat format, LayoutSolver* solver,
+                           int rounds, ParserStats* stats) {
+    memset(stats, 0, sizeof(ParserStats));
+    alloc_counter_start();
+    for (int round = 0; round < rounds; round++) {
+        for (int e = 0; e < corpus->count; e++) {
+            const BenchEntry* entry = &corpus->entries[e];
+            reset_solver(solver, 60, 40);
+
+            struct timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            int ok = parse_specification_string(corpus->text + entry->offset[format], solver);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+
+            stats->seconds += elapsed_seconds(&start, &end);
+            stats->bytes += entry->length[format];
+            stats->specs++;
+            stats->failures += !ok;
+        }
+    }
+    stats->allocations = alloc_counter_stop();
+}
+
+static void print_parser_stats(const char* name, const char* mode, const ParserStats* stats) {
+    char allocations[32];
+    if (stats->allocations < 0) {
+        snprintf(allocations, sizeof(allocations), "n/a");
+    } else {
+        snprintf(allocations, sizeof(allocations), "%.2f", (double)stats->allocations / stats->specs);
+    }
+    printf("  %-8s %-6s %7ld specs, %8.2f MB/s, %9.0f specs/s, %6.2f us/spec, %s allocs/spec%s\n",
+           name, mode, stats->specs, stats->bytes / 1e6 / stats->seconds,
+           stats->specs / stats->seconds, stats->seconds * 1e6 / stats->specs, allocations,
+           stats->failures ? " (parse failures!)" : "");
+}
+
+/**
+ * @brief Parses both forms of every comparable entry and compares the results
+ * @return Number of entries whose parses differ
+ */
+static int check_equivalence(const BenchCorpus* corpus, LayoutSolver* markdown,
+                             LayoutSolver* json, int* compared) {
+    int mismatches = 0;
+    *compared = 0;
+    for (int e = 0; e < corpus->count; e++) {
+        const BenchEntry* entry = &corpus->entries[e];
+        if (!entry->comparable) {
+            continue;
+        }
+        reset_solver(markdown, 60, 40);
+        reset_solver(json, 60, 40);
+        int parsed_markdown = parse_specification_string(corpus->text + entry->offset[FORMAT_MARKDOWN],
+                                                         markdown);
+        int parsed_json = parse_specification_string(corpus->text + entry->offset[FORMAT_JSON], json);
+        (*compared)++;
+
+        char what[256];
+        if (parsed_markdown != parsed_json) {
+            snprintf(what, sizeof(what), "only the %s form parsed",
+                     parsed_markdown ? "markdown" : "json");
+        } else if (compare_parses(markdown, json, what, sizeof(what))) {
+            continue;
+        }
+        if (mismatches < PARSER_BENCH_MAX_MISMATCHES) {
+            printf("  ❌ %s: %s\n", entry->label, what);
+        }
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int run_parser_benchmark(const ParserBenchConfig* config) {
+    BenchCorpus corpus = {0};
+    unsigned int seed = config->seed;
+    int rounds = config->rounds > 0 ? config->rounds : PARSER_BENCH_DEFAULT_ROUNDS;
+    int result = -1;
+
+    // Two solvers for the comparison; the first one also runs the timings
+    LayoutSolver* solvers = malloc(2 * sizeof(LayoutSolver));
+    SolverArena* arena = solver_arena_create();
+    if (!solvers || !arena) {
+        fprintf(stderr, "❌ Memory allocation failed\n");
+        goto done;
+    }
+    for (int s = 0; s < 2; s++) {
+        init_solver(&solvers[s], 60, 40);
+        solvers[s].verbose = 0;
+        solvers[s].tree_debug_enabled = 0;
+    }
+
+    for (int f = 0; f < config->file_count; f++) {
+        if (!corpus_add_file(&corpus, config->files[f], &solvers[0], &seed)) {
+            goto done;
+        }
+    }
+    for (int i = 0; i < config->synthetic_specs; i++) {
+        BenchSpec spec;
+        char label[64];
+        generate_bench_spec(&spec, &seed);
+        snprintf(label, sizeof(label), "synthetic #%d", i + 1);
+        if (!corpus_add_spec(&corpus, &spec, label, room_words[i % 16], &seed, 1)) {
+            fprintf(stderr, "❌ Memory allocation failed\n");
+            goto done;
+        }
+    }
+    if (corpus.count == 0) {
+        fprintf(stderr, "❌ Empty corpus\n");
+        goto done;
+    }
+
+    size_t bytes[FORMAT_COUNT] = {0};
+    for (int e = 0; e < corpus.count; e++) {
+        for (int format = 0; format < FORMAT_COUNT; format++) {
+            bytes[format] += corpus.entries[e].length[format];
+        }
+    }
+    printf("📊 Parser benchmark: %d specs (%d files, %d synthetic), %.2f MB markdown, "
+           "%.2f MB json, %d rounds\n",
+           corpus.count, config->file_count, config->synthetic_specs, bytes[FORMAT_MARKDOWN] / 1e6,
+           bytes[FORMAT_JSON] / 1e6, rounds);
+
+    for (int format = 0; format < FORMAT_COUNT; format++) {
+        ParserStats stats;
+        solvers[0].arena = NULL;
+        measure_parser(&corpus, format, &solvers[0], rounds, &stats);
+        print_parser_stats(format_names[format], "malloc", &stats);
+
+        // Warm the arena's buffers once, then measure the steady state
+        solvers[0].arena = arena;
+        measure_parser(&corpus, format, &solvers[0], 1, &stats);
+        measure_parser(&corpus, format, &solvers[0], rounds, &stats);
+        print_parser_stats(format_names[format], "arena", &stats);
+    }
+    solvers[0].arena = NULL;
+
+    int compared;
+    result = check_equivalence(&corpus, &solvers[0], &solvers[1], &compared);
+    printf("  equivalence: %d/%d specs parse identically in both formats", compared - result,
+           compared);
+    if (compared < corpus.count) {
+        printf(" (%d not expressible as markdown)", corpus.count - compared);
+    }
+    printf("\n");
+
+done:
+    solver_arena_destroy(arena);
+    free(solvers);
+    free(corpus.entries);
+    free(corpus.text);
+    return result;
+}
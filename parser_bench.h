@@ -0,0 +1,40 @@
+#ifndef PARSER_BENCH_H
+#define PARSER_BENCH_H
+
+// =============================================================================
+// PARSER THROUGHPUT BENCHMARK
+// =============================================================================
+
+#define PARSER_BENCH_DEFAULT_SPECS 2000 // Synthetic specs when none are requested
+#define PARSER_BENCH_DEFAULT_ROUNDS 5   // Timed passes over the corpus
+#define PARSER_BENCH_MAX_MISMATCHES 5   // Mismatching specs listed in the report
+
+typedef struct ParserBenchConfig {
+    int synthetic_specs;                // Generated spec pairs (0 = files only)
+    int rounds;                         // Timed passes per parser and mode
+    unsigned int seed;                  // rand_r() seed of the generator
+    const char** files;                 // Spec files added to the corpus
+    int file_count;
+} ParserBenchConfig;
+
+/**
+ * @brief Measures both spec parsers and checks they agree
+ *
+ * Every corpus entry is one spec in both formats: synthetic specs are
+ * written as messy LLM-style markdown (prose around the sections, bullet,
+ * numbered and bold lists, fenced tiles with language tags, long direction
+ * names, ignored constraint types) and as compact or pretty JSON; each file
+ * is parsed and written back in the other format. Both texts go through
+ * parse_specification_string(), once without and once with a solve arena,
+ * and the report gives MB/s, specs/s and heap allocations per spec. Every
+ * pair must parse to identical components, tiles and constraints.
+ *
+ * Files whose tiles the markdown form cannot express (rows starting with
+ * a blank, blank rows) are timed but left out of the comparison.
+ *
+ * @param config Corpus and run settings
+ * @return       Number of entries whose two parses differ, -1 on error
+ */
+int run_parser_benchmark(const ParserBenchConfig* config);
+
+#endif // PARSER_BENCH_H
@@ -0,0 +1,193 @@
+#include "portfolio.h"
+#include "memory_budget.h"
+#include "option_cache.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// =============================================================================
+// PORTFOLIO SOLVER
+// =============================================================================
+// No single heuristic wins on every spec, so hard specs race several search
+// configurations over the same parsed spec and keep the first layout found.
+// Members only share the cancellation flag and the winner slot.
+
+const SearchConfig DEFAULT_PORTFOLIO[] = {
+    {"static/preference/most-constrained", CONSTRAINT_ORDER_STATIC,
+     TIE_BREAK_PREFERENCE, ROOT_MOST_CONSTRAINED, 0},
+    {"fail-first/preference/most-constrained", CONSTRAINT_ORDER_FAIL_FIRST,
+     TIE_BREAK_PREFERENCE, ROOT_MOST_CONSTRAINED, 0},
+    {"static/random/most-constrained", CONSTRAINT_ORDER_STATIC,
+     TIE_BREAK_RANDOM, ROOT_MOST_CONSTRAINED, 0x9e3779b9u},
+    {"fail-first/random/least-constrained", CONSTRAINT_ORDER_FAIL_FIRST,
+     TIE_BREAK_RANDOM, ROOT_LEAST_CONSTRAINED, 0x85ebca6bu},
+    {"static/preference/first-declared", CONSTRAINT_ORDER_STATIC,
+     TIE_BREAK_PREFERENCE, ROOT_FIRST_DECLARED, 0},
+    {"fail-first/random/first-declared", CONSTRAINT_ORDER_FAIL_FIRST,
+     TIE_BREAK_RANDOM, ROOT_FIRST_DECLARED, 0xc2b2ae35u},
+};
+const int DEFAULT_PORTFOLIO_SIZE = sizeof(DEFAULT_PORTFOLIO) / sizeof(DEFAULT_PORTFOLIO[0]);
+
+typedef struct PortfolioMember {
+    LayoutSolver* solver;           // Private copy of the parsed spec
+    int index;                      // Position in the config array
+    atomic_int* winner;             // Shared: index of the first member to succeed
+    atomic_int* cancel;             // Shared: set once a winner exists
+    PortfolioMemberStatus status;
+} PortfolioMember;
+
+/**
+ * @brief Thread body: run one configured search and try to claim the win
+ */
+static void* run_portfolio_member(void* arg) {
+    PortfolioMember* member = arg;
+
+    if (solve_tree_constraint(member->solver)) {
+        int expected = -1;
+        if (atomic_compare_exchange_strong(member->winner, &expected, member->index)) {
+            member->status = PORTFOLIO_MEMBER_WON;
+            atomic_store(member->cancel, 1);
+        } else {
+            member->status = PORTFOLIO_MEMBER_SOLVED_LATE;
+        }
+    } else {
+        member->status = member->solver->search_cancelled ? PORTFOLIO_MEMBER_CANCELLED
+                                                          : PORTFOLIO_MEMBER_EXHAUSTED;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Appends one race outcome to the portfolio statistics log
+ *
+ * CSV columns: unix time, components, constraints, portfolio size, winner
+ * name (or "none"), elapsed milliseconds.
+ */
+static void log_portfolio_race(const char* path, const LayoutSolver* solver,
+                               const PortfolioResult* result) {
+    FILE* log = fopen(path, "a");
+    if (!log) {
+        return;
+    }
+
+    fprintf(log, "%ld,%d,%d,%d,%s,%.3f\n", (long)time(NULL), solver->component_count,
+            solver->constraint_count, result->member_count,
+            result->winner_name ? result->winner_name : "none", result->elapsed_ms);
+    fclose(log);
+}
+
+int solve_portfolio(LayoutSolver* solver, const SearchConfig* configs, int config_count,
+                    PortfolioResult* result, const char* stats_log) {
+    PortfolioResult local_result;
+    if (!result) {
+        result = &local_result;
+    }
+    memset(result, 0, sizeof(PortfolioResult));
+    result->winner = -1;
+
+    if (config_count > MAX_PORTFOLIO_SIZE) {
+        config_count = MAX_PORTFOLIO_SIZE;
+    }
+    if (config_count < 1) {
+        return 0;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    atomic_int winner = -1;
+    atomic_int cancel = 0;
+    PortfolioMember members[MAX_PORTFOLIO_SIZE];
+    pthread_t threads[MAX_PORTFOLIO_SIZE];
+    int started[MAX_PORTFOLIO_SIZE] = {0};
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, SEARCH_THREAD_STACK_SIZE);
+
+    SOLVER_LOG(solver, "🏁 Portfolio: racing %d search configurations\n", config_count);
+
+    for (int i = 0; i < config_count; i++) {
+        PortfolioMember* member = &members[i];
+        member->index = i;
+        member->winner = &winner;
+        member->cancel = &cancel;
+        member->status = PORTFOLIO_MEMBER_NOT_RUN;
+        member->solver = memory_budget_alloc(solver->memory_budget, sizeof(LayoutSolver));
+        if (!member->solver) {
+            SOLVER_LOG(solver, "⚠️  Portfolio member %s skipped: out of memory\n", configs[i].name);
+            continue;
+        }
+
+        memcpy(member->solver, solver, sizeof(LayoutSolver));
+        member->solver->verbose = 0;
+        member->solver->tree_debug_enabled = 0;
+        member->solver->debug_file = NULL;
+        member->solver->tree_debug_file = NULL;
+        member->solver->search_config = configs[i];
+        member->solver->cancel_flag = &cancel;
+        member->solver->arena = NULL;
+        option_cache_attach_copy(member->solver, solver);
+        member->solver->search_threads = 0;
+        // Each member adds its own counters to the store when its search ends
+        memset(&member->solver->nogood_stats, 0, sizeof(member->solver->nogood_stats));
+
+        if (pthread_create(&threads[i], &attr, run_portfolio_member, member) == 0) {
+            started[i] = 1;
+        } else {
+            SOLVER_LOG(solver, "⚠️  Portfolio member %s skipped: thread start failed\n",
+                       configs[i].name);
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+
+    for (int i = 0; i < config_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result->elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 +
+                         (end.tv_nsec - start.tv_nsec) / 1e6;
+    result->member_count = config_count;
+    result->winner = atomic_load(&winner);
+    result->solved = result->winner >= 0;
+    result->winner_name = result->solved ? configs[result->winner].name : NULL;
+
+    for (int i = 0; i < config_count; i++) {
+        result->status[i] = members[i].status;
+        result->nodes_created[i] =
+            members[i].solver ? members[i].solver->tree_solver.nodes_created : 0;
+    }
+
+    int memory_exhausted = 0;
+    for (int i = 0; i < config_count; i++) {
+        memory_exhausted |= members[i].solver ? members[i].solver->memory_exhausted : 1;
+    }
+
+    if (result->solved) {
+        // The winner's search tree was freed when its search finished
+        adopt_solver_layout(solver, members[result->winner].solver);
+        solver->tree_solver.current_node = NULL;
+        SOLVER_LOG(solver, "🏆 Portfolio winner: %s (%.3f ms, %d nodes)\n", result->winner_name,
+                   result->elapsed_ms, result->nodes_created[result->winner]);
+    } else {
+        solver->memory_exhausted = memory_exhausted;
+        SOLVER_LOG(solver, "❌ Portfolio: no configuration found a layout (%.3f ms)%s\n",
+                   result->elapsed_ms, memory_exhausted ? ", memory budget exhausted" : "");
+    }
+
+    for (int i = 0; i < config_count; i++) {
+        option_cache_detach_copy(solver, members[i].solver);
+        memory_budget_free(solver->memory_budget, members[i].solver, sizeof(LayoutSolver));
+    }
+
+    if (stats_log) {
+        log_portfolio_race(stats_log, solver, result);
+    }
+    return result->solved;
+}
@@ -0,0 +1,53 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// PORTFOLIO SOLVER
+// =============================================================================
+
+#define MAX_PORTFOLIO_SIZE 8
+
+// Outcome of one portfolio member
+typedef enum {
+    PORTFOLIO_MEMBER_NOT_RUN,       // Could not be started (allocation or thread failure)
+    PORTFOLIO_MEMBER_WON,           // First member to find a layout
+    PORTFOLIO_MEMBER_SOLVED_LATE,   // Found a layout after the winner
+    PORTFOLIO_MEMBER_EXHAUSTED,     // Searched its whole tree without a layout
+    PORTFOLIO_MEMBER_CANCELLED      // Stopped because another member won
+} PortfolioMemberStatus;
+
+typedef struct PortfolioResult {
+    int solved;                                         // Whether any member found a layout
+    int winner;                                         // Index into the config array, -1 if none
+    const char* winner_name;                            // Winning SearchConfig name, NULL if none
+    int member_count;                                   // Members launched
+    PortfolioMemberStatus status[MAX_PORTFOLIO_SIZE];   // Per-member outcome
+    int nodes_created[MAX_PORTFOLIO_SIZE];              // Per-member tree nodes
+    double elapsed_ms;                                  // Wall time for the whole race
+} PortfolioResult;
+
+// Default racing set, most generally useful configurations first
+extern const SearchConfig DEFAULT_PORTFOLIO[];
+extern const int DEFAULT_PORTFOLIO_SIZE;
+
+/**
+ * @brief Races differently configured tree searches on one thread each
+ *
+ * Every member searches a private copy of the parsed solver. The first member
+ * to find a layout wins, the others are cancelled, and the winning layout is
+ * copied back into the solver.
+ *
+ * @param solver       Parsed solver; receives the winning layout
+ * @param configs      Search configurations to race
+ * @param config_count Number of configurations (at most MAX_PORTFOLIO_SIZE)
+ * @param result       Optional per-member outcome, may be NULL
+ * @param stats_log    CSV file the race outcome is appended to, for tuning the
+ *                     default portfolio; NULL for no log
+ * @return             1 if some member found a layout, 0 otherwise
+ */
+int solve_portfolio(LayoutSolver* solver, const SearchConfig* configs, int config_count,
+                    PortfolioResult* result, const char* stats_log);
+
+#endif // PORTFOLIO_H
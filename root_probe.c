@@ -0,0 +1,269 @@
+#include "root_probe.h"
+#include "memory_budget.h"
+#include "solver_arena.h"
+#include <float.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// ROOT SELECTION BY PROBING
+// =============================================================================
+// The root decides which constraints are resolved first and so how large
+// the tree gets, but constraint degree only loosely predicts that. A few
+// hundred nodes from each candidate root show how the search actually
+// branches below it, which is cheap next to a bad root on a hard spec.
+//
+// The root's position is not probed: the grid grows in every direction and
+// is normalised afterwards, so the same search follows from any position.
+
+typedef struct RootProbe {
+    LayoutSolver* solver;           // Private copy rooted at one candidate
+    int solved;                     // Found a layout within the budget
+    double cost;                    // Nodes used if solved, else estimated nodes to a layout
+} RootProbe;
+
+/**
+ * @brief Estimates the nodes a search from the probe's root creates before its first layout
+ *
+ * The search stops at the first layout, so the size of the whole tree says
+ * little about its cost. At each depth an expansion creates b nodes (the
+ * options that survived filtering) and tries children until one leads to a
+ * layout. With f the share of explored children that failed at that depth
+ * and T the nodes created below an explored child, reaching a layout costs
+ *
+ *   C(d) = b(d) + f(d) / (1 - f(d)) * T(d) + C(d + 1)
+ *
+ * f counts one extra success, so a depth where every explored child failed
+ * still gives a finite cost. Depths the probe never reached reuse the
+ * deepest observed branching and are assumed not to fail.
+ */
+static double estimate_nodes_to_layout(const LayoutSolver* probe) {
+    const DepthStats* stats = probe->tree_solver.depth_stats;
+    int levels = probe->component_count - 1;
+    if (levels > MAX_DEPTH_STATS) {
+        levels = MAX_DEPTH_STATS;
+    }
+
+    double deepest_branching = 1.0;
+    for (int d = 0; d < levels; d++) {
+        if (stats[d].expansions > 0) {
+            long valid = stats[d].options_generated - stats[d].options_conflicting -
+                         stats[d].options_joined;
+            deepest_branching = (double)valid / stats[d].expansions;
+        }
+    }
+
+    double cost = 0.0;
+    double created_below = 0.0; // Nodes created by expansions deeper than d
+    for (int d = levels - 1; d >= 0; d--) {
+        if (stats[d].expansions == 0) {
+            cost += deepest_branching;
+            continue;
+        }
+        long valid = stats[d].options_generated - stats[d].options_conflicting -
+                     stats[d].options_joined;
+        long explored = stats[d].children_explored;
+        double failed_before_success =
+            (double)stats[d].failures / (explored + 1 - stats[d].failures);
+        double subtree = explored > 0 ? created_below / explored : 0.0;
+        cost += (double)valid / stats[d].expansions + failed_before_success * subtree;
+        created_below += valid;
+    }
+    return 1.0 + cost;
+}
+
+/**
+ * @brief Thread body: search from the forced root until the node budget
+ */
+static void* run_root_probe(void* arg) {
+    RootProbe* probe = arg;
+    LayoutSolver* solver = probe->solver;
+
+    probe->solved = run_tree_search(solver);
+    if (probe->solved) {
+        probe->cost = solver->tree_solver.nodes_created;
+    } else if (solver->search_cancelled) {
+        double estimate = estimate_nodes_to_layout(solver);
+        probe->cost = estimate > solver->node_limit ? estimate : solver->node_limit;
+    } else {
+        probe->cost = DBL_MAX; // No layout from this root at all
+    }
+    return NULL;
+}
+
+/**
+ * @brief Fills candidates with unplaced components by descending degree
+ * @return Number of candidates, at most ROOT_PROBE_CANDIDATES
+ */
+static int collect_candidates(LayoutSolver* solver, int* candidates) {
+    int degrees[ROOT_PROBE_CANDIDATES];
+    int count = 0;
+
+    for (int i = 0; i < solver->component_count; i++) {
+        Component* comp = &solver->components[i];
+        if (comp->is_placed) {
+            continue;
+        }
+
+        // Insertion into the sorted top list; equal degrees keep spec order
+        int degree = count_constraint_degree(solver, comp);
+        int slot = count;
+        while (slot > 0 && degrees[slot - 1] < degree) {
+            slot--;
+        }
+        if (slot >= ROOT_PROBE_CANDIDATES) {
+            continue;
+        }
+        int last = count < ROOT_PROBE_CANDIDATES ? count : ROOT_PROBE_CANDIDATES - 1;
+        for (int k = last; k > slot; k--) {
+            degrees[k] = degrees[k - 1];
+            candidates[k] = candidates[k - 1];
+        }
+        degrees[slot] = degree;
+        candidates[slot] = i;
+        if (count < ROOT_PROBE_CANDIDATES) {
+            count++;
+        }
+    }
+    return count;
+}
+
+Component* probe_root_component(LayoutSolver* solver) {
+    int candidates[ROOT_PROBE_CANDIDATES];
+    int count = collect_candidates(solver, candidates);
+    if (count == 0) {
+        return NULL;
+    }
+    if (count == 1 || solver->root_probe_nodes <= 0) {
+        return &solver->components[candidates[0]];
+    }
+
+    // Copies come from the arena when there is one, so repeated solves stay
+    // allocation-free; either way they are charged like other search copies
+    size_t copies_size = count * sizeof(LayoutSolver);
+    int use_arena = solver->arena != NULL;
+    LayoutSolver* copies = NULL;
+    if (!use_arena) {
+        copies = memory_budget_alloc(solver->memory_budget, copies_size);
+    } else if (memory_budget_reserve(solver->memory_budget, copies_size)) {
+        copies = (LayoutSolver*)arena_buffer_reserve(&solver->arena->probe_solvers, copies_size);
+        if (!copies) {
+            memory_budget_release(solver->memory_budget, copies_size);
+        }
+    }
+    if (!copies) {
+        SOLVER_LOG(solver, "⚠️  Root probes skipped: out of memory\n");
+        return &solver->components[candidates[0]];
+    }
+
+    RootProbe probes[ROOT_PROBE_CANDIDATES];
+    pthread_t threads[ROOT_PROBE_CANDIDATES];
+    int started[ROOT_PROBE_CANDIDATES] = {0};
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, SEARCH_THREAD_STACK_SIZE);
+
+    // A serial probe needs no more nodes than an earlier probe took to solve
+    int node_limit = solver->root_probe_nodes;
+    for (int c = 0; c < count; c++) {
+        RootProbe* probe = &probes[c];
+        probe->solver = &copies[c];
+        memcpy(probe->solver, solver, sizeof(LayoutSolver));
+        probe->solver->verbose = 0;
+        probe->solver->tree_debug_enabled = 0;
+        probe->solver->debug_file = NULL;
+        probe->solver->tree_debug_file = NULL;
+        probe->solver->search_threads = 0;
+        probe->solver->forced_root = candidates[c];
+        probe->solver->node_limit = node_limit;
+        // Serial probes run one after another on this thread and may share
+        // the node pool; concurrent ones allocate their own nodes
+        probe->solver->arena = solver->search_threads > 0 ? NULL : solver->arena;
+        probe->solver->option_cache = NULL;
+        // Concurrent probes must not prune each other, or the choice would
+        // depend on timing
+        probe->solver->nogood_store = NULL;
+        probe->solver->search_profile = NULL;
+        probe->solver->progress_hook = NULL;
+        probe->solver->accept_hook = NULL;
+
+        if (solver->search_threads > 0 &&
+            pthread_create(&threads[c], &attr, run_root_probe, probe) == 0) {
+            started[c] = 1;
+        } else {
+            run_root_probe(probe);
+            if (probe->solved && probe->cost < node_limit) {
+                node_limit = (int)probe->cost;
+            }
+        }
+    }
+    pthread_attr_destroy(&attr);
+
+    int best = 0;
+    for (int c = 0; c < count; c++) {
+        if (started[c]) {
+            pthread_join(threads[c], NULL);
+        }
+        const RootProbe* probe = &probes[c];
+        SOLVER_LOG(solver, "  🌱 Root probe %s: %s, %d nodes, cost %.0f\n",
+                   solver->components[candidates[c]].name,
+                   probe->solved                     ? "solved"
+                   : probe->solver->search_cancelled ? "budget reached"
+                                                     : "no layout",
+                   probe->solver->tree_solver.nodes_created, probe->cost);
+        solver->root_probe_stats.probes++;
+        solver->root_probe_stats.probe_nodes += probe->solver->tree_solver.nodes_created;
+
+        // A solved probe beats any estimate; otherwise strictly cheaper wins
+        if ((probe->solved && !probes[best].solved) ||
+            (probe->solved == probes[best].solved && probe->cost < probes[best].cost)) {
+            best = c;
+        }
+    }
+    if (use_arena) {
+        memory_budget_release(solver->memory_budget, copies_size);
+    } else {
+        memory_budget_free(solver->memory_budget, copies, copies_size);
+    }
+
+    solver->root_probe_stats.selections++;
+    solver->root_probe_stats.kept_degree_choice += best == 0;
+    solver->root_probe_stats.last_root = candidates[best];
+    solver->root_probe_stats.last_degree_root = candidates[0];
+    solver->root_probe_stats.last_estimate = probes[best].cost;
+    solver->root_probe_stats.last_degree_estimate = probes[0].cost;
+
+    SOLVER_LOG(solver, "🌱 Probed root: %s (degree heuristic: %s)\n",
+               solver->components[candidates[best]].name,
+               solver->components[candidates[0]].name);
+    return &solver->components[candidates[best]];
+}
+
+/**
+ * @brief Formats a probe cost, which is DBL_MAX when the root has no layout
+ */
+static void format_cost(char* buffer, size_t size, double cost) {
+    if (cost == DBL_MAX) {
+        snprintf(buffer, size, "no layout");
+    } else {
+        snprintf(buffer, size, "~%.0f nodes to a layout", cost);
+    }
+}
+
+void root_probe_print_stats(const LayoutSolver* solver, const char* label) {
+    const struct RootProbeStats* stats = &solver->root_probe_stats;
+    if (stats->selections == 0) {
+        return;
+    }
+
+    char chosen[48], degree[48];
+    format_cost(chosen, sizeof(chosen), stats->last_estimate);
+    format_cost(degree, sizeof(degree), stats->last_degree_estimate);
+    printf("%s: %d/%d kept the degree choice, %d probes, %ld probe nodes; last %s (%s) vs "
+           "degree %s (%s)\n",
+           label, stats->kept_degree_choice, stats->selections, stats->probes,
+           stats->probe_nodes, solver->components[stats->last_root].name, chosen,
+           solver->components[stats->last_degree_root].name, degree);
+}
@@ -0,0 +1,39 @@
+#ifndef ROOT_PROBE_H
+#define ROOT_PROBE_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// ROOT SELECTION BY PROBING
+// =============================================================================
+
+#define ROOT_PROBE_CANDIDATES 4         // Highest-degree components probed as roots
+#define DEFAULT_ROOT_PROBE_NODES 200    // Node budget of one probe search
+
+/**
+ * @brief Chooses the root by short probe searches from the top candidates
+ *
+ * The ROOT_PROBE_CANDIDATES components of highest constraint degree are
+ * each searched as root on a private solver copy, stopped after
+ * solver->root_probe_nodes nodes (concurrently when search_threads > 0).
+ * A probe that finds a layout costs the nodes it used; an unfinished probe
+ * costs the nodes a search from its root is expected to create before its
+ * first layout, estimated from the branching and failure rate it saw at each
+ * depth; a probe that runs out of options without a layout ranks last. Ties
+ * go to the higher degree, so the degree heuristic's root wins unless a probe
+ * beats it.
+ * The outcome is added to solver->root_probe_stats.
+ *
+ * @param solver Solver about to start a search, nothing placed yet
+ * @return       Root component, or NULL if nothing is left to place
+ */
+Component* probe_root_component(LayoutSolver* solver);
+
+/**
+ * @brief Prints how probed roots compared with the degree heuristic
+ * @param solver Solver whose root_probe_stats to report
+ * @param label  Prefix for the report line
+ */
+void root_probe_print_stats(const LayoutSolver* solver, const char* label);
+
+#endif // ROOT_PROBE_H
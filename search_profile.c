@@ -0,0 +1,116 @@
+#include "search_profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// SEARCH EFFORT PROFILE
+// =============================================================================
+// Answers "which constraint chain is eating the search": every node expansion
+// is charged to the chain of components from the root down to the component
+// it generated options for. Exported as folded stacks, each chain becomes a
+// tower in a flame graph whose width is the effort spent below it.
+
+static uint64_t hash_stack(const char* stack) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char* p = stack; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 0x100000001b3ULL;
+    }
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Appends one frame, replacing the folded format's separators
+ */
+static int append_frame(char* stack, int length, int capacity, const char* name) {
+    if (length > 0 && length < capacity - 1) {
+        stack[length++] = ';';
+    }
+    for (const char* p = name; *p && length < capacity - 1; p++) {
+        stack[length++] = *p == ';' ? ':' : *p;
+    }
+    stack[length] = '\0';
+    return length;
+}
+
+SearchProfile* search_profile_create(void) {
+    SearchProfile* profile = calloc(1, sizeof(SearchProfile));
+    if (!profile) {
+        return NULL;
+    }
+    pthread_mutex_init(&profile->lock, NULL);
+    return profile;
+}
+
+void search_profile_destroy(SearchProfile* profile) {
+    if (!profile) {
+        return;
+    }
+    for (int i = 0; i < SEARCH_PROFILE_SLOTS; i++) {
+        free(profile->entries[i].stack);
+    }
+    pthread_mutex_destroy(&profile->lock);
+    free(profile);
+}
+
+void search_profile_record(SearchProfile* profile, LayoutSolver* solver, const TreeNode* node,
+                           const Component* placing, long nanoseconds) {
+    // Collect the path bottom-up, then write it root first
+    int path[MAX_COMPONENTS + 1];
+    int depth = 0;
+    for (const TreeNode* n = node; n && depth < MAX_COMPONENTS; n = n->parent) {
+        path[depth++] = n->component_index;
+    }
+
+    char stack[(MAX_COMPONENTS + 2) * 64];
+    int length = 0;
+    stack[0] = '\0';
+    while (depth > 0) {
+        length = append_frame(stack, length, sizeof(stack),
+                              solver->components[path[--depth]].name);
+    }
+    append_frame(stack, length, sizeof(stack), placing->name);
+
+    uint64_t hash = hash_stack(stack);
+    pthread_mutex_lock(&profile->lock);
+    for (int probe = 0; probe < SEARCH_PROFILE_SLOTS; probe++) {
+        SearchProfileEntry* entry = &profile->entries[(hash + probe) % SEARCH_PROFILE_SLOTS];
+        if (entry->hash == 0) {
+            entry->stack = strdup(stack);
+            if (!entry->stack) {
+                break;
+            }
+            entry->hash = hash;
+            profile->entry_count++;
+        } else if (entry->hash != hash || strcmp(entry->stack, stack) != 0) {
+            continue;
+        }
+        entry->expansions++;
+        entry->nanoseconds += nanoseconds;
+        pthread_mutex_unlock(&profile->lock);
+        return;
+    }
+    profile->dropped++;
+    pthread_mutex_unlock(&profile->lock);
+}
+
+void search_profile_write_folded(SearchProfile* profile, FILE* out, const char* prefix,
+                                 SearchProfileMetric metric) {
+    pthread_mutex_lock(&profile->lock);
+    for (int i = 0; i < SEARCH_PROFILE_SLOTS; i++) {
+        const SearchProfileEntry* entry = &profile->entries[i];
+        if (entry->hash == 0) {
+            continue;
+        }
+        // Sub-microsecond expansions still show up as one unit
+        long value = metric == SEARCH_PROFILE_NODES ? entry->expansions
+                                                    : (entry->nanoseconds + 999) / 1000;
+        fprintf(out, "%s%s%s %ld\n", prefix ? prefix : "", prefix ? ";" : "", entry->stack,
+                value);
+    }
+    if (profile->dropped > 0) {
+        fprintf(stderr, "⚠️  Search profile full: %ld expansions on further paths not exported\n",
+                profile->dropped);
+    }
+    pthread_mutex_unlock(&profile->lock);
+}
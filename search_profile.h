@@ -0,0 +1,74 @@
+#ifndef SEARCH_PROFILE_H
+#define SEARCH_PROFILE_H
+
+#include "constraint_solver.h"
+#include <pthread.h>
+
+// =============================================================================
+// SEARCH EFFORT PROFILE
+// =============================================================================
+
+#define SEARCH_PROFILE_SLOTS 4096       // Distinct search paths kept per profile
+
+// Value written for each folded stack
+typedef enum {
+    SEARCH_PROFILE_TIME,                // Microseconds spent expanding nodes
+    SEARCH_PROFILE_NODES                // Number of node expansions
+} SearchProfileMetric;
+
+typedef struct SearchProfileEntry {
+    uint64_t hash;                      // FNV-1a of stack, 0 = empty slot
+    char* stack;                        // "Root;A;B": components from the root to the one placed
+    long expansions;
+    long nanoseconds;
+} SearchProfileEntry;
+
+// Effort per search-tree path, accumulated over every solve that shares the
+// profile (repeats, parallel workers, portfolio members, floors). Updates
+// take the lock; they happen once per node expansion.
+typedef struct SearchProfile {
+    pthread_mutex_t lock;
+    SearchProfileEntry entries[SEARCH_PROFILE_SLOTS];
+    int entry_count;
+    long dropped;                       // Expansions whose path did not fit the table
+} SearchProfile;
+
+/**
+ * @brief Creates an empty profile
+ * @return New profile, or NULL on allocation failure
+ */
+SearchProfile* search_profile_create(void);
+
+/**
+ * @brief Frees a profile and its stacks
+ * @param profile Profile to free, may be NULL
+ */
+void search_profile_destroy(SearchProfile* profile);
+
+/**
+ * @brief Charges one node expansion to the path ending in the placed component
+ * @param profile     Profile to update
+ * @param solver      Solver the node belongs to (resolves component names)
+ * @param node        Node that was expanded
+ * @param placing     Component the expansion generated options for
+ * @param nanoseconds Time the expansion took
+ */
+void search_profile_record(SearchProfile* profile, LayoutSolver* solver, const TreeNode* node,
+                           const Component* placing, long nanoseconds);
+
+/**
+ * @brief Writes the profile in the folded-stack format of flamegraph.pl
+ *
+ * One line per path: "prefix;Root;A;B value", where value is the metric for
+ * expansions that placed B below Root and A. Feed the file to flamegraph.pl
+ * or speedscope.
+ *
+ * @param profile Profile to export
+ * @param out     Output stream
+ * @param prefix  Root frame for every line (e.g. the spec name), may be NULL
+ * @param metric  Value to write per stack
+ */
+void search_profile_write_folded(SearchProfile* profile, FILE* out, const char* prefix,
+                                 SearchProfileMetric metric);
+
+#endif // SEARCH_PROFILE_H
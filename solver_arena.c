@@ -0,0 +1,120 @@
+#include "solver_arena.h"
+#include "option_cache.h"
+#include <cjson/cJSON.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// REUSABLE SOLVE ARENA
+// =============================================================================
+// Repeated solves (--repeat, batch runs, a service answering many requests)
+// allocate the same things every time: a search tree, a copy of the spec, a
+// cJSON tree. The arena keeps all of them after the first solve and hands
+// them back on the next, so the steady state makes no heap calls at all.
+
+#define ARENA_ALIGNMENT 16
+
+// Arena whose JSON region cJSON allocates from on this thread, NULL = malloc
+static __thread SolverArena* json_arena = NULL;
+static pthread_once_t json_hooks_once = PTHREAD_ONCE_INIT;
+
+static void* arena_json_malloc(size_t size) {
+    SolverArena* arena = json_arena;
+    if (!arena) {
+        return malloc(size);
+    }
+
+    size_t aligned = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    arena->json_demand += aligned;
+    if (arena->json_used + aligned <= arena->json.capacity) {
+        void* block = arena->json.data + arena->json_used;
+        arena->json_used += aligned;
+        return block;
+    }
+    return malloc(size);
+}
+
+static void arena_json_free(void* ptr) {
+    SolverArena* arena = json_arena;
+    if (arena && (char*)ptr >= arena->json.data &&
+        (char*)ptr < arena->json.data + arena->json.capacity) {
+        return; // Rewound by the next solver_arena_begin_json()
+    }
+    free(ptr);
+}
+
+static void install_json_hooks(void) {
+    cJSON_Hooks hooks = {arena_json_malloc, arena_json_free};
+    cJSON_InitHooks(&hooks);
+}
+
+SolverArena* solver_arena_create(void) {
+    return calloc(1, sizeof(SolverArena));
+}
+
+void solver_arena_destroy(SolverArena* arena) {
+    if (!arena) {
+        return;
+    }
+    while (arena->free_nodes) {
+        void* next = *(void**)arena->free_nodes;
+        free(arena->free_nodes);
+        arena->free_nodes = next;
+    }
+    free(arena->spec_text.data);
+    free(arena->spec_file.data);
+    free(arena->probe_solvers.data);
+    free(arena->floor_solvers.data);
+    for (int i = 0; i < MAX_COMPONENTS; i++) {
+        option_cache_destroy(arena->floor_caches[i]);
+    }
+    free(arena->json.data);
+    free(arena);
+}
+
+void* solver_arena_alloc_node(SolverArena* arena) {
+    void* node = arena->free_nodes;
+    if (node) {
+        arena->free_nodes = *(void**)node;
+        arena->nodes_reused++;
+        return node;
+    }
+    node = malloc(sizeof(TreeNode));
+    if (node) {
+        arena->node_blocks++;
+    }
+    return node;
+}
+
+void solver_arena_free_node(SolverArena* arena, void* node) {
+    *(void**)node = arena->free_nodes;
+    arena->free_nodes = node;
+}
+
+char* arena_buffer_reserve(ArenaBuffer* buffer, size_t size) {
+    if (size <= buffer->capacity) {
+        return buffer->data;
+    }
+    // Contents are not kept, so skip the copy realloc() would make
+    free(buffer->data);
+    buffer->data = malloc(size);
+    buffer->capacity = buffer->data ? size : 0;
+    return buffer->data;
+}
+
+void solver_arena_begin_json(SolverArena* arena) {
+    pthread_once(&json_hooks_once, install_json_hooks);
+    arena->json_used = 0;
+    arena->json_demand = 0;
+    json_arena = arena;
+}
+
+void solver_arena_end_json(SolverArena* arena) {
+    json_arena = NULL;
+    // Nothing lives in the region between parses, so it can move freely; growing
+    // here rather than at the next begin keeps that parse allocation-free
+    if (arena->json_demand > arena->json.capacity) {
+        arena_buffer_reserve(&arena->json, arena->json_demand);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef SOLVER_ARENA_H
+#define SOLVER_ARENA_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// REUSABLE SOLVE ARENA
+// =============================================================================
+
+// Grow-only buffer, kept at the largest size any solve needed
+typedef struct ArenaBuffer {
+    char* data;
+    size_t capacity;
+} ArenaBuffer;
+
+// Memory one serial solver keeps between solves, so that once every buffer
+// has reached the size the workload needs, parse + solve run without touching
+// the heap. Attach to LayoutSolver.arena after init_solver(); not shared
+// between threads (concurrent search copies run with arena = NULL).
+typedef struct SolverArena {
+    void* free_nodes;                   // Freed TreeNode blocks, linked through their first word
+    long node_blocks;                   // TreeNode blocks obtained from malloc()
+    long nodes_reused;                  // Node allocations served from free_nodes
+
+    ArenaBuffer spec_text;              // Working copy for parse_specification_string()
+    ArenaBuffer spec_file;              // File content for parse_specification_file()
+    ArenaBuffer probe_solvers;          // Solver copies for root probes (root_probe.c)
+    ArenaBuffer floor_solvers;          // One solver per floor of a multi-floor spec (floors.c)
+    struct OptionCache* floor_caches[MAX_COMPONENTS]; // Their option caches, by floor
+
+    ArenaBuffer json;                   // Bump region for cJSON parse trees
+    size_t json_used;
+    size_t json_demand;                 // Bytes the last parse asked for, sizes the next one
+} SolverArena;
+
+/**
+ * @brief Creates an empty arena; buffers are sized by the first solves
+ * @return New arena, or NULL on allocation failure
+ */
+SolverArena* solver_arena_create(void);
+
+/**
+ * @brief Frees the arena, its buffers and every pooled node
+ * @param arena Arena to free, may be NULL
+ */
+void solver_arena_destroy(SolverArena* arena);
+
+/**
+ * @brief Takes a TreeNode-sized block from the pool, or from malloc() if empty
+ * @return Uninitialised block, or NULL if the system is out of memory
+ */
+void* solver_arena_alloc_node(SolverArena* arena);
+
+/**
+ * @brief Returns a TreeNode-sized block (pooled or malloc'd) to the pool
+ */
+void solver_arena_free_node(SolverArena* arena, void* node);
+
+/**
+ * @brief Makes buffer hold at least size bytes, keeping no contents
+ * @return The buffer, or NULL if it could not grow
+ */
+char* arena_buffer_reserve(ArenaBuffer* buffer, size_t size);
+
+/**
+ * @brief Routes cJSON allocations on this thread into the arena's JSON region
+ *
+ * Everything cJSON allocates until solver_arena_end_json() is bumped from
+ * one region that is rewound, not freed, at the next begin. A parse that
+ * does not fit falls back to malloc() and grows the region for the next one.
+ * Parse trees must be deleted before the matching end.
+ */
+void solver_arena_begin_json(SolverArena* arena);
+
+/**
+ * @brief Restores plain malloc()/free() for cJSON on this thread
+ */
+void solver_arena_end_json(SolverArena* arena);
+
+#endif // SOLVER_ARENA_H
@@ -0,0 +1,59 @@
+#ifndef SOLVER_TRACE_H
+#define SOLVER_TRACE_H
+
+// =============================================================================
+// USDT TRACEPOINTS
+// =============================================================================
+//
+// Static probes on the search hot path, provider "ascii_solver". They are
+// compiled in only with -DENABLE_USDT (./build.sh --usdt, needs <sys/sdt.h>
+// from systemtap-sdt-dev); otherwise every probe expands to nothing.
+//
+// An enabled probe is a single nop plus an ELF note, so production builds can
+// keep them and attach only when needed:
+//
+//   bpftrace -e 'usdt:./ascii_structure_system:ascii_solver:backtrack
+//                { @depth[arg0 - arg1] = count(); }'
+//   perf probe -x ./ascii_structure_system sdt_ascii_solver:node_expand
+//
+// Probe                 Arguments
+// solve_start           components, constraints
+// solve_end             result, nodes created, backtracks
+// node_expand           depth, component index, constraints remaining
+// options_generated     depth, options generated, options kept after filtering
+// place                 component index, x, y
+// remove                component index, x, y
+// backtrack             depth failed at, depth resumed from
+
+#ifdef ENABLE_USDT
+
+#include <sys/sdt.h>
+
+#define TRACE_SOLVE_START(components, constraints)                             \
+    DTRACE_PROBE2(ascii_solver, solve_start, components, constraints)
+#define TRACE_SOLVE_END(result, nodes, backtracks)                             \
+    DTRACE_PROBE3(ascii_solver, solve_end, result, nodes, backtracks)
+#define TRACE_NODE_EXPAND(depth, comp_index, remaining)                        \
+    DTRACE_PROBE3(ascii_solver, node_expand, depth, comp_index, remaining)
+#define TRACE_OPTIONS_GENERATED(depth, generated, valid)                       \
+    DTRACE_PROBE3(ascii_solver, options_generated, depth, generated, valid)
+#define TRACE_PLACE(comp_index, x, y)                                          \
+    DTRACE_PROBE3(ascii_solver, place, comp_index, x, y)
+#define TRACE_REMOVE(comp_index, x, y)                                         \
+    DTRACE_PROBE3(ascii_solver, remove, comp_index, x, y)
+#define TRACE_BACKTRACK(from_depth, to_depth)                                  \
+    DTRACE_PROBE2(ascii_solver, backtrack, from_depth, to_depth)
+
+#else
+
+#define TRACE_SOLVE_START(components, constraints) ((void)0)
+#define TRACE_SOLVE_END(result, nodes, backtracks) ((void)0)
+#define TRACE_NODE_EXPAND(depth, comp_index, remaining) ((void)0)
+#define TRACE_OPTIONS_GENERATED(depth, generated, valid) ((void)0)
+#define TRACE_PLACE(comp_index, x, y) ((void)0)
+#define TRACE_REMOVE(comp_index, x, y) ((void)0)
+#define TRACE_BACKTRACK(from_depth, to_depth) ((void)0)
+
+#endif
+
+#endif // SOLVER_TRACE_H
@@ -0,0 +1,411 @@
+#include "spec_repair.h"
+#include "dsl_parser.h"
+#include "option_cache.h"
+#include "unsat_core.h"
+#include <cjson/cJSON.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// SPECIFICATION REPAIR
+// =============================================================================
+// A generated spec that fails to parse or solve is usually wrong in a few
+// places: a misspelt name, two constraints pulling a pair opposite ways, a
+// tile too large for its neighbours. Naming those places lets the generator
+// send back a small patch, and the patch is applied to the parsed spec so
+// only what changed is compiled again.
+
+/**
+ * @brief Appends one printf-style line to a report, truncating when full
+ */
+static void report_line(char* report, size_t report_size, const char* format, ...) {
+    size_t used = strlen(report);
+    if (used + 1 >= report_size) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vsnprintf(report + used, report_size - used, format, args);
+    va_end(args);
+    used = strlen(report);
+    if (used + 1 < report_size) {
+        report[used] = '\n';
+        report[used + 1] = '\0';
+    }
+}
+
+/**
+ * @brief Axis of a direction: 'v' for n/s, 'h' for e/w
+ */
+static char direction_axis(Direction direction) {
+    return direction == 'n' || direction == 's' ? 'v' : 'h';
+}
+
+/**
+ * @brief Reports ADJACENT constraints that no placement can satisfy together
+ *
+ * A component next to itself, and a pair of components given directions on
+ * both axes, in either order. The solver only holds two components to
+ * touching along a direction's axis (see check_adjacent_either_side()), so
+ * n and s, or e and w, for the same pair agree. "Any" agrees with every
+ * direction.
+ *
+ * @return Number of contradictions reported
+ */
+static int report_contradictions(const DSLConstraint* constraints, int count, char* report,
+                                 size_t report_size) {
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        const DSLConstraint* first = &constraints[i];
+        if (first->type != DSL_ADJACENT) {
+            continue;
+        }
+        if (strcmp(first->component_a, first->component_b) == 0) {
+            report_line(report, report_size, "- ADJACENT(%s, %s, %c) places a component next to itself",
+                        first->component_a, first->component_b, first->direction);
+            found++;
+            continue;
+        }
+        for (int j = i + 1; j < count; j++) {
+            const DSLConstraint* second = &constraints[j];
+            if (second->type != DSL_ADJACENT || first->direction == 'a' ||
+                second->direction == 'a') {
+                continue;
+            }
+            int same = strcmp(first->component_a, second->component_a) == 0 &&
+                       strcmp(first->component_b, second->component_b) == 0;
+            int swapped = strcmp(first->component_a, second->component_b) == 0 &&
+                          strcmp(first->component_b, second->component_a) == 0;
+            if ((same || swapped) &&
+                direction_axis(first->direction) != direction_axis(second->direction)) {
+                report_line(report, report_size,
+                            "- Contradictory directions: ADJACENT(%s, %s, %c) and ADJACENT(%s, %s, %c)",
+                            first->component_a, first->component_b, first->direction,
+                            second->component_a, second->component_b, second->direction);
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+// =============================================================================
+// DIAGNOSIS
+// =============================================================================
+
+static int json_names_component(const cJSON* components, const char* name) {
+    const cJSON* item;
+    cJSON_ArrayForEach(item, components) {
+        const char* other = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "name"));
+        if (other && strcmp(other, name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks the "components" array; returns the number of problems
+ */
+static int diagnose_json_components(const cJSON* components, char* report, size_t report_size) {
+    char tile_buffer[MAX_TILE_SIZE * (MAX_TILE_SIZE + 1) + 1];
+    int problems = 0;
+    int position = 0;
+    const cJSON* item;
+    cJSON_ArrayForEach(item, components) {
+        position++;
+        const char* name = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "name"));
+        if (!name || name[0] == '\0' || strlen(name) >= sizeof(((Component*)0)->name)) {
+            report_line(report, report_size, "- Component #%d has no valid \"name\"", position);
+            problems++;
+            continue;
+        }
+        // Report a duplicate once, at its second declaration
+        const cJSON* earlier;
+        int seen = 0;
+        cJSON_ArrayForEach(earlier, components) {
+            if (earlier == item) {
+                break;
+            }
+            const char* other = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(earlier, "name"));
+            seen |= other && strcmp(other, name) == 0;
+        }
+        if (seen) {
+            report_line(report, report_size, "- Component '%s' is declared twice", name);
+            problems++;
+        }
+        if (!build_json_tile(cJSON_GetObjectItemCaseSensitive(item, "tile"), tile_buffer,
+                             sizeof(tile_buffer))) {
+            report_line(report, report_size,
+                        "- Tile of '%s' is missing or larger than %d rows of %d characters", name,
+                        MAX_TILE_SIZE, MAX_TILE_SIZE);
+            problems++;
+        }
+    }
+    if (position > MAX_COMPONENTS) {
+        report_line(report, report_size, "- %d components declared, at most %d are supported",
+                    position, MAX_COMPONENTS);
+        problems++;
+    }
+    return problems;
+}
+
+/**
+ * @brief Checks the "constraints" array; well-formed ADJACENT entries are
+ *        collected for the contradiction check
+ * @return Number of problems
+ */
+static int diagnose_json_constraints(const cJSON* constraints, const cJSON* components,
+                                     DSLConstraint* adjacent, int* adjacent_count, char* report,
+                                     size_t report_size) {
+    int problems = 0;
+    int position = 0;
+    const cJSON* item;
+    cJSON_ArrayForEach(item, constraints) {
+        position++;
+        const char* type = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "type"));
+        const char* a = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "a"));
+        const char* b = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "b"));
+        const char* direction_text =
+            cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "direction"));
+        Direction direction = parse_json_direction(direction_text);
+
+        int vertical = type && (strcmp(type, "ABOVE") == 0 || strcmp(type, "STAIRS") == 0);
+        if (!type || (!vertical && strcmp(type, "ADJACENT") != 0)) {
+            report_line(report, report_size,
+                        "- Constraint #%d has unsupported type '%s' (use ADJACENT, ABOVE or STAIRS)",
+                        position, type ? type : "");
+            problems++;
+            continue;
+        }
+        int known = 1;
+        const char* names[2] = {a, b};
+        for (int k = 0; k < 2; k++) {
+            if (!names[k]) {
+                report_line(report, report_size, "- Constraint #%d is missing \"%s\"", position,
+                            k == 0 ? "a" : "b");
+                problems++;
+                known = 0;
+            } else if (!json_names_component(components, names[k])) {
+                report_line(report, report_size,
+                            "- Constraint #%d %s(%s, %s) names unknown component '%s'", position,
+                            type, a ? a : "", b ? b : "", names[k]);
+                problems++;
+                known = 0;
+            }
+        }
+        if (!vertical && !direction) {
+            report_line(report, report_size,
+                        "- Constraint #%d ADJACENT(%s, %s) has invalid direction '%s' (use n, e, s, w or a)",
+                        position, a ? a : "", b ? b : "", direction_text ? direction_text : "");
+            problems++;
+            continue;
+        }
+        if (!vertical && known && *adjacent_count < MAX_CONSTRAINTS) {
+            DSLConstraint* constraint = &adjacent[(*adjacent_count)++];
+            constraint->type = DSL_ADJACENT;
+            snprintf(constraint->component_a, sizeof(constraint->component_a), "%s", a);
+            snprintf(constraint->component_b, sizeof(constraint->component_b), "%s", b);
+            constraint->direction = direction;
+        }
+    }
+    if (position > MAX_CONSTRAINTS) {
+        report_line(report, report_size, "- %d constraints given, at most %d are supported",
+                    position, MAX_CONSTRAINTS);
+        problems++;
+    }
+    return problems;
+}
+
+int diagnose_specification_json(const char* specification, char* report, size_t report_size) {
+    report[0] = '\0';
+    cJSON* root = cJSON_Parse(specification);
+    const cJSON* components = cJSON_GetObjectItemCaseSensitive(root, "components");
+    const cJSON* constraints = cJSON_GetObjectItemCaseSensitive(root, "constraints");
+    int problems = 0;
+
+    if (!cJSON_IsObject(root)) {
+        report_line(report, report_size, "- The specification is not a valid JSON object");
+        problems++;
+    } else if (!cJSON_IsArray(components) || cJSON_GetArraySize(components) == 0) {
+        report_line(report, report_size, "- \"components\" must be a non-empty array");
+        problems++;
+    } else if (constraints && !cJSON_IsArray(constraints)) {
+        report_line(report, report_size, "- \"constraints\" must be an array");
+        problems++;
+    } else {
+        DSLConstraint adjacent[MAX_CONSTRAINTS];
+        int adjacent_count = 0;
+        problems += diagnose_json_components(components, report, report_size);
+        problems += diagnose_json_constraints(constraints, components, adjacent, &adjacent_count,
+                                              report, report_size);
+        problems += report_contradictions(adjacent, adjacent_count, report, report_size);
+    }
+
+    cJSON_Delete(root);
+    return problems;
+}
+
+int diagnose_failed_solve(LayoutSolver* solver, char* report, size_t report_size) {
+    report[0] = '\0';
+    int findings = 0;
+
+    for (int i = 0; i < solver->constraint_count; i++) {
+        const DSLConstraint* constraint = &solver->constraints[i];
+        const char* names[2] = {constraint->component_a, constraint->component_b};
+        for (int k = 0; k < 2; k++) {
+            if (!find_component(solver, names[k])) {
+                report_line(report, report_size, "- ADJACENT(%s, %s, %c) names unknown component '%s'",
+                            constraint->component_a, constraint->component_b,
+                            constraint->direction, names[k]);
+                findings++;
+            }
+        }
+    }
+    findings += report_contradictions(solver->constraints, solver->constraint_count, report,
+                                      report_size);
+
+    if (findings > 0) {
+        return findings;
+    }
+
+    UnsatCore core;
+    if (!extract_unsat_core(solver, 0, &core)) {
+        return core.solved_root >= 0 ? -1 : 0;
+    }
+    report_line(report, report_size,
+                "- The search found no layout for these %d constraints together, from any root:",
+                core.constraint_count);
+    for (int k = 0; k < core.constraint_count; k++) {
+        const DSLConstraint* constraint = &solver->constraints[core.constraints[k]];
+        report_line(report, report_size, "    ADJACENT(%s, %s, %c)", constraint->component_a,
+                    constraint->component_b, constraint->direction);
+    }
+    for (int k = 0; k < core.component_count; k++) {
+        const Component* comp = &solver->components[core.components[k]];
+        report_line(report, report_size, "    tile '%s' is %d columns x %d rows", comp->name,
+                    comp->width, comp->height);
+    }
+    return 1;
+}
+
+// =============================================================================
+// PATCHING
+// =============================================================================
+
+static cJSON* find_json_component(cJSON* components, const char* name) {
+    cJSON* item;
+    cJSON_ArrayForEach(item, components) {
+        const char* other = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "name"));
+        if (other && strcmp(other, name) == 0) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+int merge_specification_patch(const char* specification, const char* patch, char* merged,
+                              size_t merged_size) {
+    cJSON* root = cJSON_Parse(specification);
+    cJSON* changes = cJSON_Parse(patch);
+    int ok = 0;
+
+    if (cJSON_IsObject(root) && cJSON_IsObject(changes)) {
+        cJSON* constraints = cJSON_GetObjectItemCaseSensitive(changes, "constraints");
+        if (cJSON_IsArray(constraints)) {
+            cJSON_DeleteItemFromObjectCaseSensitive(root, "constraints");
+            cJSON_AddItemToObject(root, "constraints", cJSON_Duplicate(constraints, 1));
+        }
+
+        cJSON* components = cJSON_GetObjectItemCaseSensitive(root, "components");
+        if (!cJSON_IsArray(components)) {
+            cJSON_DeleteItemFromObjectCaseSensitive(root, "components");
+            components = cJSON_AddArrayToObject(root, "components");
+        }
+        const cJSON* item;
+        cJSON_ArrayForEach(item, cJSON_GetObjectItemCaseSensitive(changes, "tiles")) {
+            const char* name = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "name"));
+            const cJSON* tile = cJSON_GetObjectItemCaseSensitive(item, "tile");
+            if (!name || !tile) {
+                continue;
+            }
+            cJSON* component = find_json_component(components, name);
+            if (!component) {
+                component = cJSON_CreateObject();
+                cJSON_AddStringToObject(component, "name", name);
+                cJSON_AddItemToArray(components, component);
+            }
+            cJSON_DeleteItemFromObjectCaseSensitive(component, "tile");
+            cJSON_AddItemToObject(component, "tile", cJSON_Duplicate(tile, 1));
+        }
+
+        ok = cJSON_PrintPreallocated(root, merged, (int)merged_size, 1);
+    }
+
+    cJSON_Delete(root);
+    cJSON_Delete(changes);
+    return ok;
+}
+
+int apply_specification_patch(const char* patch, LayoutSolver* solver) {
+    cJSON* changes = cJSON_Parse(patch);
+    const cJSON* constraints = cJSON_GetObjectItemCaseSensitive(changes, "constraints");
+    const cJSON* tiles = cJSON_GetObjectItemCaseSensitive(changes, "tiles");
+    if (!cJSON_IsObject(changes) || (constraints && !cJSON_IsArray(constraints)) ||
+        (tiles && !cJSON_IsArray(tiles))) {
+        SOLVER_LOG(solver, "❌ Repair patch is not an object with \"constraints\"/\"tiles\" arrays\n");
+        cJSON_Delete(changes);
+        return 0;
+    }
+
+    int ok = 1;
+    int retiled = 0;
+    char tile_buffer[MAX_TILE_SIZE * (MAX_TILE_SIZE + 1) + 1];
+    const cJSON* item;
+    cJSON_ArrayForEach(item, tiles) {
+        const char* name = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "name"));
+        if (!name || name[0] == '\0' || strlen(name) >= sizeof(solver->components[0].name) ||
+            !build_json_tile(cJSON_GetObjectItemCaseSensitive(item, "tile"), tile_buffer,
+                             sizeof(tile_buffer))) {
+            SOLVER_LOG(solver, "❌ Repair patch has an invalid tile entry\n");
+            ok = 0;
+            break;
+        }
+        Component* comp = find_component(solver, name);
+        if (comp) {
+            set_component_tile(solver, (int)(comp - solver->components), tile_buffer);
+            SOLVER_LOG(solver, "  🩹 Retiled '%s' (%dx%d)\n", name, comp->width, comp->height);
+        } else if (solver->component_count < MAX_COMPONENTS) {
+            add_component(solver, name, tile_buffer);
+            SOLVER_LOG(solver, "  🩹 Added component '%s'\n", name);
+        } else {
+            SOLVER_LOG(solver, "❌ Repair patch adds more than %d components\n", MAX_COMPONENTS);
+            ok = 0;
+            break;
+        }
+        retiled++;
+    }
+
+    if (ok && constraints) {
+        solver->constraint_count = 0;
+        solver->vertical_count = 0;
+        ok = load_json_constraints(constraints, solver);
+        if (ok) {
+            SOLVER_LOG(solver, "  🩹 Replaced constraints: %d adjacent, %d vertical\n",
+                       solver->constraint_count, solver->vertical_count);
+        }
+    }
+    cJSON_Delete(changes);
+
+    clear_all_placements(solver);
+    if (solver->option_cache) {
+        option_cache_clear(solver->option_cache);
+    }
+    solver->nogood_store = NULL;
+    if (ok) {
+        SOLVER_LOG(solver, "🩹 Applied repair patch: %d tiles%s\n", retiled,
+                   constraints ? ", new constraint list" : "");
+    }
+    return ok;
+}
@@ -0,0 +1,87 @@
+#ifndef SPEC_REPAIR_H
+#define SPEC_REPAIR_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// SPECIFICATION REPAIR
+// =============================================================================
+
+#define SPEC_REPAIR_MAX_ROUNDS 2        // Patch requests before giving up on a spec
+#define SPEC_REPAIR_REPORT_SIZE 4096    // Diagnosis buffer size used by callers
+
+// A repair patch is a JSON object with either or both of:
+//   "constraints": [...]                        full replacement constraint list
+//   "tiles": [{"name": "Keep", "tile": [...]}]  replaced tiles; an unknown
+//                                               name declares a new component
+// Everything else about the spec (names, order, unpatched tiles) is kept.
+
+/**
+ * @brief Lists every structural problem of a JSON spec that failed to parse
+ *
+ * The parser stops at the first error; this pass keeps going so a single
+ * repair round can fix them all: invalid or duplicate names, oversized or
+ * malformed tiles, unsupported constraint types, unknown component names,
+ * missing directions, and contradictory directions between the constraints
+ * that are well formed.
+ *
+ * @param specification JSON specification text
+ * @param report        Receives one problem per line
+ * @param report_size   Size of report
+ * @return              Number of problems found
+ */
+int diagnose_specification_json(const char* specification, char* report, size_t report_size);
+
+/**
+ * @brief Explains why the search found no layout for a parsed spec
+ *
+ * Reports constraints naming unknown components (the markdown parser keeps
+ * them) and pairs of constraints with contradictory directions. When there
+ * are none, the unsatisfiable core is extracted instead (see
+ * extract_unsat_core()) and reported with the sizes of the tiles involved.
+ * If the spec solves from another root, nothing needs repairing: the solver
+ * is left holding that layout.
+ *
+ * @param solver      Solver whose solve failed, still holding the parsed spec
+ * @param report      Receives one finding per line
+ * @param report_size Size of report
+ * @return            Number of findings (0: the search failed for no reason
+ *                    that could be isolated), -1 if the spec solves from
+ *                    another root and the solver now holds that layout
+ */
+int diagnose_failed_solve(LayoutSolver* solver, char* report, size_t report_size);
+
+/**
+ * @brief Applies a repair patch to the JSON spec text
+ *
+ * Keeps the text that is sent with the next repair request, and reparsed
+ * when the spec never parsed, in step with the patched solver.
+ *
+ * @param specification JSON specification text
+ * @param patch         Repair patch (JSON)
+ * @param merged        Receives the patched specification
+ * @param merged_size   Size of merged
+ * @return              1 on success, 0 if either input is not a JSON object
+ *                      or the result does not fit
+ */
+int merge_specification_patch(const char* specification, const char* patch, char* merged,
+                              size_t merged_size);
+
+/**
+ * @brief Applies a repair patch to an already parsed spec
+ *
+ * Only patched tiles are recompiled (set_component_tile()); a constraint
+ * list in the patch replaces both the ADJACENT and the vertical constraints.
+ * Placements are cleared, the option cache is emptied and the nogood store
+ * is detached, since its signatures do not cover tile shapes.
+ *
+ * On failure the solver may be partly patched; reparse the merged text
+ * instead.
+ *
+ * @param patch  Repair patch (JSON)
+ * @param solver Parsed solver to patch
+ * @return       1 on success, 0 if the patch is malformed or names unknown components
+ */
+int apply_specification_patch(const char* patch, LayoutSolver* solver);
+
+#endif // SPEC_REPAIR_H
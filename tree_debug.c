@@ -9,6 +9,10 @@
  * @brief Initialize tree solver debug logging
  */
 void init_tree_debug_file(LayoutSolver* solver) {
+    if (!solver->tree_debug_enabled) {
+        solver->tree_debug_file = NULL;
+        return;
+    }
     solver->tree_debug_file = fopen("tree_placement_debug.log", "w");
     if (solver->tree_debug_file) {
         fprintf(solver->tree_debug_file, "=============================================================================\n");
@@ -272,6 +276,13 @@ void debug_log_placement_success_with_grid(LayoutSolver* solver, Component* comp
     debug_log_enhanced_grid_state(solver, stage_message);
 }
 
+/**
+ * @brief Check if a child failed; under memory pressure failed children are freed and left NULL
+ */
+static int child_failed(TreeNode* node, int index) {
+    return !node->children[index] || node->children[index]->marked_failed;
+}
+
 /**
  * @brief Check if all children of a node are marked as failed
  */
@@ -279,7 +290,7 @@ static int all_children_failed(TreeNode* node) {
     if (node->child_count == 0) return 0;
 
     for (int i = 0; i < node->child_count; i++) {
-        if (!node->children[i]->marked_failed) {
+        if (!child_failed(node, i)) {
             return 0;
         }
     }
@@ -363,7 +374,7 @@ static void print_tree_recursive(FILE* file, TreeNode* node, TreeNode* current_n
             // Show 2 siblings before path_child (if failed)
             show_start = path_child;
             for (int back = 1; back <= 2 && path_child - back >= 0; back++) {
-                if (node->children[path_child - back]->marked_failed) {
+                if (child_failed(node, path_child - back)) {
                     show_start = path_child - back;
                 } else {
                     break;  // Don't show non-failed before the path
@@ -381,7 +392,7 @@ static void print_tree_recursive(FILE* file, TreeNode* node, TreeNode* current_n
         int hidden_before = show_start;
         int failed_before = 0;
         for (int i = 0; i < show_start; i++) {
-            if (node->children[i]->marked_failed) failed_before++;
+            if (child_failed(node, i)) failed_before++;
         }
 
         if (hidden_before > 0) {
@@ -401,7 +412,7 @@ static void print_tree_recursive(FILE* file, TreeNode* node, TreeNode* current_n
         int hidden_after = node->child_count - 1 - show_end;
         int failed_after = 0;
         for (int i = show_end + 1; i < node->child_count; i++) {
-            if (node->children[i]->marked_failed) failed_after++;
+            if (child_failed(node, i)) failed_after++;
         }
 
         if (hidden_after > 0) {
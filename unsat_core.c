@@ -0,0 +1,213 @@
+#include "unsat_core.h"
+#include "memory_budget.h"
+#include "option_cache.h"
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// UNSATISFIABLE CORE EXTRACTION
+// =============================================================================
+// A failed solve only says that the spec as a whole has no layout. Usually a
+// handful of constraints around a few awkward tiles are to blame; naming them
+// lets a caller fix or regenerate that part instead of the whole spec.
+
+typedef enum {
+    CHECK_SOLVABLE,
+    CHECK_UNSOLVABLE,
+    CHECK_UNDECIDED                     // Budget, memory or cancellation stopped the search
+} CheckResult;
+
+static int component_index(const LayoutSolver* solver, const char* name) {
+    for (int i = 0; i < solver->component_count; i++) {
+        if (strcmp(solver->components[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Solves the scratch copy with only the listed constraints, from every root
+ *
+ * The search is incomplete: the root decides which side of each constraint
+ * is placed first, and a root can miss a layout another root finds (see
+ * root_probe.c). So the check is unsolvable only if every component the
+ * constraints name fails as root.
+ */
+static CheckResult check_constraints(LayoutSolver* scratch, const LayoutSolver* solver,
+                                     const int* subset, int count, UnsatCore* core) {
+    int named[MAX_COMPONENTS] = {0};
+    for (int k = 0; k < count; k++) {
+        const DSLConstraint* constraint = &solver->constraints[subset[k]];
+        scratch->constraints[k] = *constraint;
+        int a = component_index(solver, constraint->component_a);
+        int b = component_index(solver, constraint->component_b);
+        if (a >= 0) named[a] = 1;
+        if (b >= 0) named[b] = 1;
+    }
+    scratch->constraint_count = count;
+
+    CheckResult result = CHECK_UNSOLVABLE;
+    for (int root = 0; root < solver->component_count; root++) {
+        if (!named[root]) {
+            continue;
+        }
+        clear_all_placements(scratch);
+        scratch->memory_exhausted = 0;
+        scratch->forced_root = root;
+
+        int solved = solve_tree_constraint(scratch);
+        core->checks++;
+        core->nodes += scratch->tree_solver.nodes_created;
+
+        if (solved) {
+            return CHECK_SOLVABLE;
+        }
+        if (scratch->search_cancelled) {
+            result = CHECK_UNDECIDED;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Copies the scratch copy's layout into the solver
+ */
+static void adopt_scratch_layout(LayoutSolver* solver, const LayoutSolver* scratch) {
+    for (int i = 0; i < solver->component_count; i++) {
+        Component* comp = &solver->components[i];
+        comp->is_placed = scratch->components[i].is_placed;
+        comp->placed_x = scratch->components[i].placed_x;
+        comp->placed_y = scratch->components[i].placed_y;
+        sync_placement_record(solver, comp);
+    }
+    memcpy(solver->grid, scratch->grid, sizeof(solver->grid));
+    // Every placement just changed without passing through place/remove
+    if (solver->option_cache) {
+        option_cache_clear(solver->option_cache);
+    }
+}
+
+/**
+ * @brief Fills core->components from the core constraints
+ */
+static void collect_core_components(const LayoutSolver* solver, UnsatCore* core) {
+    int named[MAX_COMPONENTS] = {0};
+    for (int k = 0; k < core->constraint_count; k++) {
+        const DSLConstraint* constraint = &solver->constraints[core->constraints[k]];
+        int a = component_index(solver, constraint->component_a);
+        int b = component_index(solver, constraint->component_b);
+        if (a >= 0) named[a] = 1;
+        if (b >= 0) named[b] = 1;
+    }
+
+    core->component_count = 0;
+    for (int i = 0; i < solver->component_count; i++) {
+        if (named[i]) {
+            core->components[core->component_count++] = i;
+        }
+    }
+}
+
+int extract_unsat_core(LayoutSolver* solver, int check_nodes, UnsatCore* core) {
+    memset(core, 0, sizeof(UnsatCore));
+    core->solved_root = -1;
+    if (solver->vertical_count > 0 || solver->constraint_count == 0) {
+        return 0;
+    }
+
+    LayoutSolver* scratch = memory_budget_alloc(solver->memory_budget, sizeof(LayoutSolver));
+    if (!scratch) {
+        return 0;
+    }
+    memcpy(scratch, solver, sizeof(LayoutSolver));
+    scratch->verbose = 0;
+    scratch->tree_debug_enabled = 0;
+    scratch->debug_file = NULL;
+    scratch->tree_debug_file = NULL;
+    scratch->node_limit = check_nodes > 0 ? check_nodes : UNSAT_CORE_CHECK_NODES;
+    // Failures recorded under one constraint list do not hold for another
+    scratch->nogood_store = NULL;
+    scratch->option_cache = NULL;
+    scratch->arena = NULL;
+    scratch->search_profile = NULL;
+    scratch->progress_hook = NULL;
+
+    int remaining[MAX_CONSTRAINTS];
+    int count = solver->constraint_count;
+    for (int i = 0; i < count; i++) {
+        remaining[i] = i;
+    }
+
+    SOLVER_LOG(solver, "🧩 Extracting an unsatisfiable core from %d constraints\n", count);
+    CheckResult whole = check_constraints(scratch, solver, remaining, count, core);
+    int found = whole == CHECK_UNSOLVABLE;
+    if (whole == CHECK_SOLVABLE) {
+        core->solved_root = scratch->forced_root;
+        adopt_scratch_layout(solver, scratch);
+    }
+
+    // Drop each constraint in turn; keep it only if the rest becomes solvable
+    // (or the check could not tell). The search is not monotonic: dropping a
+    // constraint can make one kept earlier unnecessary, so passes repeat
+    // until one drops nothing, and only that pass can show minimality.
+    int trial[MAX_CONSTRAINTS];
+    int dropped = found;
+    while (dropped) {
+        dropped = 0;
+        core->minimal = 1;
+        for (int pos = 0; pos < count;) {
+            int trial_count = 0;
+            for (int k = 0; k < count; k++) {
+                if (k != pos) {
+                    trial[trial_count++] = remaining[k];
+                }
+            }
+
+            CheckResult result = check_constraints(scratch, solver, trial, trial_count, core);
+            if (result == CHECK_UNSOLVABLE) {
+                memcpy(remaining, trial, trial_count * sizeof(int));
+                count = trial_count;
+                dropped = 1;
+            } else {
+                core->minimal &= result == CHECK_SOLVABLE;
+                pos++;
+            }
+        }
+    }
+
+    memory_budget_free(solver->memory_budget, scratch, sizeof(LayoutSolver));
+    if (core->solved_root >= 0) {
+        SOLVER_LOG(solver, "🧩 No core: the spec solves from root %s (%d checks, %ld nodes)\n",
+                   solver->components[core->solved_root].name, core->checks, core->nodes);
+        return 0;
+    }
+    if (!found) {
+        SOLVER_LOG(solver, "🧩 No core: the constraints could not be shown unsatisfiable "
+                   "within %d nodes\n", check_nodes > 0 ? check_nodes : UNSAT_CORE_CHECK_NODES);
+        return 0;
+    }
+
+    core->constraint_count = count;
+    memcpy(core->constraints, remaining, count * sizeof(int));
+    collect_core_components(solver, core);
+    SOLVER_LOG(solver, "🧩 Core: %d of %d constraints%s (%d checks, %ld nodes)\n", count,
+               solver->constraint_count, core->minimal ? "" : ", not minimal", core->checks,
+               core->nodes);
+    return 1;
+}
+
+void print_unsat_core(const LayoutSolver* solver, const UnsatCore* core, const char* indent) {
+    for (int k = 0; k < core->constraint_count; k++) {
+        const DSLConstraint* constraint = &solver->constraints[core->constraints[k]];
+        printf("%sADJACENT(%s, %s, %c)\n", indent, constraint->component_a,
+               constraint->component_b, constraint->direction);
+    }
+    for (int k = 0; k < core->component_count; k++) {
+        const Component* comp = &solver->components[core->components[k]];
+        printf("%s%s: %dx%d tile\n", indent, comp->name, comp->width, comp->height);
+        for (int row = 0; row < comp->height; row++) {
+            printf("%s  %.*s\n", indent, comp->width, comp->ascii_tile[row]);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef UNSAT_CORE_H
+#define UNSAT_CORE_H
+
+#include "constraint_solver.h"
+
+// =============================================================================
+// UNSATISFIABLE CORE EXTRACTION
+// =============================================================================
+
+#define UNSAT_CORE_CHECK_NODES 20000    // Default node budget of one satisfiability check
+
+// Constraints of a failed spec that already fail on their own
+typedef struct UnsatCore {
+    int constraint_count;
+    int constraints[MAX_CONSTRAINTS];   // Indices into solver->constraints, in spec order
+    int component_count;
+    int components[MAX_COMPONENTS];     // Components the core constraints name, in spec order
+    int minimal;                        // The last pass dropped nothing and every check in it
+                                        // found a layout (none ran out of budget)
+    int solved_root;                    // Root from which every constraint was laid out, so
+                                        // there is no core; the layout is copied into the
+                                        // solver (-1 = none)
+    int checks;                         // Solves run to find the core
+    long nodes;                         // Tree nodes created by those solves
+} UnsatCore;
+
+/**
+ * @brief Finds a small set of constraints that cannot be satisfied together
+ *
+ * Deletion-based: each constraint is dropped in turn, and stays dropped if
+ * the rest still has no layout. Passes repeat until one drops nothing, since
+ * dropping a constraint can make one kept earlier unnecessary. Every check
+ * solves one scratch copy of the parsed solver, so tiles, row masks and
+ * overlap kernels are compiled once and only the constraint list changes
+ * between checks. A check that runs out of its node budget proves nothing,
+ * so its constraint is kept and the core is reported as not minimal.
+ *
+ * Unsatisfiable means "the configured search finds no layout from any
+ * root": each check searches from every component its constraints name and
+ * fails only if all of them fail. The search stays incomplete otherwise, so
+ * this is not a proof that no layout exists.
+ *
+ * When the whole spec solves from a root the failed search did not start
+ * from, there is no core: that layout is copied into the solver and
+ * core->solved_root names the root. Otherwise the solver is not modified.
+ * Multi-floor specs are not supported.
+ *
+ * @param solver      Parsed spec whose solve failed
+ * @param check_nodes Node budget of each check (0 = UNSAT_CORE_CHECK_NODES)
+ * @param core        Receives the core
+ * @return            1 if a core was found, 0 if the whole spec solves from
+ *                    another root (core->solved_root), could not be decided
+ *                    within the budget, or has floors
+ */
+int extract_unsat_core(LayoutSolver* solver, int check_nodes, UnsatCore* core);
+
+/**
+ * @brief Prints the core constraints and the tiles they involve
+ * @param solver Solver the core was extracted from
+ * @param core   Core to print
+ * @param indent Prefix for every line
+ */
+void print_unsat_core(const LayoutSolver* solver, const UnsatCore* core, const char* indent);
+
+#endif // UNSAT_CORE_H